@@ -11,9 +11,27 @@
 #define ABCG_HPP_
 
 #include "abcg_application.hpp"
+#include "abcg_assetmanager.hpp"
+#include "abcg_commandlist.hpp"
 #include "abcg_elapsedtimer.hpp"
+#include "abcg_eventlog.hpp"
+#include "abcg_framestats.hpp"
+#include "abcg_globject.hpp"
+#include "abcg_glstatecache.hpp"
 #include "abcg_image.hpp"
+#include "abcg_jobsystem.hpp"
+#include "abcg_latencymeter.hpp"
+#include "abcg_mesh.hpp"
+#include "abcg_objfile.hpp"
+#include "abcg_random.hpp"
+#include "abcg_simulationthread.hpp"
+#include "abcg_streambuffer.hpp"
 #include "abcg_string.hpp"
+#include "abcg_trace.hpp"
 #include "abcg_trackball.hpp"
+#include "abcg_transformbatch.hpp"
+#include "abcg_triplebuffer.hpp"
+#include "abcg_uniformblock.hpp"
+#include "abcg_vertexdedup.hpp"
 
 #endif
\ No newline at end of file
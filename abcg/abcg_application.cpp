@@ -10,13 +10,54 @@
 
 #include <fmt/core.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
 #include <gsl/gsl>
+#include <limits>
+#include <string>
+#include <string_view>
 
 #include "SDL_image.h"
 #include "abcg_exception.hpp"
 #include "abcg_openglwindow.hpp"
+#include "abcg_random.hpp"
+#include "abcg_trace.hpp"
 #include "tiny_obj_loader.h"
 
+namespace {
+// ID of the window an event is addressed to, or 0 if the event is global
+// (e.g., quit, device and audio events)
+Uint32 getEventWindowID(const SDL_Event &event) {
+  switch (event.type) {
+    case SDL_WINDOWEVENT:
+      return event.window.windowID;
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
+      return event.key.windowID;
+    case SDL_TEXTEDITING:
+      return event.edit.windowID;
+    case SDL_TEXTINPUT:
+      return event.text.windowID;
+    case SDL_MOUSEMOTION:
+      return event.motion.windowID;
+    case SDL_MOUSEBUTTONDOWN:
+    case SDL_MOUSEBUTTONUP:
+      return event.button.windowID;
+    case SDL_MOUSEWHEEL:
+      return event.wheel.windowID;
+    case SDL_DROPFILE:
+    case SDL_DROPTEXT:
+    case SDL_DROPBEGIN:
+    case SDL_DROPCOMPLETE:
+      return event.drop.windowID;
+    default:
+      return event.type >= SDL_USEREVENT ? event.user.windowID : 0;
+  }
+}
+}  // namespace
+
 #if defined(__EMSCRIPTEN__)
 void abcg::mainLoopCallback(void *userData) {
   abcg::Application &app = *(static_cast<abcg::Application *>(userData));
@@ -31,9 +72,33 @@ void abcg::mainLoopCallback(void *userData) {
  * Constructs an abcg::Application object and initializes the SDL library and
  * SDL subsystems.
  *
- * @throw abcg::Exception if SDL failed to initialize the subsystems.
+ * The following command-line options are recognized:
+ *
+ * - `--trace <file>`: records a trace of the application (see abcg::Trace),
+ * written to the file when the application exits;
+ * - `--trace-seconds <seconds>`: length of the trace written to the file, up
+ * to the exit (default 10);
+ * - `--record <file>`: records the input events of the session to the file
+ * (see abcg::EventLog);
+ * - `--replay <file>`: replays a recorded session as fast as possible, then
+ * prints the number of frames and the time taken;
+ * - `--seed <n>`: base seed of abcg::randomSeed. Ignored by `--replay`, which
+ * uses the recorded seed;
+ * - `--latency`: measures the latency from input events to the frames that
+ * show them (see abcg::LatencyMeter), printed when the application exits;
+ * - `--latency-fence`: same as `--latency`, and also waits for the GPU to
+ * finish each frame that consumed an event;
+ * - `--headless <frames>`: creates hidden windows, sends a synthetic mouse
+ * motion event to each window on every frame, and exits after the given
+ * number of frames;
+ * - `--frame-stats <file>`: writes the frame time statistics of each window
+ * (see abcg::FrameStats) to the file when the application exits, as JSON if
+ * the file ends in `.json`, or as CSV otherwise.
+ *
+ * @throw abcg::Exception if SDL failed to initialize the subsystems, if an
+ * option has an invalid value, or if the event log cannot be opened.
  */
-abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
+abcg::Application::Application(int argc, char **argv) {
   Uint32 subsystemMask{SDL_INIT_TIMER | SDL_INIT_VIDEO | SDL_INIT_AUDIO |
                        SDL_INIT_JOYSTICK | SDL_INIT_GAMECONTROLLER |
                        SDL_INIT_EVENTS};
@@ -63,15 +128,84 @@ abcg::Application::Application([[maybe_unused]] int argc, char **argv) {
 #else
   m_basePath = argv_str.substr(0, argv_str.find_last_of('/'));
 #endif
+
+  std::string recordPath;
+  std::string replayPath;
+  const auto args{gsl::span{argv, static_cast<std::size_t>(argc)}};
+  for (std::size_t index{1}; index < args.size(); ++index) {
+    const std::string_view arg{args[index]};
+    const auto hasValue{index + 1 < args.size()};
+    if (arg == "--trace" && hasValue) {
+      m_tracePath = args[++index];
+    } else if (arg == "--trace-seconds" && hasValue) {
+      try {
+        m_traceSeconds = std::stod(args[++index]);
+      } catch (const std::exception &) {
+        throw abcg::Exception{abcg::Exception::Runtime(
+            fmt::format("Invalid value of --trace-seconds: {}", args[index]))};
+      }
+    } else if (arg == "--record" && hasValue) {
+      recordPath = args[++index];
+    } else if (arg == "--replay" && hasValue) {
+      replayPath = args[++index];
+    } else if (arg == "--frame-stats" && hasValue) {
+      m_frameStatsPath = args[++index];
+    } else if (arg == "--latency") {
+      m_measureLatency = true;
+    } else if (arg == "--latency-fence") {
+      m_measureLatency = true;
+      m_latencyFenceSync = true;
+    } else if (arg == "--headless" && hasValue) {
+      try {
+        m_headlessFrames = std::stoul(args[++index]);
+      } catch (const std::exception &) {
+        throw abcg::Exception{abcg::Exception::Runtime(
+            fmt::format("Invalid value of --headless: {}", args[index]))};
+      }
+    } else if (arg == "--seed" && hasValue) {
+      try {
+        setRandomSeed(static_cast<unsigned int>(std::stoul(args[++index])));
+      } catch (const std::exception &) {
+        throw abcg::Exception{abcg::Exception::Runtime(
+            fmt::format("Invalid value of --seed: {}", args[index]))};
+      }
+    }
+  }
+
+  Trace::setThreadName("Main");
+  if (!m_tracePath.empty()) Trace::start();
+
+  if (!recordPath.empty() && !replayPath.empty()) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        "--record and --replay cannot be used together")};
+  }
+  if (!recordPath.empty()) {
+    m_eventLog = std::make_unique<EventLog>(EventLog::Mode::Record, recordPath);
+  } else if (!replayPath.empty()) {
+    m_eventLog = std::make_unique<EventLog>(EventLog::Mode::Replay, replayPath);
+  }
 }
 
 /**
  * @brief Destroys the abcg::Application object.
  *
- * Destroys the abcg::Application object and cleans up the SDL initialized
- * subsystems.
+ * Destroys the windows and cleans up the SDL initialized subsystems.
+ *
+ * Each window is destroyed with its OpenGL context and state cache current,
+ * so that the OpenGL objects of derived windows are deleted in the context
+ * that created them.
  */
 abcg::Application::~Application() {
+  m_windowsByID.clear();
+  for (auto &window : m_windows) {
+    if (window->m_window != nullptr && window->m_GLContext != nullptr) {
+      SDL_GL_MakeCurrent(window->m_window, window->m_GLContext);
+      GLStateCache::makeCurrent(&window->m_stateCache);
+    }
+    window.reset();
+    GLStateCache::makeCurrent(nullptr);
+  }
+
 #if !defined(__EMSCRIPTEN__)
   IMG_Quit();
 #endif
@@ -97,31 +231,203 @@ void abcg::Application::run(
 }
 
 void abcg::Application::mainLoopIterator([[maybe_unused]] bool &done) {
-  SDL_Event event{};
-  while (SDL_PollEvent(&event) != 0) {
+  ABCG_TRACE_SCOPE("Frame");
+
+  {
+    ABCG_TRACE_SCOPE("Events");
+    if (m_headlessFrames > 0) pushSyntheticEvents();
+    if (m_eventLog) {
+      m_eventLog->beginFrame();
+      SDL_PumpEvents();
+      const auto mouseState{m_eventLog->updateMouseState()};
+      for (const auto &window : m_windows) {
+        window->m_mouseState = mouseState;
+      }
+    }
+
+    const auto isReplaying{m_eventLog &&
+                           m_eventLog->getMode() == EventLog::Mode::Replay};
+    SDL_Event event{};
+    auto hasEvent{waitForEvent(event)};
+    while (hasEvent || SDL_PollEvent(&event) != 0) {
+      hasEvent = false;
+      if (m_eventLog && EventLog::isInputEvent(event)) {
+        // Live input is ignored while replaying
+        if (isReplaying) continue;
+        m_eventLog->recordEvent(event);
+      }
 #if !defined(__EMSCRIPTEN__)
-    if (event.type == SDL_QUIT) done = true;
+      if (event.type == SDL_QUIT) done = true;
 #endif
-    for (const auto &window : m_windows) {
-      window->handleEvent(event, done);
+      dispatchEvent(event, done);
+    }
+
+    if (isReplaying) {
+      while (m_eventLog->nextEvent(event)) {
+        dispatchEvent(event, done);
+      }
+    }
+  }
+  for (const auto &window : m_windows) {
+    // Replays paint every frame, as recorded
+    if (m_eventLog || window->getTimeToNextPaint() <= 0.0) window->paint();
+  }
+
+  if (m_eventLog) {
+    m_eventLog->endFrame();
+    if (m_eventLog->isDone()) done = true;
+  }
+  if (m_headlessFrames > 0 && ++m_frame >= m_headlessFrames) done = true;
+}
+
+// Passes an event addressed to a window only to that window, and a global
+// event to all windows. Events of unknown windows are discarded. Both go
+// through the same path, which feeds the ImGui context of the window, filters
+// the events captured by ImGui and requests a redraw.
+void abcg::Application::dispatchEvent(SDL_Event &event, bool &done) {
+  if (const auto windowID{getEventWindowID(event)}; windowID != 0) {
+    if (const auto it{m_windowsByID.find(windowID)};
+        it != m_windowsByID.end()) {
+      if (EventLog::isInputEvent(event)) {
+        it->second->m_latencyMeter.addInput(event);
+      }
+      it->second->handleEvent(event, done);
+    }
+    return;
+  }
+
+  for (const auto &window : m_windows) {
+    window->handleEvent(event, done);
+  }
+}
+
+// Sleeps until an event arrives or a window must be painted according to its
+// render policy. Returns true if an event was received.
+bool abcg::Application::waitForEvent([[maybe_unused]] SDL_Event &event) {
+#if defined(__EMSCRIPTEN__)
+  // The browser schedules the frames
+  return false;
+#else
+  if (m_eventLog || m_headlessFrames > 0) return false;
+
+  auto timeout{std::numeric_limits<double>::infinity()};
+  for (const auto &window : m_windows) {
+    timeout = std::min(timeout, window->getTimeToNextPaint());
+  }
+  if (timeout <= 0.0) return false;
+
+  // The wait is not part of the frame time of idle windows
+  for (const auto &window : m_windows) {
+    if (std::isinf(window->getTimeToNextPaint())) {
+      window->m_frameStats.pause();
     }
   }
+
+  ABCG_TRACE_SCOPE("Wait for events");
+  if (std::isinf(timeout)) return SDL_WaitEvent(&event) != 0;
+  const auto milliseconds{static_cast<int>(
+      std::min(std::ceil(timeout * 1000.0),
+               static_cast<double>(std::numeric_limits<int>::max())))};
+  return SDL_WaitEventTimeout(&event, milliseconds) != 0;
+#endif
+}
+
+// Sends a mouse motion event to the center of each window, timestamped by
+// SDL when pushed
+void abcg::Application::pushSyntheticEvents() {
   for (const auto &window : m_windows) {
-    window->paint();
+    SDL_Event event{};
+    event.type = SDL_MOUSEMOTION;
+    event.motion.windowID = window->m_windowID;
+    event.motion.x = window->m_viewportWidth / 2;
+    event.motion.y = window->m_viewportHeight / 2;
+    SDL_PushEvent(&event);
   }
 }
 
+void abcg::Application::printLatencyReports() const {
+  const auto print{[](std::string_view stage,
+                      const LatencyMeter::Percentiles &percentiles) {
+    fmt::print("  {:<8} p50 {:7.2f} ms  p95 {:7.2f} ms  p99 {:7.2f} ms\n",
+               stage, percentiles.p50, percentiles.p95, percentiles.p99);
+  }};
+
+  for (const auto &window : m_windows) {
+    const auto report{window->m_latencyMeter.getReport()};
+    fmt::print("Input latency of \"{}\" ({} events):\n",
+               window->m_windowSettings.title, report.numSamples);
+    if (report.numSamples == 0) continue;
+    print("submit", report.submit);
+    print("present", report.present);
+    if (window->m_latencyMeter.isFenceSyncEnabled()) {
+      print("complete", report.complete);
+    }
+  }
+}
+
+void abcg::Application::writeFrameStats() const {
+  std::ofstream stream{m_frameStatsPath};
+  if (!stream) {
+    throw abcg::Exception{abcg::Exception::Runtime(fmt::format(
+        "Failed to open frame statistics file {}", m_frameStatsPath))};
+  }
+
+  const auto isJSON{m_frameStatsPath.ends_with(".json")};
+  if (isJSON) stream << "[\n";
+  for (std::size_t index{}; index < m_windows.size(); ++index) {
+    const auto &window{m_windows.at(index)};
+    if (isJSON) {
+      window->m_frameStats.writeJSON(stream, window->m_windowSettings.title);
+      stream << (index + 1 < m_windows.size() ? ",\n" : "\n");
+    } else {
+      window->m_frameStats.writeCSV(stream, window->m_windowSettings.title,
+                                    index == 0);
+    }
+  }
+  if (isJSON) stream << "]\n";
+
+  if (!stream) {
+    throw abcg::Exception{abcg::Exception::Runtime(fmt::format(
+        "Failed to write frame statistics file {}", m_frameStatsPath))};
+  }
+  fmt::print("Frame statistics written to {}\n", m_frameStatsPath);
+}
+
 void abcg::Application::run() {
   for (const auto &w : m_windows) {
+    w->m_hidden = m_headlessFrames > 0;
+    w->m_latencyMeter.setEnabled(m_measureLatency, m_latencyFenceSync);
     w->initialize(m_basePath);
+    m_windowsByID[w->m_windowID] = w.get();
   }
 
 #if defined(__EMSCRIPTEN__)
   emscripten_set_main_loop_arg(mainLoopCallback, this, 0, true);
 #else
+  const auto startTime{std::chrono::steady_clock::now()};
   bool done{};
   while (!done) {
     mainLoopIterator(done);
   };
+
+  if (m_eventLog && m_eventLog->getMode() == EventLog::Mode::Replay) {
+    const auto seconds{std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - startTime)
+                           .count()};
+    const auto frames{m_eventLog->getFrame()};
+    const auto frameTime{
+        frames > 0 ? seconds * 1000.0 / static_cast<double>(frames) : 0.0};
+    fmt::print("Replayed {} frames in {:.3f} s ({:.3f} ms/frame)\n", frames,
+               seconds, frameTime);
+  }
+
+  if (m_measureLatency) printLatencyReports();
+  if (!m_frameStatsPath.empty()) writeFrameStats();
+
+  if (!m_tracePath.empty()) {
+    Trace::stop();
+    Trace::write(m_tracePath, m_traceSeconds);
+    fmt::print("Trace written to {}\n", m_tracePath);
+  }
 #endif
 }
@@ -12,8 +12,10 @@
 
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "abcg_eventlog.hpp"
 #include "abcg_exception.hpp"
 #include "abcg_openglwindow.hpp"
 
@@ -48,10 +50,24 @@ class abcg::Application {
 
  private:
   void mainLoopIterator(bool& done);
+  void dispatchEvent(SDL_Event& event, bool& done);
+  bool waitForEvent(SDL_Event& event);
+  void pushSyntheticEvents();
+  void printLatencyReports() const;
+  void writeFrameStats() const;
   void run();
 
   std::string m_basePath;
+  std::string m_tracePath;
+  double m_traceSeconds{10.0};
+  std::unique_ptr<EventLog> m_eventLog;
+  bool m_measureLatency{};
+  bool m_latencyFenceSync{};
+  std::size_t m_headlessFrames{};
+  std::string m_frameStatsPath;
+  std::size_t m_frame{};
   std::vector<std::unique_ptr<OpenGLWindow>> m_windows;
+  std::unordered_map<Uint32, OpenGLWindow*> m_windowsByID;
 
 #if defined(__EMSCRIPTEN__)
   friend void mainLoopCallback(void* userData);
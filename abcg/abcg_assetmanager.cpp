@@ -0,0 +1,268 @@
+/**
+ * @file abcg_assetmanager.cpp
+ * @brief Definition of abcg::AssetManager class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_assetmanager.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "abcg_trace.hpp"
+
+namespace {
+// Runs the load function of an asset, keeping its exception to be rethrown
+// by the thread that owns the asset manager
+template <typename TAsset>
+void runLoad(TAsset &asset) {
+  ABCG_TRACE_SCOPE("Load asset");
+  try {
+    asset.uploadSize = asset.load();
+  } catch (...) {
+    asset.exception = std::current_exception();
+  }
+}
+}  // namespace
+
+/**
+ * @brief Waits for the load jobs that are still running.
+ *
+ * Assets that are loaded but not uploaded are discarded.
+ */
+abcg::AssetManager::~AssetManager() {
+  try {
+    JobSystem::global().wait(m_counter);
+  } catch (...) {
+    // Exceptions of load functions are kept by the assets
+  }
+}
+
+/**
+ * @brief Adds an asset to be loaded.
+ *
+ * The load starts at the next call to abcg::AssetManager::update.
+ *
+ * @param load Function that reads and decodes the asset, and returns the
+ * number of bytes that will be uploaded. It runs on a worker thread and must
+ * not make OpenGL calls.
+ * @param upload Function that creates the OpenGL objects of the asset. It
+ * runs on the thread that calls abcg::AssetManager::update.
+ *
+ * @return Handle of the asset.
+ */
+abcg::AssetManager::Handle abcg::AssetManager::add(LoadFunction load,
+                                                   UploadFunction upload) {
+  const auto handle{m_assets.size()};
+  auto &asset{m_assets.emplace_back()};
+  asset.load = std::move(load);
+  asset.upload = std::move(upload);
+  asset.frame = m_frame;
+  m_loadQueue.push_back(handle);
+  return handle;
+}
+
+/**
+ * @brief Starts pending loads and uploads loaded assets.
+ *
+ * Must be called once per frame by the thread that owns the OpenGL context.
+ * Assets are uploaded in the order their loads finished, while the sum of
+ * their sizes fits in the budget. The first asset is always uploaded, so
+ * that assets larger than the budget are not postponed forever.
+ *
+ * @param byteBudget Maximum number of bytes to upload.
+ *
+ * @throw Rethrows the exception of an asset that failed, after the uploads of
+ * the call. The exceptions of other failed assets are rethrown by the next
+ * calls.
+ */
+void abcg::AssetManager::update(std::size_t byteBudget) {
+  if (JobSystem::global().getNumWorkers() == 0 && !m_loadQueue.empty() &&
+      m_assets[m_loadQueue.front()].frame < m_frame) {
+    loadNext();
+  }
+  collect();
+  dispatch();
+
+  std::size_t uploadedBytes{};
+  while (!m_uploadQueue.empty()) {
+    const auto handle{m_uploadQueue.front()};
+    const auto size{m_assets[handle].uploadSize};
+    if (uploadedBytes > 0 && uploadedBytes + size > byteBudget) break;
+
+    m_uploadQueue.pop_front();
+    upload(handle);
+    uploadedBytes += size;
+  }
+  ++m_frame;
+
+  rethrowFailure();
+}
+
+/**
+ * @brief Loads and uploads all remaining assets, without a budget.
+ *
+ * @throw Rethrows the exception of an asset that failed, after all assets are
+ * done. The exceptions of other failed assets are rethrown by the next calls
+ * to abcg::AssetManager::finish or abcg::AssetManager::update.
+ */
+void abcg::AssetManager::finish() {
+  auto &jobSystem{JobSystem::global()};
+  while (!m_loadQueue.empty() || m_numLoading > 0 || !m_uploadQueue.empty()) {
+    if (jobSystem.getNumWorkers() == 0) {
+      while (!m_loadQueue.empty()) {
+        loadNext();
+      }
+    } else {
+      dispatch();
+      jobSystem.wait(m_counter);
+    }
+    collect();
+
+    while (!m_uploadQueue.empty()) {
+      const auto handle{m_uploadQueue.front()};
+      m_uploadQueue.pop_front();
+      upload(handle);
+    }
+  }
+
+  rethrowFailure();
+}
+
+/**
+ * @brief Returns whether an asset is uploaded and can be used.
+ *
+ * @param handle Handle returned by abcg::AssetManager::add.
+ *
+ * @return True if the upload function of the asset has run.
+ */
+bool abcg::AssetManager::isReady(Handle handle) const {
+  return m_assets.at(handle).state == State::Ready;
+}
+
+/**
+ * @brief Returns whether the load or upload function of an asset failed.
+ *
+ * @param handle Handle returned by abcg::AssetManager::add.
+ *
+ * @return True if the load or upload function of the asset threw an
+ * exception.
+ */
+bool abcg::AssetManager::isFailed(Handle handle) const {
+  return m_assets.at(handle).state == State::Failed;
+}
+
+/**
+ * @brief Returns the fraction of the work done.
+ *
+ * Loading and uploading count as half of the work of each asset. A failed
+ * asset counts as done.
+ *
+ * @return Progress from 0 to 1. It is 1 if there are no assets.
+ */
+float abcg::AssetManager::getProgress() const noexcept {
+  if (m_assets.empty()) return 1.0f;
+  return static_cast<float>(m_numLoaded + m_numReady + m_numFailed) /
+         static_cast<float>(2 * m_assets.size());
+}
+
+// Starts load jobs. At most half of the workers load assets at the same time,
+// so that the others remain free for the jobs of the frame
+void abcg::AssetManager::dispatch() {
+  auto &jobSystem{JobSystem::global()};
+  const auto maxLoading{
+      std::max<std::size_t>(1, jobSystem.getNumWorkers() / 2)};
+  while (!m_loadQueue.empty() && m_numLoading < maxLoading &&
+         jobSystem.getNumWorkers() > 0) {
+    const auto handle{m_loadQueue.front()};
+    m_loadQueue.pop_front();
+
+    auto &asset{m_assets[handle]};
+    asset.state = State::Loading;
+    ++m_numLoading;
+    jobSystem.runInBackground(
+        [this, handle, &asset] {
+          runLoad(asset);
+          const std::lock_guard lock{m_finishedMutex};
+          m_finished.push_back(handle);
+        },
+        &m_counter);
+  }
+}
+
+// Loads the next asset on the calling thread
+void abcg::AssetManager::loadNext() {
+  if (m_loadQueue.empty()) return;
+  const auto handle{m_loadQueue.front()};
+  m_loadQueue.pop_front();
+
+  auto &asset{m_assets[handle]};
+  asset.state = State::Loading;
+  ++m_numLoading;
+  runLoad(asset);
+  const std::lock_guard lock{m_finishedMutex};
+  m_finished.push_back(handle);
+}
+
+// Moves the assets whose load finished to the upload queue. Assets whose
+// load failed are never uploaded
+void abcg::AssetManager::collect() {
+  std::vector<Handle> finished;
+  {
+    const std::lock_guard lock{m_finishedMutex};
+    finished.swap(m_finished);
+  }
+
+  for (const auto handle : finished) {
+    --m_numLoading;
+    ++m_numLoaded;
+    if (m_assets[handle].exception) {
+      fail(handle);
+    } else {
+      m_assets[handle].state = State::Loaded;
+      m_uploadQueue.push_back(handle);
+    }
+  }
+}
+
+// Uploads a loaded asset. If the upload function throws, the asset fails
+void abcg::AssetManager::upload(Handle handle) {
+  auto &asset{m_assets[handle]};
+  try {
+    ABCG_TRACE_SCOPE("Upload asset");
+    asset.upload();
+  } catch (...) {
+    asset.exception = std::current_exception();
+    fail(handle);
+    return;
+  }
+  asset.state = State::Ready;
+  ++m_numReady;
+  m_uploadedBytes += asset.uploadSize;
+
+  // Release the data captured by the functions
+  asset.load = nullptr;
+  asset.upload = nullptr;
+}
+
+// Marks an asset as failed, to be rethrown by abcg::AssetManager::update or
+// abcg::AssetManager::finish
+void abcg::AssetManager::fail(Handle handle) {
+  auto &asset{m_assets[handle]};
+  asset.state = State::Failed;
+  ++m_numFailed;
+  m_failedQueue.push_back(handle);
+
+  // Release the data captured by the functions
+  asset.load = nullptr;
+  asset.upload = nullptr;
+}
+
+// Rethrows the exception of the next failed asset, if any
+void abcg::AssetManager::rethrowFailure() {
+  if (m_failedQueue.empty()) return;
+  const auto handle{m_failedQueue.front()};
+  m_failedQueue.pop_front();
+  std::rethrow_exception(std::exchange(m_assets[handle].exception, nullptr));
+}
@@ -0,0 +1,125 @@
+/**
+ * @file abcg_assetmanager.hpp
+ * @brief abcg::AssetManager header file.
+ *
+ * Declaration of abcg::AssetManager class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_ASSETMANAGER_HPP_
+#define ABCG_ASSETMANAGER_HPP_
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "abcg_jobsystem.hpp"
+
+namespace abcg {
+class AssetManager;
+}  // namespace abcg
+
+/**
+ * @brief abcg::AssetManager class.
+ *
+ * Loads assets asynchronously in two stages:
+ *
+ * 1. A load function reads and decodes the asset (e.g., parses an OBJ file
+ * or decodes an image) as a background job of abcg::JobSystem::global. It
+ * must not make OpenGL calls, and returns the number of bytes that the
+ * asset will upload to the GPU.
+ * 2. An upload function creates the OpenGL objects of the asset on the
+ * thread that owns the OpenGL context. abcg::AssetManager::update is called
+ * once per frame and uploads assets, in the order their loads finished, until
+ * a budget of bytes is used.
+ *
+ * An asset can be used as soon as abcg::AssetManager::isReady returns true,
+ * while other assets are still loading.
+ *
+ * An asset whose load or upload function throws an exception is marked as
+ * failed, and counts as done for abcg::AssetManager::isDone and
+ * abcg::AssetManager::getProgress. abcg::AssetManager::update and
+ * abcg::AssetManager::finish rethrow the exception of each failed asset, one
+ * per call, in the order the failures were found.
+ *
+ * Without worker threads (e.g., on Emscripten), one load function runs per
+ * call to abcg::AssetManager::update, on the calling thread, starting at the
+ * call after the asset was added. Thus the first frame is not delayed.
+ */
+class abcg::AssetManager {
+ public:
+  using LoadFunction = std::function<std::size_t()>;
+  using UploadFunction = std::function<void()>;
+  using Handle = std::size_t;
+
+  /** @brief Default number of bytes uploaded per frame. */
+  static constexpr std::size_t defaultByteBudget{4 << 20};
+
+  AssetManager() = default;
+  ~AssetManager();
+
+  AssetManager(const AssetManager&) = delete;
+  AssetManager(AssetManager&&) = delete;
+  AssetManager& operator=(const AssetManager&) = delete;
+  AssetManager& operator=(AssetManager&&) = delete;
+
+  Handle add(LoadFunction load, UploadFunction upload);
+  void update(std::size_t byteBudget = defaultByteBudget);
+  void finish();
+
+  [[nodiscard]] bool isReady(Handle handle) const;
+  [[nodiscard]] bool isFailed(Handle handle) const;
+  [[nodiscard]] bool isDone() const noexcept {
+    return m_numReady + m_numFailed == m_assets.size();
+  }
+  [[nodiscard]] float getProgress() const noexcept;
+  [[nodiscard]] std::size_t getUploadedBytes() const noexcept {
+    return m_uploadedBytes;
+  }
+
+ private:
+  enum class State { Queued, Loading, Loaded, Ready, Failed };
+
+  struct Asset {
+    LoadFunction load;
+    UploadFunction upload;
+    State state{State::Queued};
+    std::size_t frame{};
+    std::size_t uploadSize{};
+    std::exception_ptr exception;
+  };
+
+  // Elements of a deque are not moved when assets are added, so the jobs
+  // can keep pointers to them
+  std::deque<Asset> m_assets;
+
+  // Assets waiting for a load job, assets loaded but not uploaded, and failed
+  // assets whose exception was not rethrown yet
+  std::deque<Handle> m_loadQueue;
+  std::deque<Handle> m_uploadQueue;
+  std::deque<Handle> m_failedQueue;
+  std::size_t m_numLoading{};
+  std::size_t m_numLoaded{};
+  std::size_t m_numReady{};
+  std::size_t m_numFailed{};
+  std::size_t m_uploadedBytes{};
+  std::size_t m_frame{};
+
+  // Assets whose load job finished since the last update, filled by the jobs
+  std::mutex m_finishedMutex;
+  std::vector<Handle> m_finished;
+  JobCounter m_counter;
+
+  void dispatch();
+  void loadNext();
+  void collect();
+  void upload(Handle handle);
+  void fail(Handle handle);
+  void rethrowFailure();
+};
+
+#endif
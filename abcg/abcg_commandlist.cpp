@@ -0,0 +1,169 @@
+/**
+ * @file abcg_commandlist.cpp
+ * @brief Definition of abcg::CommandList class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_commandlist.hpp"
+
+#include <map>
+#include <type_traits>
+#include <utility>
+
+#include "abcg_glstatecache.hpp"
+#include "abcg_openglfunctions.hpp"
+
+namespace {
+// Sets the uniform at the given location of the current program
+void setUniform(const abcg::UniformValue &uniform) {
+  std::visit(
+      [location = uniform.location](const auto &value) {
+        using T = std::decay_t<decltype(value)>;
+        if constexpr (std::is_same_v<T, GLint>) {
+          glUniform1i(location, value);
+        } else if constexpr (std::is_same_v<T, GLfloat>) {
+          glUniform1f(location, value);
+        } else if constexpr (std::is_same_v<T, glm::vec4>) {
+          glUniform4fv(location, 1, &value.x);
+        } else if constexpr (std::is_same_v<T, glm::mat3>) {
+          glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]);
+        } else {
+          glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+        }
+      },
+      uniform.value);
+}
+}  // namespace
+
+/**
+ * @brief Removes all packets from the list.
+ *
+ * The allocated memory is kept to be reused in the next frame.
+ */
+void abcg::CommandList::clear() {
+  m_packets.clear();
+  m_uniforms.clear();
+}
+
+/**
+ * @brief Records a draw packet.
+ *
+ * This function does not make OpenGL calls and can be called from any thread,
+ * as long as each list is recorded by one thread at a time.
+ *
+ * @param packet State and parameters of the draw call.
+ * @param uniforms Uniform values of the program of the packet to set before
+ * drawing. Uniforms with location -1 are ignored.
+ */
+void abcg::CommandList::draw(const DrawPacket &packet,
+                             std::initializer_list<UniformValue> uniforms) {
+  m_packets.push_back({packet, m_uniforms.size(), uniforms.size()});
+  m_uniforms.insert(m_uniforms.end(), uniforms.begin(), uniforms.end());
+}
+
+/**
+ * @brief Appends the packets of another list to this list.
+ *
+ * @param other List to append.
+ */
+void abcg::CommandList::append(const CommandList &other) {
+  const auto uniformOffset{m_uniforms.size()};
+  m_uniforms.insert(m_uniforms.end(), other.m_uniforms.begin(),
+                    other.m_uniforms.end());
+
+  m_packets.reserve(m_packets.size() + other.m_packets.size());
+  for (auto packet : other.m_packets) {
+    packet.firstUniform += uniformOffset;
+    m_packets.push_back(packet);
+  }
+}
+
+/**
+ * @brief Sorts the packets by key and issues their draw calls.
+ *
+ * Must be called on the thread of the current OpenGL context. Packets with
+ * equal keys are drawn in the order they were recorded. The list is not
+ * cleared, so it can be submitted again in the next frame.
+ *
+ * At the end, the VAO and program bindings are reset to zero.
+ */
+void abcg::CommandList::submit() {
+  std::stable_sort(m_packets.begin(), m_packets.end(),
+                   [](const auto &lhs, const auto &rhs) {
+                     return lhs.draw.sortKey < rhs.draw.sortKey;
+                   });
+
+  auto &stateCache{abcg::GLStateCache::current()};
+
+  // Last value set to each uniform of each program during this submission
+  std::map<std::pair<GLuint, GLint>, decltype(UniformValue::value)>
+      uniformValues;
+  m_numUniformCalls = 0;
+
+  for (const auto &packet : m_packets) {
+    const auto &draw{packet.draw};
+
+    stateCache.useProgram(draw.program);
+    for (GLuint unit{}; unit < draw.textures.size(); ++unit) {
+      const auto &binding{draw.textures.at(unit)};
+      if (binding.target == 0) continue;
+      stateCache.bindTexture(unit, binding.target, binding.texture);
+      stateCache.bindSampler(unit, binding.sampler);
+    }
+    stateCache.bindVertexArray(draw.VAO);
+
+    for (auto index{packet.firstUniform};
+         index < packet.firstUniform + packet.numUniforms; ++index) {
+      const auto &uniform{m_uniforms.at(index)};
+      if (uniform.location < 0) continue;
+      auto [it, inserted]{uniformValues.try_emplace(
+          {draw.program, uniform.location}, uniform.value)};
+      if (!inserted) {
+        if (it->second == uniform.value) continue;
+        it->second = uniform.value;
+      }
+      setUniform(uniform);
+      ++m_numUniformCalls;
+    }
+
+    if (draw.indexType == 0) {
+      glDrawArrays(draw.mode, static_cast<GLint>(draw.first), draw.count);
+    } else {
+      glDrawElements(draw.mode, draw.count, draw.indexType,
+                     reinterpret_cast<void *>(draw.first));  // NOLINT
+    }
+  }
+
+  stateCache.bindVertexArray(0);
+  stateCache.useProgram(0);
+}
+
+/**
+ * @brief Builds a sort key that groups packets by state.
+ *
+ * From the most to the least significant bits, the key holds the layer (4
+ * bits), program (12 bits), texture (16 bits), VAO (16 bits) and depth (16
+ * bits). Sorting by this key draws layers in increasing order and, within a
+ * layer, minimizes program changes first and texture changes second. Only the
+ * least significant bits of each name are used.
+ *
+ * @param layer Layer of the packet (e.g. opaque geometry before the skybox).
+ * @param program Shader program.
+ * @param texture Texture of the first texture unit.
+ * @param VAO Vertex array object.
+ * @param depth Normalized depth in the range [0, 1]. Packets with the same
+ * state are drawn front to back.
+ *
+ * @return Sort key.
+ */
+std::uint64_t abcg::CommandList::makeSortKey(unsigned int layer,
+                                             GLuint program, GLuint texture,
+                                             GLuint VAO, float depth) {
+  const auto quantizedDepth{static_cast<std::uint64_t>(
+      std::clamp(depth, 0.0f, 1.0f) * 65535.0f)};
+  return (std::uint64_t{layer & 0xFU} << 60U) |
+         (std::uint64_t{program & 0xFFFU} << 48U) |
+         (std::uint64_t{texture & 0xFFFFU} << 32U) |
+         (std::uint64_t{VAO & 0xFFFFU} << 16U) | quantizedDepth;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file abcg_commandlist.hpp
+ * @brief abcg::CommandList header file.
+ *
+ * Declaration of abcg::CommandList class and related types.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_COMMANDLIST_HPP_
+#define ABCG_COMMANDLIST_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/mat3x3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec4.hpp>
+#include <initializer_list>
+#include <variant>
+#include <vector>
+
+#include "abcg_external.hpp"
+#include "abcg_jobsystem.hpp"
+
+namespace abcg {
+class CommandList;
+struct DrawPacket;
+struct TextureBinding;
+struct UniformValue;
+}  // namespace abcg
+
+/**
+ * @brief Texture and sampler bound to a texture unit by a draw packet.
+ *
+ * Texture units with a zero target are left unchanged.
+ */
+struct abcg::TextureBinding {
+  GLenum target{};
+  GLuint texture{};
+  GLuint sampler{};
+};
+
+/**
+ * @brief Value of a uniform variable set by a draw packet.
+ */
+struct abcg::UniformValue {
+  GLint location{-1};
+  std::variant<GLint, GLfloat, glm::vec4, glm::mat3, glm::mat4> value;
+};
+
+/**
+ * @brief State and parameters of one draw call.
+ *
+ * If `indexType` is zero, the packet is drawn with `glDrawArrays` and `first`
+ * is the first vertex. Otherwise it is drawn with `glDrawElements` and
+ * `first` is the byte offset of the first index in the element buffer of the
+ * VAO.
+ */
+struct abcg::DrawPacket {
+  std::uint64_t sortKey{};
+  GLuint program{};
+  GLuint VAO{};
+  std::array<TextureBinding, 4> textures{};
+  GLenum mode{GL_TRIANGLES};
+  GLenum indexType{GL_UNSIGNED_INT};
+  std::size_t first{};
+  GLsizei count{};
+};
+
+/**
+ * @brief abcg::CommandList class.
+ *
+ * List of draw packets that is recorded without making OpenGL calls, and then
+ * sorted and submitted on the thread that owns the OpenGL context.
+ *
+ * Each list must be recorded by a single thread. Work can be spread across
+ * threads by recording into one list per job and appending the lists before
+ * submission. abcg::CommandList::recordParallel does this for a range of
+ * items.
+ *
+ * During submission, state changes go through the current
+ * abcg::GLStateCache, and uniform values that are equal to the value last set
+ * by the same submission are skipped.
+ */
+class abcg::CommandList {
+ public:
+  void clear();
+  void draw(const DrawPacket& packet,
+            std::initializer_list<UniformValue> uniforms = {});
+  void append(const CommandList& other);
+  void submit();
+
+  template <typename TFun>
+  void recordParallel(std::size_t numItems, TFun&& record);
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_packets.size(); }
+  [[nodiscard]] std::size_t getNumUniformCalls() const noexcept {
+    return m_numUniformCalls;
+  }
+
+  [[nodiscard]] static std::uint64_t makeSortKey(unsigned int layer,
+                                                 GLuint program,
+                                                 GLuint texture, GLuint VAO,
+                                                 float depth = 0.0f);
+
+ private:
+  struct Packet {
+    DrawPacket draw;
+    std::size_t firstUniform{};
+    std::size_t numUniforms{};
+  };
+
+  std::vector<Packet> m_packets;
+  std::vector<UniformValue> m_uniforms;
+
+  // One list per chunk of abcg::CommandList::recordParallel
+  std::vector<CommandList> m_chunkLists;
+
+  std::size_t m_numUniformCalls{};
+};
+
+/**
+ * @brief Records the packets of a range of items using the job system.
+ *
+ * The items are split into contiguous chunks, and each chunk is recorded
+ * into a separate list by a job of abcg::JobSystem::global. The lists are
+ * then appended to this list in order, so the result is the same as
+ * recording all items sequentially.
+ *
+ * @param numItems Number of items.
+ * @param record Function called as `record(list, index)` for each item index
+ * in `[0, numItems)`. It must only record into the given list and must be
+ * safe to call concurrently for different items.
+ */
+template <typename TFun>
+void abcg::CommandList::recordParallel(std::size_t numItems, TFun&& record) {
+  auto& jobSystem{JobSystem::global()};
+
+  // A few chunks per thread balance the load, but chunks with few items are
+  // not worth the scheduling overhead
+  constexpr std::size_t minItemsPerChunk{64};
+  constexpr std::size_t chunksPerThread{4};
+  const auto numChunks{std::clamp<std::size_t>(
+      numItems / minItemsPerChunk, 1,
+      (jobSystem.getNumWorkers() + 1) * chunksPerThread)};
+
+  if (numChunks == 1) {
+    for (std::size_t index{}; index < numItems; ++index) {
+      record(*this, index);
+    }
+    return;
+  }
+
+  m_chunkLists.resize(numChunks);
+  const auto chunkSize{(numItems + numChunks - 1) / numChunks};
+  jobSystem.parallelFor(
+      numItems, chunkSize, [&](std::size_t first, std::size_t last) {
+        auto& list{m_chunkLists.at(first / chunkSize)};
+        list.clear();
+        for (auto index{first}; index < last; ++index) {
+          record(list, index);
+        }
+      });
+
+  // Rounding up the chunk size may leave the last lists unused
+  const auto numUsedChunks{(numItems + chunkSize - 1) / chunkSize};
+  for (std::size_t chunk{}; chunk < numUsedChunks; ++chunk) {
+    append(m_chunkLists.at(chunk));
+  }
+}
+
+#endif
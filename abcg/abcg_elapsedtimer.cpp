@@ -7,16 +7,68 @@
 
 #include "abcg_elapsedtimer.hpp"
 
+#include <atomic>
+
 using namespace std::chrono;
 
+namespace {
+std::atomic<bool> isFrameClockEnabled{false};
+// Time of the frame clock, as ticks of the steady clock since the time it
+// was enabled
+std::atomic<steady_clock::rep> frameClockTicks{};
+std::atomic<steady_clock::rep> frameClockBase{};
+}  // namespace
+
 double abcg::ElapsedTimer::elapsed() const {
-  return duration_cast<duration<double>>(steady_clock::now() - start).count();
+  return duration_cast<duration<double>>(now() - start).count();
 }
 
 double abcg::ElapsedTimer::restart() {
-  const auto now{steady_clock::now()};
-  const auto elapsed{duration_cast<duration<double>>(now - start).count()};
-  start = now;
+  const auto current{now()};
+  const auto elapsed{duration_cast<duration<double>>(current - start).count()};
+  start = current;
 
   return elapsed;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Selects the clock measured by all timers.
+ *
+ * When enabled, the frame clock starts at the current time of the steady
+ * clock.
+ *
+ * @param enabled Whether to use the frame clock instead of the steady clock.
+ */
+void abcg::ElapsedTimer::setFrameClock(bool enabled) noexcept {
+  if (enabled && !isFrameClockEnabled) {
+    frameClockBase = steady_clock::now().time_since_epoch().count();
+    frameClockTicks = 0;
+  }
+  isFrameClockEnabled = enabled;
+}
+
+/**
+ * @brief Advances the frame clock.
+ *
+ * @param seconds Duration of the frame.
+ */
+void abcg::ElapsedTimer::advanceFrameClock(double seconds) noexcept {
+  frameClockTicks +=
+      duration_cast<steady_clock::duration>(duration<double>(seconds)).count();
+}
+
+/**
+ * @brief Returns whether the timers measure the frame clock.
+ */
+bool abcg::ElapsedTimer::usesFrameClock() noexcept {
+  return isFrameClockEnabled.load(std::memory_order_relaxed);
+}
+
+steady_clock::time_point abcg::ElapsedTimer::now() noexcept {
+  if (!isFrameClockEnabled.load(std::memory_order_relaxed)) {
+    return steady_clock::now();
+  }
+  return steady_clock::time_point{steady_clock::duration{
+      frameClockBase.load(std::memory_order_relaxed) +
+      frameClockTicks.load(std::memory_order_relaxed)}};
+}
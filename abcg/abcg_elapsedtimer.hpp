@@ -19,16 +19,25 @@ class ElapsedTimer;
 /**
  * @brief abcg::ElapsedTimer class.
  *
+ * Timers measure the steady clock, or the frame clock while it is enabled.
+ * The frame clock only advances with abcg::ElapsedTimer::advanceFrameClock,
+ * so that timers read the same values when a recorded session is replayed.
  */
 class abcg::ElapsedTimer {
  public:
   [[nodiscard]] double elapsed() const;
   double restart();
 
+  static void setFrameClock(bool enabled) noexcept;
+  static void advanceFrameClock(double seconds) noexcept;
+  [[nodiscard]] static bool usesFrameClock() noexcept;
+
  private:
   using clock = std::chrono::steady_clock;
 
-  clock::time_point start{clock::now()};
+  [[nodiscard]] static clock::time_point now() noexcept;
+
+  clock::time_point start{now()};
 };
 
 #endif
\ No newline at end of file
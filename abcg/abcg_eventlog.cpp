@@ -0,0 +1,294 @@
+/**
+ * @file abcg_eventlog.cpp
+ * @brief Definition of abcg::EventLog class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_eventlog.hpp"
+
+#include <fmt/core.h>
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+
+#include "abcg_elapsedtimer.hpp"
+#include "abcg_exception.hpp"
+#include "abcg_random.hpp"
+
+namespace {
+constexpr std::string_view magic{"ABCGLOG1"};
+
+void writeVarint(std::string &out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out += static_cast<char>((value & 0x7F) | 0x80);
+    value >>= 7U;
+  }
+  out += static_cast<char>(value);
+}
+
+// Signed integers are zigzag encoded so that small magnitudes are short
+void writeSigned(std::string &out, std::int64_t value) {
+  writeVarint(out, (static_cast<std::uint64_t>(value) << 1U) ^
+                       static_cast<std::uint64_t>(value >> 63));
+}
+
+void writeDouble(std::string &out, double value) {
+  auto bits{std::bit_cast<std::uint64_t>(value)};
+  for (std::size_t byte{}; byte < 8; ++byte, bits >>= 8U) {
+    out += static_cast<char>(bits & 0xFF);
+  }
+}
+
+// Reads the fields of a log, throwing if the log ends before a field
+class Reader {
+ public:
+  Reader(const std::vector<unsigned char> &data, std::size_t &offset,
+         const std::string &path)
+      : m_data{data}, m_offset{offset}, m_path{path} {}
+
+  std::uint64_t varint() {
+    std::uint64_t value{};
+    for (unsigned int shift{}; shift < 64; shift += 7) {
+      const auto byte{next()};
+      value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) return value;
+    }
+    throw invalid();
+  }
+
+  std::int64_t signedVarint() {
+    const auto value{varint()};
+    return static_cast<std::int64_t>(value >> 1U) ^
+           -static_cast<std::int64_t>(value & 1U);
+  }
+
+  double float64() {
+    std::uint64_t bits{};
+    for (unsigned int byte{}; byte < 8; ++byte) {
+      bits |= static_cast<std::uint64_t>(next()) << (8 * byte);
+    }
+    return std::bit_cast<double>(bits);
+  }
+
+  void bytes(void *destination, std::size_t size) {
+    if (size > m_data.size() - m_offset) throw invalid();
+    std::memcpy(destination, m_data.data() + m_offset, size);
+    m_offset += size;
+  }
+
+ private:
+  const std::vector<unsigned char> &m_data;
+  std::size_t &m_offset;
+  const std::string &m_path;
+
+  unsigned char next() {
+    if (m_offset >= m_data.size()) throw invalid();
+    return m_data[m_offset++];
+  }
+
+  [[nodiscard]] abcg::Exception invalid() const {
+    return abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Invalid event log {}", m_path))};
+  }
+};
+}  // namespace
+
+/**
+ * @brief Opens an event log.
+ *
+ * When recording, the base seed of abcg::randomSeed is written to the log.
+ * If no base seed was set, one is taken from the steady clock. When
+ * replaying, the base seed is read from the log.
+ *
+ * @param mode Whether to record or replay.
+ * @param path Path of the log.
+ *
+ * @throw abcg::Exception if the log cannot be opened, or is not a valid log
+ * when replaying.
+ */
+abcg::EventLog::EventLog(Mode mode, const std::string &path)
+    : m_mode{mode}, m_path{path} {
+  if (m_mode == Mode::Record) {
+    m_stream.open(path, std::ios::binary);
+    if (!m_stream) {
+      throw abcg::Exception{abcg::Exception::Runtime(
+          fmt::format("Failed to open event log {}", path))};
+    }
+
+    const auto seed{getRandomSeed().value_or(randomSeed())};
+    setRandomSeed(seed);
+
+    std::string header{magic};
+    writeVarint(header, seed);
+    m_stream.write(header.data(), static_cast<std::streamsize>(header.size()));
+  } else {
+    std::ifstream stream{path, std::ios::binary};
+    if (!stream) {
+      throw abcg::Exception{abcg::Exception::Runtime(
+          fmt::format("Failed to open event log {}", path))};
+    }
+    m_data.assign(std::istreambuf_iterator<char>{stream},
+                  std::istreambuf_iterator<char>{});
+
+    Reader reader{m_data, m_offset, m_path};
+    std::array<char, magic.size()> header{};
+    reader.bytes(header.data(), header.size());
+    if (std::string_view{header.data(), header.size()} != magic) {
+      throw abcg::Exception{abcg::Exception::Runtime(
+          fmt::format("Invalid event log {}", path))};
+    }
+    setRandomSeed(static_cast<unsigned int>(reader.varint()));
+  }
+
+  ElapsedTimer::setFrameClock(true);
+}
+
+abcg::EventLog::~EventLog() { ElapsedTimer::setFrameClock(false); }
+
+/**
+ * @brief Starts a frame and advances the frame clock.
+ *
+ * When replaying, reads the record of the frame.
+ *
+ * @throw abcg::Exception if the record is invalid.
+ */
+void abcg::EventLog::beginFrame() {
+  m_events.clear();
+  m_nextEvent = 0;
+  m_mouseStateChanged = false;
+
+  if (m_mode == Mode::Record) {
+    const auto now{clock::now()};
+    m_frameDuration =
+        m_frame == 0
+            ? 0.0
+            : std::chrono::duration<double>(now - m_frameStart).count();
+    m_frameStart = now;
+  } else {
+    if (isDone()) return;
+
+    Reader reader{m_data, m_offset, m_path};
+    m_frameDuration = reader.float64();
+    if (reader.varint() != 0) {
+      m_mouseState.x = static_cast<int>(reader.signedVarint());
+      m_mouseState.y = static_cast<int>(reader.signedVarint());
+      m_mouseState.buttons = static_cast<Uint32>(reader.varint());
+    }
+
+    const auto numEvents{reader.varint()};
+    for (std::uint64_t index{}; index < numEvents; ++index) {
+      const auto size{reader.varint()};
+      if (size > sizeof(SDL_Event)) {
+        throw abcg::Exception{abcg::Exception::Runtime(
+            fmt::format("Invalid event log {}", m_path))};
+      }
+      SDL_Event event{};
+      reader.bytes(&event, static_cast<std::size_t>(size));
+      m_events.push_back(event);
+    }
+  }
+
+  ElapsedTimer::advanceFrameClock(m_frameDuration);
+}
+
+/**
+ * @brief Ends a frame. When recording, writes the record of the frame.
+ */
+void abcg::EventLog::endFrame() {
+  ++m_frame;
+  if (m_mode != Mode::Record) return;
+
+  std::string record;
+  writeDouble(record, m_frameDuration);
+  writeVarint(record, m_mouseStateChanged ? 1 : 0);
+  if (m_mouseStateChanged) {
+    writeSigned(record, m_mouseState.x);
+    writeSigned(record, m_mouseState.y);
+    writeVarint(record, m_mouseState.buttons);
+  }
+
+  writeVarint(record, m_events.size());
+  for (const auto &event : m_events) {
+    std::array<unsigned char, sizeof(SDL_Event)> bytes{};
+    std::memcpy(bytes.data(), &event, bytes.size());
+    auto size{bytes.size()};
+    while (size > 0 && bytes.at(size - 1) == 0) --size;
+    writeVarint(record, size);
+    record.append(reinterpret_cast<const char *>(bytes.data()), size);
+  }
+
+  m_stream.write(record.data(), static_cast<std::streamsize>(record.size()));
+}
+
+/**
+ * @brief Returns the mouse state of the current frame.
+ *
+ * When recording, the state is read from SDL_GetMouseState and recorded.
+ * When replaying, the recorded state is returned.
+ *
+ * @return Mouse position relative to the focused window, and mask of the
+ * pressed buttons.
+ */
+abcg::EventLog::MouseState abcg::EventLog::updateMouseState() {
+  if (m_mode == Mode::Record) {
+    MouseState state{};
+    state.buttons = SDL_GetMouseState(&state.x, &state.y);
+    m_mouseStateChanged = state != m_mouseState;
+    m_mouseState = state;
+  }
+  return m_mouseState;
+}
+
+/**
+ * @brief Records an input event of the current frame.
+ *
+ * @param event Input event, as given by abcg::EventLog::isInputEvent.
+ */
+void abcg::EventLog::recordEvent(const SDL_Event &event) {
+  if (m_mode == Mode::Record) m_events.push_back(event);
+}
+
+/**
+ * @brief Returns the next recorded event of the current frame.
+ *
+ * The event is stamped with the current SDL time, as the recorded
+ * timestamp belongs to the recorded session.
+ *
+ * @param event Replayed event.
+ *
+ * @return false if there are no more events in the frame.
+ */
+bool abcg::EventLog::nextEvent(SDL_Event &event) {
+  if (m_mode != Mode::Replay || m_nextEvent >= m_events.size()) return false;
+  event = m_events.at(m_nextEvent++);
+  event.common.timestamp = SDL_GetTicks();
+  return true;
+}
+
+/**
+ * @brief Returns whether an event is recorded.
+ *
+ * Input events are recorded. Window events are not, as they depend on the
+ * window manager, and are still handled when replaying.
+ *
+ * @param event SDL event.
+ *
+ * @return true for keyboard, mouse, joystick, controller and touch events.
+ */
+bool abcg::EventLog::isInputEvent(const SDL_Event &event) noexcept {
+  return event.type >= SDL_KEYDOWN && event.type < SDL_CLIPBOARDUPDATE;
+}
+
+/**
+ * @brief Returns whether all recorded frames were replayed.
+ *
+ * @return Whether the log is replayed and has no more frames.
+ */
+bool abcg::EventLog::isDone() const noexcept {
+  return m_mode == Mode::Replay && m_offset >= m_data.size();
+}
@@ -0,0 +1,102 @@
+/**
+ * @file abcg_eventlog.hpp
+ * @brief abcg::EventLog header file.
+ *
+ * Declaration of abcg::EventLog class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_EVENTLOG_HPP_
+#define ABCG_EVENTLOG_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class EventLog;
+}  // namespace abcg
+
+/**
+ * @brief abcg::EventLog class.
+ *
+ * Records the input events of a session, or replays a recorded session.
+ *
+ * The log is a binary file with the base seed of abcg::randomSeed followed by
+ * one record per frame, in order of frame index. A record contains:
+ *
+ * - the duration of the frame;
+ * - the mouse state, if it has changed;
+ * - the input events polled in the frame (keyboard, mouse, joystick,
+ * controller and touch events), with trailing zero bytes trimmed.
+ *
+ * While a log is open, abcg::ElapsedTimer measures the frame clock. It is
+ * advanced by the measured duration of each frame when recording, and by
+ * the recorded duration when replaying. Thus, a replay runs as fast as
+ * possible with the same timesteps, timers and random numbers as the
+ * recorded session.
+ *
+ * abcg::Application records a session with `--record <file>` and replays it
+ * with `--replay <file>`. The mouse state must be read with
+ * abcg::OpenGLWindow::getMouseState instead of SDL_GetMouseState.
+ */
+class abcg::EventLog {
+ public:
+  enum class Mode { Record, Replay };
+
+  struct MouseState {
+    int x{};
+    int y{};
+    Uint32 buttons{};
+
+    bool operator==(const MouseState&) const = default;
+  };
+
+  EventLog(Mode mode, const std::string& path);
+  ~EventLog();
+
+  EventLog(const EventLog&) = delete;
+  EventLog(EventLog&&) = delete;
+  EventLog& operator=(const EventLog&) = delete;
+  EventLog& operator=(EventLog&&) = delete;
+
+  void beginFrame();
+  void endFrame();
+
+  MouseState updateMouseState();
+  void recordEvent(const SDL_Event& event);
+  bool nextEvent(SDL_Event& event);
+
+  [[nodiscard]] static bool isInputEvent(const SDL_Event& event) noexcept;
+
+  [[nodiscard]] Mode getMode() const noexcept { return m_mode; }
+  [[nodiscard]] std::size_t getFrame() const noexcept { return m_frame; }
+  [[nodiscard]] bool isDone() const noexcept;
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  Mode m_mode;
+  std::string m_path;
+  std::size_t m_frame{};
+  double m_frameDuration{};
+  MouseState m_mouseState{};
+  bool m_mouseStateChanged{};
+  std::vector<SDL_Event> m_events;
+
+  // Record mode: file and start of the current frame
+  std::ofstream m_stream;
+  clock::time_point m_frameStart{};
+
+  // Replay mode: whole log and read position
+  std::vector<unsigned char> m_data;
+  std::size_t m_offset{};
+  std::size_t m_nextEvent{};
+};
+
+#endif
@@ -31,6 +31,15 @@ std::string abcg::Exception::OpenGL(
          ":" + std::to_string(sourceLocation.line());
 }
 
+std::string abcg::Exception::OpenGLDebug(std::string_view message,
+                                         std::string_view fileName,
+                                         std::string_view functionName,
+                                         unsigned int line) {
+  return std::string{codeRed} + "OpenGL debug output" + codeReset + " (" +
+         message.data() + ") after " + fileName.data() + ":" +
+         functionName.data() + ":" + std::to_string(line);
+}
+
 std::string abcg::Exception::SDL(
     std::string_view what,
     const std::experimental::source_location& sourceLocation) {
@@ -40,6 +40,11 @@ class abcg::Exception : public std::runtime_error {
       const std::experimental::source_location& sourceLocation =
           std::experimental::source_location::current());
 
+  static std::string OpenGLDebug(std::string_view message,
+                                 std::string_view fileName,
+                                 std::string_view functionName,
+                                 unsigned int line);
+
   static std::string SDL(
       std::string_view what,
       const std::experimental::source_location& sourceLocation =
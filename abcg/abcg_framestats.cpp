@@ -0,0 +1,242 @@
+/**
+ * @file abcg_framestats.cpp
+ * @brief Definition of abcg::FrameStats class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_framestats.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <iterator>
+#include <string>
+
+#include "abcg_string.hpp"
+
+namespace {
+// Frames averaged before stutters are counted
+constexpr std::size_t warmUpFrames{16};
+// Weight of a new frame in the moving average
+constexpr double averageWeight{1.0 / 16.0};
+}  // namespace
+
+/**
+ * @brief Records the time since the previous call as a frame time.
+ *
+ * Called at the start of each frame. The first call after construction or
+ * after abcg::FrameStats::pause only starts the measurement.
+ */
+void abcg::FrameStats::beginFrame() {
+  const auto now{clock::now()};
+  if (!m_paused) {
+    addFrameTime(std::chrono::duration<double>(now - m_frameStart).count());
+  }
+  m_frameStart = now;
+  m_paused = false;
+}
+
+/**
+ * @brief Discards the time until the next call to
+ * abcg::FrameStats::beginFrame, e.g., while the application waits for
+ * events.
+ */
+void abcg::FrameStats::pause() noexcept { m_paused = true; }
+
+/**
+ * @brief Records a frame time.
+ *
+ * @param seconds Frame time in seconds.
+ */
+void abcg::FrameStats::addFrameTime(double seconds) {
+  const auto microseconds{static_cast<std::uint64_t>(std::clamp(
+      std::round(seconds * 1.0e6), 0.0, static_cast<double>(maxValue)))};
+
+  ++m_counts.at(getIndex(microseconds));
+  ++m_count;
+  m_min = std::min(m_min, microseconds);
+  m_max = std::max(m_max, microseconds);
+  m_sum += static_cast<double>(microseconds) / 1.0e6;
+
+  if (m_count > warmUpFrames && seconds > stutterFactor * m_average) {
+    ++m_stutters;
+  }
+  m_average = m_count == 1 ? seconds
+                           : m_average + averageWeight * (seconds - m_average);
+
+  m_history.at(m_historyOffset) = static_cast<float>(seconds * 1000.0);
+  m_historyOffset = (m_historyOffset + 1) % m_history.size();
+}
+
+/**
+ * @brief Removes all recorded frame times.
+ */
+void abcg::FrameStats::reset() { *this = FrameStats{}; }
+
+/**
+ * @brief Returns the shortest frame time.
+ *
+ * @return Frame time in milliseconds, or 0 if no frame was recorded.
+ */
+double abcg::FrameStats::getMin() const noexcept {
+  return m_count == 0 ? 0.0 : static_cast<double>(m_min) / 1000.0;
+}
+
+/**
+ * @brief Returns the longest frame time.
+ *
+ * @return Frame time in milliseconds.
+ */
+double abcg::FrameStats::getMax() const noexcept {
+  return static_cast<double>(m_max) / 1000.0;
+}
+
+/**
+ * @brief Returns the mean frame time of all recorded frames.
+ *
+ * @return Frame time in milliseconds, or 0 if no frame was recorded.
+ */
+double abcg::FrameStats::getMean() const noexcept {
+  return m_count == 0 ? 0.0 : m_sum * 1000.0 / static_cast<double>(m_count);
+}
+
+/**
+ * @brief Returns a percentile of the frame times.
+ *
+ * @param percentile Percentile between 0 and 100 (e.g., 99.9).
+ *
+ * @return Frame time in milliseconds below or at which the given percentage
+ * of frames fall, or 0 if no frame was recorded.
+ */
+double abcg::FrameStats::getPercentile(double percentile) const {
+  if (m_count == 0) return 0.0;
+
+  const auto rank{std::max<std::uint64_t>(
+      1, static_cast<std::uint64_t>(std::ceil(
+             std::clamp(percentile, 0.0, 100.0) / 100.0 *
+             static_cast<double>(m_count))))};
+  std::uint64_t cumulative{};
+  for (std::size_t index{}; index < m_counts.size(); ++index) {
+    cumulative += m_counts[index];
+    if (cumulative >= rank) {
+      // Middle of the bucket, within the exact extremes
+      const auto value{static_cast<double>(getLowerBound(index)) +
+                       static_cast<double>(getWidth(index) - 1) / 2.0};
+      return std::clamp(value, static_cast<double>(m_min),
+                        static_cast<double>(m_max)) /
+             1000.0;
+    }
+  }
+  return getMax();
+}
+
+/**
+ * @brief Returns the mean frame time of the frames in the history.
+ *
+ * @return Frame time in milliseconds, or 0 if no frame was recorded.
+ */
+double abcg::FrameStats::getRecentMean() const noexcept {
+  const auto numFrames{std::min(m_count, m_history.size())};
+  if (numFrames == 0) return 0.0;
+
+  double sum{};
+  for (std::size_t frame{1}; frame <= numFrames; ++frame) {
+    sum += static_cast<double>(
+        m_history[(m_historyOffset + m_history.size() - frame) %
+                  m_history.size()]);
+  }
+  return sum / static_cast<double>(numFrames);
+}
+
+/**
+ * @brief Writes the statistics as a CSV row.
+ *
+ * The columns are window, frames, min_ms, mean_ms, p50_ms, p99_ms,
+ * p99.9_ms, max_ms and stutters.
+ *
+ * @param stream Output stream.
+ * @param name Name of the window.
+ * @param header Whether to write the header row first.
+ */
+void abcg::FrameStats::writeCSV(std::ostream &stream, std::string_view name,
+                                bool header) const {
+  std::string csv;
+  if (header) {
+    csv +=
+        "window,frames,min_ms,mean_ms,p50_ms,p99_ms,p99.9_ms,max_ms,"
+        "stutters\n";
+  }
+
+  // Names are quoted, with quotes doubled
+  std::string quoted;
+  for (const auto character : name) {
+    quoted += character;
+    if (character == '"') quoted += character;
+  }
+  fmt::format_to(std::back_inserter(csv),
+                 "\"{}\",{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{}\n",
+                 quoted, m_count, getMin(), getMean(), getPercentile(50.0),
+                 getPercentile(99.0), getPercentile(99.9), getMax(),
+                 m_stutters);
+  stream << csv;
+}
+
+/**
+ * @brief Writes the statistics and the histogram as a JSON object.
+ *
+ * The histogram is an array of the non-empty buckets, each an array of the
+ * lower bound in milliseconds, the upper bound in milliseconds and the number
+ * of frames.
+ *
+ * @param stream Output stream.
+ * @param name Name of the window.
+ */
+void abcg::FrameStats::writeJSON(std::ostream &stream,
+                                 std::string_view name) const {
+  std::string json;
+  auto out{std::back_inserter(json)};
+  fmt::format_to(out,
+                 R"({{"window":"{}","frames":{},"min_ms":{:.3f},)"
+                 R"("mean_ms":{:.3f},"p50_ms":{:.3f},"p99_ms":{:.3f},)"
+                 R"("p99.9_ms":{:.3f},"max_ms":{:.3f},"stutters":{},)"
+                 R"("histogram":[)",
+                 escapeJSON(name), m_count, getMin(), getMean(),
+                 getPercentile(50.0), getPercentile(99.0), getPercentile(99.9),
+                 getMax(), m_stutters);
+
+  auto first{true};
+  for (std::size_t index{}; index < m_counts.size(); ++index) {
+    if (m_counts[index] == 0) continue;
+    if (!first) json += ',';
+    first = false;
+    const auto lowerBound{getLowerBound(index)};
+    fmt::format_to(out, "[{:.3f},{:.3f},{}]",
+                   static_cast<double>(lowerBound) / 1000.0,
+                   static_cast<double>(lowerBound + getWidth(index)) / 1000.0,
+                   m_counts[index]);
+  }
+  json += "]}";
+  stream << json;
+}
+
+std::size_t abcg::FrameStats::getIndex(std::uint64_t value) noexcept {
+  if (value < subBucketCount) return value;
+
+  const auto shift{std::bit_width(value) - subBucketBits};
+  return shift * (subBucketCount / 2) + (value >> shift);
+}
+
+std::uint64_t abcg::FrameStats::getLowerBound(std::size_t index) noexcept {
+  if (index < subBucketCount) return index;
+
+  const auto shift{index / (subBucketCount / 2) - 1};
+  return (index - shift * (subBucketCount / 2)) << shift;
+}
+
+std::uint64_t abcg::FrameStats::getWidth(std::size_t index) noexcept {
+  if (index < subBucketCount) return 1;
+  return std::uint64_t{1} << (index / (subBucketCount / 2) - 1);
+}
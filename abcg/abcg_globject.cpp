@@ -0,0 +1,145 @@
+/**
+ * @file abcg_globject.cpp
+ * @brief Definition of abcg::GLObject and abcg::GLObjectTracker class
+ * members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_globject.hpp"
+
+#include <array>
+#include <atomic>
+
+#include "abcg_glstatecache.hpp"
+#include "abcg_openglfunctions.hpp"
+
+namespace {
+// Live objects and bytes of each type. Objects may be released by threads
+// other than the one that draws the UI, so the counters are atomic
+std::array<std::atomic<std::size_t>, abcg::GLObjectTracker::numTypes>
+    liveCounts{};
+std::array<std::atomic<std::size_t>, abcg::GLObjectTracker::numTypes>
+    liveBytes{};
+
+constexpr std::array<std::string_view, abcg::GLObjectTracker::numTypes>
+    typeNames{"Buffers", "Vertex arrays", "Textures", "Programs",
+              "Framebuffers"};
+}  // namespace
+
+/**
+ * @brief Returns the live objects of a type.
+ *
+ * @param type Type of the objects.
+ *
+ * @return Number of live objects and sum of their sizes in bytes.
+ */
+abcg::GLObjectTracker::Stats abcg::GLObjectTracker::getStats(
+    GLObjectType type) noexcept {
+  const auto index{static_cast<std::size_t>(type)};
+  return {liveCounts.at(index).load(std::memory_order_relaxed),
+          liveBytes.at(index).load(std::memory_order_relaxed)};
+}
+
+/**
+ * @brief Returns the name of a type of object, for display.
+ *
+ * @param type Type of the objects.
+ *
+ * @return Plural name of the type, e.g., "Buffers".
+ */
+std::string_view abcg::GLObjectTracker::getTypeName(
+    GLObjectType type) noexcept {
+  return typeNames.at(static_cast<std::size_t>(type));
+}
+
+void abcg::GLObjectTracker::add(GLObjectType type, std::size_t count,
+                                std::size_t bytes) noexcept {
+  const auto index{static_cast<std::size_t>(type)};
+  liveCounts.at(index).fetch_add(count, std::memory_order_relaxed);
+  liveBytes.at(index).fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void abcg::GLObjectTracker::remove(GLObjectType type, std::size_t count,
+                                   std::size_t bytes) noexcept {
+  const auto index{static_cast<std::size_t>(type)};
+  liveCounts.at(index).fetch_sub(count, std::memory_order_relaxed);
+  liveBytes.at(index).fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Creates a new object, deleting the current one.
+ */
+template <abcg::GLObjectType Type>
+void abcg::GLObject<Type>::create() {
+  destroy();
+
+  if constexpr (Type == GLObjectType::Buffer) {
+    glGenBuffers(1, &m_name);
+  } else if constexpr (Type == GLObjectType::VertexArray) {
+    glGenVertexArrays(1, &m_name);
+  } else if constexpr (Type == GLObjectType::Texture) {
+    glGenTextures(1, &m_name);
+  } else if constexpr (Type == GLObjectType::Program) {
+    m_name = glCreateProgram();
+  } else {
+    glGenFramebuffers(1, &m_name);
+  }
+
+  if (m_name != 0) GLObjectTracker::add(Type, 1, 0);
+}
+
+/**
+ * @brief Deletes the object.
+ *
+ * Programs, vertex arrays and textures are deleted through
+ * abcg::GLStateCache::current, which forgets their bindings. Errors are not
+ * checked, as this is called by the destructor.
+ */
+template <abcg::GLObjectType Type>
+void abcg::GLObject<Type>::destroy() noexcept {
+  if (m_name == 0) return;
+
+  if constexpr (Type == GLObjectType::Buffer) {
+    ::glDeleteBuffers(1, &m_name);
+  } else if constexpr (Type == GLObjectType::VertexArray) {
+    GLStateCache::current().deleteVertexArray(m_name);
+  } else if constexpr (Type == GLObjectType::Texture) {
+    GLStateCache::current().deleteTexture(m_name);
+  } else if constexpr (Type == GLObjectType::Program) {
+    GLStateCache::current().deleteProgram(m_name);
+  } else {
+    ::glDeleteFramebuffers(1, &m_name);
+  }
+
+  GLObjectTracker::remove(Type, 1, m_size);
+  m_name = 0;
+  m_size = 0;
+}
+
+/**
+ * @brief Creates and initializes the data store of the buffer.
+ *
+ * The buffer is created if needed, and is left bound to `target`.
+ *
+ * @param target Binding point of the buffer (e.g., GL_ARRAY_BUFFER).
+ * @param size Size of the data store in bytes.
+ * @param data Data copied to the data store, or `nullptr`.
+ * @param usage Usage hint (e.g., GL_STATIC_DRAW).
+ */
+template <abcg::GLObjectType Type>
+void abcg::GLObject<Type>::setData(GLenum target, GLsizeiptr size,
+                                   const void *data, GLenum usage)
+  requires(Type == GLObjectType::Buffer)
+{
+  if (m_name == 0) create();
+  glBindBuffer(target, m_name);
+  glBufferData(target, size, data, usage);
+  setSize(static_cast<std::size_t>(size));
+}
+
+template class abcg::GLObject<abcg::GLObjectType::Buffer>;
+template class abcg::GLObject<abcg::GLObjectType::VertexArray>;
+template class abcg::GLObject<abcg::GLObjectType::Texture>;
+template class abcg::GLObject<abcg::GLObjectType::Program>;
+template class abcg::GLObject<abcg::GLObjectType::Framebuffer>;
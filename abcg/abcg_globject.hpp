@@ -0,0 +1,159 @@
+/**
+ * @file abcg_globject.hpp
+ * @brief abcg::GLObject header file.
+ *
+ * Declaration of abcg::GLObject class template, its aliases for each type of
+ * OpenGL object, and abcg::GLObjectTracker class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_GLOBJECT_HPP_
+#define ABCG_GLOBJECT_HPP_
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+enum class GLObjectType { Buffer, VertexArray, Texture, Program, Framebuffer };
+class GLObjectTracker;
+template <GLObjectType Type>
+class GLObject;
+
+using Buffer = GLObject<GLObjectType::Buffer>;
+using VertexArray = GLObject<GLObjectType::VertexArray>;
+using Texture = GLObject<GLObjectType::Texture>;
+using Program = GLObject<GLObjectType::Program>;
+using Framebuffer = GLObject<GLObjectType::Framebuffer>;
+}  // namespace abcg
+
+/**
+ * @brief abcg::GLObjectTracker class.
+ *
+ * Number of live OpenGL objects owned by abcg::GLObject, and their size in
+ * bytes, for each type of object. Sizes are only known for objects whose size
+ * was given with abcg::GLObject::setSize or abcg::Buffer::setData.
+ */
+class abcg::GLObjectTracker {
+ public:
+  static constexpr std::size_t numTypes{5};
+
+  /**
+   * @brief Live objects of a type.
+   */
+  struct Stats {
+    std::size_t count{};
+    std::size_t bytes{};
+  };
+
+  [[nodiscard]] static Stats getStats(GLObjectType type) noexcept;
+  [[nodiscard]] static std::string_view getTypeName(GLObjectType type) noexcept;
+
+ private:
+  template <GLObjectType Type>
+  friend class GLObject;
+
+  static void add(GLObjectType type, std::size_t count,
+                  std::size_t bytes) noexcept;
+  static void remove(GLObjectType type, std::size_t count,
+                     std::size_t bytes) noexcept;
+};
+
+/**
+ * @brief abcg::GLObject class template.
+ *
+ * Move-only owner of the name of an OpenGL object. The object is deleted when
+ * the owner is destroyed or assigned, so objects stored in containers are
+ * released when they are removed. Live objects are counted by
+ * abcg::GLObjectTracker.
+ *
+ * The OpenGL context that created the object must be current when it is
+ * deleted, and abcg::GLStateCache::current must return the cache of that
+ * context. abcg::OpenGLWindow makes both current while it is initialized,
+ * handles events or is painted, and abcg::Application makes them current
+ * while it destroys the window, so objects owned by a window meet this
+ * requirement.
+ *
+ * @tparam Type Type of the OpenGL object.
+ */
+template <abcg::GLObjectType Type>
+class abcg::GLObject {
+ public:
+  GLObject() = default;
+  explicit GLObject(GLuint name) noexcept;
+  ~GLObject() { destroy(); }
+
+  GLObject(const GLObject&) = delete;
+  GLObject(GLObject&& other) noexcept
+      : m_name{std::exchange(other.m_name, 0)},
+        m_size{std::exchange(other.m_size, 0)} {}
+  GLObject& operator=(const GLObject&) = delete;
+  GLObject& operator=(GLObject&& other) noexcept;
+
+  void create();
+  void destroy() noexcept;
+  [[nodiscard]] GLuint release() noexcept;
+  void setSize(std::size_t bytes) noexcept;
+  void setData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+    requires(Type == GLObjectType::Buffer);
+
+  [[nodiscard]] GLuint get() const noexcept { return m_name; }
+  [[nodiscard]] std::size_t getSize() const noexcept { return m_size; }
+  explicit operator bool() const noexcept { return m_name != 0; }
+
+ private:
+  GLuint m_name{};
+  std::size_t m_size{};
+};
+
+/**
+ * @brief Takes ownership of an existing object.
+ *
+ * @param name Name of the object, e.g., returned by abcg::opengl::loadTexture
+ * or abcg::OpenGLWindow::createProgramFromFile. Can be zero.
+ */
+template <abcg::GLObjectType Type>
+abcg::GLObject<Type>::GLObject(GLuint name) noexcept : m_name{name} {
+  if (m_name != 0) GLObjectTracker::add(Type, 1, 0);
+}
+
+template <abcg::GLObjectType Type>
+abcg::GLObject<Type>& abcg::GLObject<Type>::operator=(
+    GLObject&& other) noexcept {
+  if (this != &other) {
+    destroy();
+    m_name = std::exchange(other.m_name, 0);
+    m_size = std::exchange(other.m_size, 0);
+  }
+  return *this;
+}
+
+/**
+ * @brief Stops owning the object without deleting it.
+ *
+ * @return Name of the object, which must now be deleted by the caller.
+ */
+template <abcg::GLObjectType Type>
+GLuint abcg::GLObject<Type>::release() noexcept {
+  if (m_name != 0) GLObjectTracker::remove(Type, 1, m_size);
+  m_size = 0;
+  return std::exchange(m_name, 0);
+}
+
+/**
+ * @brief Sets the number of bytes of GPU memory used by the object.
+ *
+ * @param bytes Size of the data store of the object.
+ */
+template <abcg::GLObjectType Type>
+void abcg::GLObject<Type>::setSize(std::size_t bytes) noexcept {
+  if (m_name == 0) return;
+  GLObjectTracker::remove(Type, 0, m_size);
+  GLObjectTracker::add(Type, 0, bytes);
+  m_size = bytes;
+}
+
+#endif
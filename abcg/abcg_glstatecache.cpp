@@ -0,0 +1,293 @@
+/**
+ * @file abcg_glstatecache.cpp
+ * @brief Definition of abcg::GLStateCache class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_glstatecache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+
+#include "abcg_openglfunctions.hpp"
+
+namespace {
+// Index of a texture target in the per-unit table, if it is cached
+std::optional<std::size_t> textureTargetIndex(GLenum target) {
+  switch (target) {
+    case GL_TEXTURE_2D:
+      return 0;
+    case GL_TEXTURE_CUBE_MAP:
+      return 1;
+    case GL_TEXTURE_3D:
+      return 2;
+    case GL_TEXTURE_2D_ARRAY:
+      return 3;
+    default:
+      return std::nullopt;
+  }
+}
+
+// Index of a capability in the table of enable caps, if it is cached
+std::optional<std::size_t> capabilityIndex(GLenum cap) {
+  switch (cap) {
+    case GL_BLEND:
+      return 0;
+    case GL_CULL_FACE:
+      return 1;
+    case GL_DEPTH_TEST:
+      return 2;
+    case GL_SCISSOR_TEST:
+      return 3;
+    case GL_STENCIL_TEST:
+      return 4;
+    case GL_POLYGON_OFFSET_FILL:
+      return 5;
+    case GL_RASTERIZER_DISCARD:
+      return 6;
+    case GL_SAMPLE_ALPHA_TO_COVERAGE:
+      return 7;
+    default:
+      return std::nullopt;
+  }
+}
+
+thread_local abcg::GLStateCache *currentCache{};
+}  // namespace
+
+/**
+ * @brief Updates a cached value and the counters.
+ *
+ * @param cached Reference to the cached value.
+ * @param value New value.
+ *
+ * @return true if the value has changed and the OpenGL call must be issued.
+ */
+bool abcg::GLStateCache::update(GLuint &cached, GLuint value) noexcept {
+  if (cached == value) {
+    ++m_counters.skipped;
+    return false;
+  }
+  cached = value;
+  ++m_counters.issued;
+  return true;
+}
+
+void abcg::GLStateCache::useProgram(GLuint program) {
+  if (update(m_program, program)) glUseProgram(program);
+}
+
+void abcg::GLStateCache::bindVertexArray(GLuint array) {
+  if (update(m_vertexArray, array)) glBindVertexArray(array);
+}
+
+void abcg::GLStateCache::activeTexture(GLenum texture) {
+  if (update(m_activeTexture, texture)) glActiveTexture(texture);
+}
+
+/**
+ * @brief Binds a texture to the active texture unit.
+ *
+ * @param target Texture target.
+ * @param texture Texture name.
+ */
+void abcg::GLStateCache::bindTexture(GLenum target, GLuint texture) {
+  const auto unit{m_activeTexture - GL_TEXTURE0};
+  const auto targetIndex{textureTargetIndex(target)};
+  if (m_activeTexture == m_unknown || unit >= m_maxTextureUnits ||
+      !targetIndex) {
+    // Not cached
+    ++m_counters.issued;
+    glBindTexture(target, texture);
+    return;
+  }
+
+  if (update(m_textures.at(unit).at(*targetIndex), texture)) {
+    glBindTexture(target, texture);
+  }
+}
+
+/**
+ * @brief Binds a texture to a texture unit.
+ *
+ * The active texture unit is changed only if the texture binding of the
+ * given unit changes.
+ *
+ * @param unit Texture unit index (0 for GL_TEXTURE0, and so on).
+ * @param target Texture target.
+ * @param texture Texture name.
+ */
+void abcg::GLStateCache::bindTexture(GLuint unit, GLenum target,
+                                     GLuint texture) {
+  const auto targetIndex{textureTargetIndex(target)};
+  if (unit < m_maxTextureUnits && targetIndex &&
+      m_textures.at(unit).at(*targetIndex) == texture) {
+    ++m_counters.skipped;
+    return;
+  }
+
+  activeTexture(GL_TEXTURE0 + unit);
+  bindTexture(target, texture);
+}
+
+/**
+ * @brief Binds a sampler object to a texture unit.
+ *
+ * @param unit Texture unit index (0 for GL_TEXTURE0, and so on).
+ * @param sampler Sampler name, or 0 to use the parameters of the texture.
+ */
+void abcg::GLStateCache::bindSampler(GLuint unit, GLuint sampler) {
+  if (unit >= m_maxTextureUnits) {
+    ++m_counters.issued;
+    glBindSampler(unit, sampler);
+    return;
+  }
+
+  if (update(m_samplers.at(unit), sampler)) glBindSampler(unit, sampler);
+}
+
+void abcg::GLStateCache::enable(GLenum cap) {
+  if (const auto index{capabilityIndex(cap)}) {
+    if (!update(m_capabilities.at(*index), GL_TRUE)) return;
+  } else {
+    ++m_counters.issued;
+  }
+  glEnable(cap);
+}
+
+void abcg::GLStateCache::disable(GLenum cap) {
+  if (const auto index{capabilityIndex(cap)}) {
+    if (!update(m_capabilities.at(*index), GL_FALSE)) return;
+  } else {
+    ++m_counters.issued;
+  }
+  glDisable(cap);
+}
+
+void abcg::GLStateCache::blendFunc(GLenum sfactor, GLenum dfactor) {
+  if (m_blendFunc.at(0) == sfactor && m_blendFunc.at(1) == dfactor) {
+    ++m_counters.skipped;
+    return;
+  }
+  m_blendFunc = {sfactor, dfactor};
+  ++m_counters.issued;
+  glBlendFunc(sfactor, dfactor);
+}
+
+void abcg::GLStateCache::depthFunc(GLenum func) {
+  if (update(m_depthFunc, func)) glDepthFunc(func);
+}
+
+void abcg::GLStateCache::depthMask(GLboolean flag) {
+  if (update(m_depthMask, flag)) glDepthMask(flag);
+}
+
+void abcg::GLStateCache::cullFace(GLenum mode) {
+  if (update(m_cullFace, mode)) glCullFace(mode);
+}
+
+void abcg::GLStateCache::frontFace(GLenum mode) {
+  if (update(m_frontFace, mode)) glFrontFace(mode);
+}
+
+/**
+ * @brief Deletes a program.
+ *
+ * A deleted program remains in use until another program is used, so its
+ * binding is forgotten. Errors are not checked, as this is called by
+ * destructors.
+ *
+ * @param program Program name.
+ */
+void abcg::GLStateCache::deleteProgram(GLuint program) noexcept {
+  ::glDeleteProgram(program);
+  if (m_program == program) m_program = m_unknown;
+}
+
+/**
+ * @brief Deletes a vertex array.
+ *
+ * Deleting the bound vertex array binds 0. Errors are not checked, as this is
+ * called by destructors.
+ *
+ * @param array Vertex array name.
+ */
+void abcg::GLStateCache::deleteVertexArray(GLuint array) noexcept {
+  ::glDeleteVertexArrays(1, &array);
+  if (m_vertexArray == array) m_vertexArray = 0;
+}
+
+/**
+ * @brief Deletes a texture.
+ *
+ * Deleting a texture binds 0 to each texture unit it was bound to. Errors are
+ * not checked, as this is called by destructors.
+ *
+ * @param texture Texture name.
+ */
+void abcg::GLStateCache::deleteTexture(GLuint texture) noexcept {
+  ::glDeleteTextures(1, &texture);
+  for (auto &unit : m_textures) {
+    std::replace(unit.begin(), unit.end(), texture, GLuint{0});
+  }
+}
+
+/**
+ * @brief Forgets all cached state.
+ *
+ * The next call of each state setter is always issued.
+ */
+void abcg::GLStateCache::invalidate() {
+  m_program = m_unknown;
+  m_vertexArray = m_unknown;
+  m_activeTexture = m_unknown;
+  for (auto &unit : m_textures) {
+    unit.fill(m_unknown);
+  }
+  m_samplers.fill(m_unknown);
+  m_capabilities.fill(m_unknown);
+  m_blendFunc.fill(m_unknown);
+  m_depthFunc = m_unknown;
+  m_depthMask = m_unknown;
+  m_cullFace = m_unknown;
+  m_frontFace = m_unknown;
+}
+
+/**
+ * @brief Invalidates the cache and starts counting calls of a new frame.
+ *
+ * The counters of the previous frame are available through
+ * abcg::GLStateCache::getFrameCounters.
+ */
+void abcg::GLStateCache::beginFrame() {
+  invalidate();
+  m_frameCounters = m_counters;
+  m_counters = {};
+}
+
+/**
+ * @brief Returns the cache of the window that is being initialized or
+ * painted in the calling thread.
+ *
+ * If no window is current, returns a cache shared by the thread.
+ *
+ * @return Reference to the current cache.
+ */
+abcg::GLStateCache &abcg::GLStateCache::current() {
+  if (currentCache == nullptr) {
+    thread_local GLStateCache defaultCache;
+    currentCache = &defaultCache;
+  }
+  return *currentCache;
+}
+
+/**
+ * @brief Sets the cache returned by abcg::GLStateCache::current.
+ *
+ * @param cache Pointer to the cache, or nullptr.
+ */
+void abcg::GLStateCache::makeCurrent(GLStateCache *cache) noexcept {
+  currentCache = cache;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file abcg_glstatecache.hpp
+ * @brief abcg::GLStateCache header file.
+ *
+ * Declaration of abcg::GLStateCache class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_GLSTATECACHE_HPP_
+#define ABCG_GLSTATECACHE_HPP_
+
+#include <array>
+#include <cstddef>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class GLStateCache;
+}  // namespace abcg
+
+/**
+ * @brief abcg::GLStateCache class.
+ *
+ * Shadows the OpenGL state that is most often set redundantly (bound program,
+ * VAO, textures and samplers of each texture unit, enable caps, blending,
+ * depth and culling state) and drops the calls that would not change it.
+ *
+ * Each abcg::OpenGLWindow owns a cache, which is invalidated at the beginning
+ * of each frame. Code that changes the cached state with raw OpenGL calls
+ * must call abcg::GLStateCache::invalidate afterwards.
+ *
+ * Programs, vertex arrays and textures are deleted through the cache (as
+ * abcg::GLObject does), so that a binding of a deleted name is not kept if
+ * the name is reused for a new object.
+ */
+class abcg::GLStateCache {
+ public:
+  /**
+   * @brief Number of state changing calls issued to and skipped by the cache.
+   */
+  struct Counters {
+    std::size_t issued{};
+    std::size_t skipped{};
+  };
+
+  GLStateCache() { invalidate(); }
+
+  void useProgram(GLuint program);
+  void bindVertexArray(GLuint array);
+  void activeTexture(GLenum texture);
+  void bindTexture(GLenum target, GLuint texture);
+  void bindTexture(GLuint unit, GLenum target, GLuint texture);
+  void bindSampler(GLuint unit, GLuint sampler);
+  void enable(GLenum cap);
+  void disable(GLenum cap);
+  void blendFunc(GLenum sfactor, GLenum dfactor);
+  void depthFunc(GLenum func);
+  void depthMask(GLboolean flag);
+  void cullFace(GLenum mode);
+  void frontFace(GLenum mode);
+
+  void deleteProgram(GLuint program) noexcept;
+  void deleteVertexArray(GLuint array) noexcept;
+  void deleteTexture(GLuint texture) noexcept;
+
+  void invalidate();
+  void beginFrame();
+
+  [[nodiscard]] Counters getCounters() const noexcept { return m_counters; }
+  [[nodiscard]] Counters getFrameCounters() const noexcept {
+    return m_frameCounters;
+  }
+
+  [[nodiscard]] static GLStateCache& current();
+  static void makeCurrent(GLStateCache* cache) noexcept;
+
+ private:
+  static constexpr GLuint m_unknown{~GLuint{}};
+  static constexpr std::size_t m_maxTextureUnits{32};
+  static constexpr std::size_t m_numTextureTargets{4};
+  static constexpr std::size_t m_numCapabilities{8};
+
+  GLuint m_program{m_unknown};
+  GLuint m_vertexArray{m_unknown};
+  GLuint m_activeTexture{m_unknown};
+  std::array<std::array<GLuint, m_numTextureTargets>, m_maxTextureUnits>
+      m_textures{};
+  std::array<GLuint, m_maxTextureUnits> m_samplers{};
+  std::array<GLuint, m_numCapabilities> m_capabilities{};
+  std::array<GLuint, 2> m_blendFunc{};
+  GLuint m_depthFunc{m_unknown};
+  GLuint m_depthMask{m_unknown};
+  GLuint m_cullFace{m_unknown};
+  GLuint m_frontFace{m_unknown};
+
+  Counters m_counters{};
+  Counters m_frameCounters{};
+
+  bool update(GLuint& cached, GLuint value) noexcept;
+};
+
+#endif
@@ -9,14 +9,18 @@
 
 #include <fmt/core.h>
 
+#include <algorithm>
 #include <cppitertools/itertools.hpp>
 #include <fstream>
 #include <gsl/gsl>
+#include <map>
+#include <tuple>
 #include <vector>
 
 #include "SDL_image.h"
 #include "abcg_exception.hpp"
 #include "abcg_external.hpp"
+#include "abcg_trace.hpp"
 
 void flipY(gsl::not_null<SDL_Surface*> surface) {
   auto width{static_cast<size_t>(surface->w * surface->format->BytesPerPixel)};
@@ -38,102 +42,217 @@ void flipY(gsl::not_null<SDL_Surface*> surface) {
   }
 }
 
-GLuint abcg::opengl::loadTexture(std::string_view path, bool generateMipmaps) {
-  GLuint textureID{};
+namespace {
+// Sampler objects of each OpenGL context, indexed by context and settings
+using SamplerKey = std::tuple<SDL_GLContext, GLenum, GLenum, GLenum, float>;
+std::map<SamplerKey, GLuint> samplers;
 
-  // Copy file data into buffer
-  std::ifstream input(path.data(), std::ios::binary);
-  if (!input) {
-    throw abcg::Exception{abcg::Exception::Runtime(
-        fmt::format("Failed to open texture file {}", path))};
+float getMaxSupportedAnisotropy() {
+#if !defined(__EMSCRIPTEN__)
+  if (GLEW_EXT_texture_filter_anisotropic) {
+    GLfloat maxAnisotropy{1.0f};
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy);
+    return maxAnisotropy;
   }
-  std::vector<char> buffer((std::istreambuf_iterator<char>(input)),
-                           std::istreambuf_iterator<char>());
-
-  // Load the bitmap
-  if (SDL_Surface * surface{IMG_Load(path.data())}) {
-    // Enforce RGB/RGBA
-    GLenum format{0};
-    SDL_Surface* formattedSurface{nullptr};
-    if (surface->format->BytesPerPixel == 3) {
-      formattedSurface =
-          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0);
-      format = GL_RGB;
-    } else {
-      formattedSurface =
-          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
-      format = GL_RGBA;
-    }
-    SDL_FreeSurface(surface);
+#endif
+  return 1.0f;
+}
+}  // namespace
 
-    // Generate the texture
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(format),
-                 formattedSurface->w, formattedSurface->h, 0, format,
-                 GL_UNSIGNED_BYTE, formattedSurface->pixels);
+/**
+ * @brief Returns a sampler object with the given filtering and wrapping
+ * state.
+ *
+ * Sampler objects are created on first use and shared by all callers that
+ * request the same settings in the current OpenGL context. A sampler bound to
+ * a texture unit overrides the parameters of the texture bound to that unit,
+ * so the same texture can be sampled with different settings without
+ * changing the texture object.
+ *
+ * The anisotropy is clamped to the maximum supported by the driver, and is
+ * ignored if anisotropic filtering is not available.
+ *
+ * @param settings Filtering and wrapping state.
+ *
+ * @return Name of the sampler object.
+ */
+GLuint abcg::opengl::getSampler(const SamplerSettings &settings) {
+  static const auto maxSupportedAnisotropy{getMaxSupportedAnisotropy()};
+  const auto maxAnisotropy{
+      std::clamp(settings.maxAnisotropy, 1.0f, maxSupportedAnisotropy)};
 
-    SDL_FreeSurface(formattedSurface);
+  const SamplerKey key{SDL_GL_GetCurrentContext(), settings.minFilter,
+                       settings.magFilter, settings.wrap, maxAnisotropy};
+  if (const auto it{samplers.find(key)}; it != samplers.end()) {
+    return it->second;
+  }
 
-    // Set texture filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  GLuint sampler{};
+  glGenSamplers(1, &sampler);
+  glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER,
+                      static_cast<GLint>(settings.minFilter));
+  glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER,
+                      static_cast<GLint>(settings.magFilter));
+  glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S,
+                      static_cast<GLint>(settings.wrap));
+  glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T,
+                      static_cast<GLint>(settings.wrap));
+  glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R,
+                      static_cast<GLint>(settings.wrap));
+#if !defined(__EMSCRIPTEN__)
+  if (maxAnisotropy > 1.0f) {
+    glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY_EXT, maxAnisotropy);
+  }
+#endif
 
-    // Generate the mipmap levels
-    if (generateMipmaps) {
-      glGenerateMipmap(GL_TEXTURE_2D);
+  samplers.emplace(key, sampler);
+  return sampler;
+}
 
-      // Override minifying filtering
-      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
-                      GL_LINEAR_MIPMAP_LINEAR);
+/**
+ * @brief Deletes the sampler objects created by abcg::opengl::getSampler in
+ * the current OpenGL context.
+ */
+void abcg::opengl::releaseSamplers() {
+  const auto context{SDL_GL_GetCurrentContext()};
+  for (auto it{samplers.begin()}; it != samplers.end();) {
+    if (std::get<0>(it->first) == context) {
+      glDeleteSamplers(1, &it->second);
+      it = samplers.erase(it);
+    } else {
+      ++it;
     }
+  }
+}
 
-    // Set texture wrapping
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-  } else {
+/**
+ * @brief Decodes an image file.
+ *
+ * This function does not make OpenGL calls, so it can be called from worker
+ * threads.
+ *
+ * @param path Path to the image file.
+ * @param keepAlpha Whether to keep the alpha channel of images that have one.
+ * Images are decoded to RGBA if they have an alpha channel and `keepAlpha` is
+ * true, and to RGB otherwise.
+ *
+ * @return Decoded image.
+ *
+ * @throw abcg::Exception if the file cannot be opened or decoded.
+ */
+abcg::opengl::Image abcg::opengl::loadImage(std::string_view path,
+                                            bool keepAlpha) {
+  ABCG_TRACE_SCOPE("loadImage");
+  if (!std::ifstream(path.data(), std::ios::binary)) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Failed to open texture file {}", path))};
+  }
+
+  SDL_Surface *surface{IMG_Load(path.data())};
+  if (surface == nullptr) {
     throw abcg::Exception{abcg::Exception::Runtime(
         fmt::format("Failed to load texture file {}", path))};
   }
 
+  // Enforce RGB/RGBA
+  Image image;
+  SDL_Surface *formattedSurface{nullptr};
+  if (surface->format->BytesPerPixel == 3 || !keepAlpha) {
+    formattedSurface =
+        SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0);
+    image.format = GL_RGB;
+  } else {
+    formattedSurface =
+        SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+    image.format = GL_RGBA;
+  }
+  SDL_FreeSurface(surface);
+  if (formattedSurface == nullptr) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Failed to convert texture file {}", path))};
+  }
+
+  // Copy the rows with the padding expected by glTexImage2D
+  image.width = formattedSurface->w;
+  image.height = formattedSurface->h;
+  const auto rowSize{static_cast<std::size_t>(
+      image.width * formattedSurface->format->BytesPerPixel)};
+  const auto pitch{(rowSize + 3) & ~std::size_t{3}};
+  image.pixels.resize(pitch * static_cast<std::size_t>(image.height));
+  const auto *source{
+      static_cast<const std::uint8_t *>(formattedSurface->pixels)};
+  const auto sourcePitch{static_cast<std::size_t>(formattedSurface->pitch)};
+  for (const auto row : iter::range(static_cast<std::size_t>(image.height))) {
+    std::copy_n(source + row * sourcePitch, rowSize,
+                image.pixels.data() + row * pitch);
+  }
+  SDL_FreeSurface(formattedSurface);
+
+  return image;
+}
+
+/**
+ * @brief Creates a 2D texture from a decoded image.
+ *
+ * The texture uses linear filtering and repeat wrapping.
+ *
+ * @param image Image returned by abcg::opengl::loadImage.
+ * @param generateMipmaps Whether to generate the mipmap levels.
+ *
+ * @return Name of the texture object.
+ */
+GLuint abcg::opengl::createTexture(const Image &image, bool generateMipmaps) {
+  // Generate the texture
+  GLuint textureID{};
+  glGenTextures(1, &textureID);
+  glBindTexture(GL_TEXTURE_2D, textureID);
+  glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(image.format), image.width,
+               image.height, 0, image.format, GL_UNSIGNED_BYTE,
+               image.pixels.data());
+
+  // Set texture filtering
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  // Generate the mipmap levels
+  if (generateMipmaps) {
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    // Override minifying filtering
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    GL_LINEAR_MIPMAP_LINEAR);
+  }
+
+  // Set texture wrapping
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
   glBindTexture(GL_TEXTURE_2D, 0);
 
   return textureID;
 }
 
-GLuint abcg::opengl::loadCubemap(std::array<std::string_view, 6> paths,
-                                 bool generateMipmaps) {
+/**
+ * @brief Creates a cube map texture from six decoded images.
+ *
+ * The texture uses linear filtering and clamp-to-edge wrapping.
+ *
+ * @param images Images of the faces in the order +x, -x, +y, -y, +z, -z.
+ * @param generateMipmaps Whether to generate the mipmap levels.
+ *
+ * @return Name of the texture object.
+ */
+GLuint abcg::opengl::createCubemap(const std::array<Image, 6> &images,
+                                   bool generateMipmaps) {
   GLuint textureID{};
   glGenTextures(1, &textureID);
   glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
 
-  for (auto&& [index, path] : iter::enumerate(paths)) {
-    // Copy file data into buffer
-    std::ifstream input(path.data(), std::ios::binary);
-    if (!input) {
-      throw abcg::Exception{abcg::Exception::Runtime(
-          fmt::format("Failed to open texture file {}", path))};
-    }
-    std::vector<char> buffer((std::istreambuf_iterator<char>(input)),
-                             std::istreambuf_iterator<char>());
-
-    // Load the bitmap
-    if (SDL_Surface * surface{IMG_Load(path.data())}) {
-      // Enforce RGB
-      SDL_Surface* formattedSurface{
-          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGB24, 0)};
-      SDL_FreeSurface(surface);
-
-      // Create texture
-      glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(index),
-                   0, GL_RGB, formattedSurface->w, formattedSurface->h, 0,
-                   GL_RGB, GL_UNSIGNED_BYTE, formattedSurface->pixels);
-
-      SDL_FreeSurface(formattedSurface);
-    } else {
-      throw abcg::Exception{abcg::Exception::Runtime(
-          fmt::format("Failed to load texture file {}", path))};
-    }
+  for (auto &&[index, image] : iter::enumerate(images)) {
+    glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(index),
+                 0, static_cast<GLint>(image.format), image.width,
+                 image.height, 0, image.format, GL_UNSIGNED_BYTE,
+                 image.pixels.data());
   }
 
   // Set texture wrapping
@@ -154,5 +273,22 @@ GLuint abcg::opengl::loadCubemap(std::array<std::string_view, 6> paths,
                     GL_LINEAR_MIPMAP_LINEAR);
   }
 
+  glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
   return textureID;
 }
+
+GLuint abcg::opengl::loadTexture(std::string_view path, bool generateMipmaps) {
+  return createTexture(loadImage(path), generateMipmaps);
+}
+
+GLuint abcg::opengl::loadCubemap(std::array<std::string_view, 6> paths,
+                                 bool generateMipmaps) {
+  // Faces are decoded before creating the texture, so that a missing face
+  // does not leak the texture
+  std::array<Image, 6> images;
+  for (auto &&[index, path] : iter::enumerate(paths)) {
+    images.at(index) = loadImage(path, false);
+  }
+  return createCubemap(images, generateMipmaps);
+}
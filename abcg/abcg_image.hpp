@@ -10,9 +10,41 @@
 
 #include <abcg_external.hpp>
 #include <array>
+#include <cstdint>
 #include <string_view>
+#include <vector>
 
 namespace abcg::opengl {
+/**
+ * @brief Filtering and wrapping state of a sampler object.
+ */
+struct SamplerSettings {
+  GLenum minFilter{GL_LINEAR_MIPMAP_LINEAR};
+  GLenum magFilter{GL_LINEAR};
+  GLenum wrap{GL_REPEAT};
+  float maxAnisotropy{1.0f};
+};
+
+/**
+ * @brief Decoded image in a format accepted by glTexImage2D.
+ *
+ * Rows are padded to a multiple of 4 bytes, which is the default unpack
+ * alignment of OpenGL.
+ */
+struct Image {
+  GLsizei width{};
+  GLsizei height{};
+  GLenum format{GL_RGBA};
+  std::vector<std::uint8_t> pixels;
+};
+
+[[nodiscard]] GLuint getSampler(const SamplerSettings& settings = {});
+void releaseSamplers();
+[[nodiscard]] Image loadImage(std::string_view path, bool keepAlpha = true);
+[[nodiscard]] GLuint createTexture(const Image& image,
+                                   bool generateMipmaps = true);
+[[nodiscard]] GLuint createCubemap(const std::array<Image, 6>& images,
+                                   bool generateMipmaps = true);
 [[nodiscard]] GLuint loadTexture(std::string_view path,
                                  bool generateMipmaps = true);
 [[nodiscard]] GLuint loadCubemap(std::array<std::string_view, 6> paths,
@@ -0,0 +1,225 @@
+/**
+ * @file abcg_jobsystem.cpp
+ * @brief Definition of abcg::JobSystem class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_jobsystem.hpp"
+
+#include <fmt/core.h>
+
+#include <utility>
+
+#include "abcg_trace.hpp"
+
+namespace {
+// Pool and queue of the current thread if it is a worker
+thread_local const abcg::JobSystem *currentPool{};
+thread_local std::size_t currentQueueIndex{};
+}  // namespace
+
+/**
+ * @brief Creates the worker threads.
+ *
+ * @param numWorkers Number of worker threads. Can be zero, in which case jobs
+ * only run when a thread waits for them.
+ */
+abcg::JobSystem::JobSystem(std::size_t numWorkers) {
+  m_queues.resize(numWorkers + 1);
+  for (auto &queue : m_queues) {
+    queue = std::make_unique<Queue>();
+  }
+
+  m_workers.reserve(numWorkers);
+  for (std::size_t worker{}; worker < numWorkers; ++worker) {
+    m_workers.emplace_back([this, worker] { workerLoop(worker + 1); });
+  }
+}
+
+/**
+ * @brief Stops and joins the worker threads.
+ *
+ * Jobs that are still queued are discarded.
+ */
+abcg::JobSystem::~JobSystem() {
+  {
+    const std::lock_guard lock{m_sleepMutex};
+    m_stop = true;
+  }
+  m_wakeUp.notify_all();
+  for (auto &worker : m_workers) {
+    worker.join();
+  }
+}
+
+/**
+ * @brief Adds a job to the pool.
+ *
+ * @param job Function to run.
+ * @param counter Counter of the group of the job, or `nullptr`. It is
+ * incremented now and decremented when the job finishes, and must outlive
+ * the job. Jobs without a counter must not throw exceptions, as there is no
+ * thread to rethrow them.
+ */
+void abcg::JobSystem::run(Job job, JobCounter *counter) {
+  push(*m_queues.at(getQueueIndex()), {std::move(job), counter});
+}
+
+/**
+ * @brief Adds a long-running job to the pool.
+ *
+ * Background jobs are run by the workers, in the order they were added, when
+ * there are no other jobs. Threads that wait for a group of jobs never run
+ * them, so a pool without workers never runs them.
+ *
+ * @param job Function to run.
+ * @param counter Counter of the group of the job, or `nullptr`, as in
+ * abcg::JobSystem::run.
+ */
+void abcg::JobSystem::runInBackground(Job job, JobCounter *counter) {
+  push(m_backgroundQueue, {std::move(job), counter});
+}
+
+/**
+ * @brief Waits until all jobs of a group have finished.
+ *
+ * The calling thread runs pending jobs while it waits.
+ *
+ * @param counter Counter of the group.
+ *
+ * @throw Rethrows the first exception thrown by a job of the group.
+ */
+void abcg::JobSystem::wait(JobCounter &counter) {
+  const auto queueIndex{getQueueIndex()};
+  while (!counter.isDone()) {
+    if (!tryRunOne(queueIndex)) {
+      std::this_thread::yield();
+    }
+  }
+
+  const std::lock_guard lock{counter.m_exceptionMutex};
+  if (counter.m_exception) {
+    std::rethrow_exception(std::exchange(counter.m_exception, nullptr));
+  }
+}
+
+/**
+ * @brief Returns the pool shared by the application.
+ *
+ * The pool is created on first use with the default number of workers.
+ *
+ * @return Reference to the shared pool.
+ */
+abcg::JobSystem &abcg::JobSystem::global() {
+  static JobSystem jobSystem;
+  return jobSystem;
+}
+
+/**
+ * @brief Returns the default number of worker threads.
+ *
+ * This is one less than the number of hardware threads, as the thread that
+ * waits for the jobs also runs them. It is zero on Emscripten.
+ *
+ * @return Number of worker threads.
+ */
+std::size_t abcg::JobSystem::getDefaultNumWorkers() {
+#if defined(__EMSCRIPTEN__)
+  return 0;
+#else
+  const auto numThreads{std::thread::hardware_concurrency()};
+  return numThreads > 1 ? numThreads - 1 : 0;
+#endif
+}
+
+std::size_t abcg::JobSystem::getQueueIndex() const noexcept {
+  return currentPool == this ? currentQueueIndex : 0;
+}
+
+void abcg::JobSystem::push(Queue &queue, Task task) {
+  if (task.counter != nullptr) {
+    task.counter->m_count.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  {
+    const std::lock_guard lock{queue.mutex};
+    queue.tasks.push_back(std::move(task));
+  }
+  m_numQueued.fetch_add(1, std::memory_order_release);
+
+  // Taking the lock avoids a lost wake-up of a worker that is about to sleep
+  { const std::lock_guard lock{m_sleepMutex}; }
+  m_wakeUp.notify_one();
+}
+
+// Runs a job of the given queue or, if it is empty, steals a job from
+// another queue. Workers run background jobs only when all queues are empty.
+// Returns false if there was no job to run
+bool abcg::JobSystem::tryRunOne(std::size_t queueIndex) {
+  if (m_numQueued.load(std::memory_order_acquire) == 0) return false;
+
+  Task task;
+  auto found{false};
+  for (std::size_t offset{}; offset < m_queues.size() && !found; ++offset) {
+    const auto index{(queueIndex + offset) % m_queues.size()};
+    auto &queue{*m_queues.at(index)};
+    const std::lock_guard lock{queue.mutex};
+    if (queue.tasks.empty()) continue;
+
+    // Newest job of the own queue, oldest job of other queues
+    if (offset == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    } else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    found = true;
+  }
+  if (!found && queueIndex != 0) {
+    const std::lock_guard lock{m_backgroundQueue.mutex};
+    if (!m_backgroundQueue.tasks.empty()) {
+      task = std::move(m_backgroundQueue.tasks.front());
+      m_backgroundQueue.tasks.pop_front();
+      found = true;
+    }
+  }
+  if (!found) return false;
+
+  m_numQueued.fetch_sub(1, std::memory_order_relaxed);
+  execute(task);
+  return true;
+}
+
+void abcg::JobSystem::execute(Task &task) {
+  try {
+    task.job();
+  } catch (...) {
+    if (task.counter == nullptr) throw;
+    const std::lock_guard lock{task.counter->m_exceptionMutex};
+    if (!task.counter->m_exception) {
+      task.counter->m_exception = std::current_exception();
+    }
+  }
+
+  if (task.counter != nullptr) {
+    task.counter->m_count.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void abcg::JobSystem::workerLoop(std::size_t queueIndex) {
+  currentPool = this;
+  currentQueueIndex = queueIndex;
+  Trace::setThreadName(fmt::format("Worker {}", queueIndex));
+
+  while (true) {
+    if (tryRunOne(queueIndex)) continue;
+
+    std::unique_lock lock{m_sleepMutex};
+    m_wakeUp.wait(lock, [this] {
+      return m_stop || m_numQueued.load(std::memory_order_acquire) > 0;
+    });
+    if (m_stop) return;
+  }
+}
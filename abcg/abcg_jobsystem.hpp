@@ -0,0 +1,180 @@
+/**
+ * @file abcg_jobsystem.hpp
+ * @brief abcg::JobSystem header file.
+ *
+ * Declaration of abcg::JobSystem and abcg::JobCounter classes.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_JOBSYSTEM_HPP_
+#define ABCG_JOBSYSTEM_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace abcg {
+class JobCounter;
+class JobSystem;
+}  // namespace abcg
+
+/**
+ * @brief Number of unfinished jobs of a group.
+ *
+ * A counter is passed to abcg::JobSystem::run for each job of a group, and
+ * abcg::JobSystem::wait waits until all jobs of the group have finished.
+ * The first exception thrown by a job of the group is rethrown by
+ * abcg::JobSystem::wait.
+ */
+class abcg::JobCounter {
+ public:
+  [[nodiscard]] bool isDone() const noexcept {
+    return m_count.load(std::memory_order_acquire) == 0;
+  }
+
+ private:
+  friend class JobSystem;
+
+  std::atomic<std::size_t> m_count{};
+  std::mutex m_exceptionMutex;
+  std::exception_ptr m_exception;
+};
+
+/**
+ * @brief abcg::JobSystem class.
+ *
+ * Thread pool with one job queue per thread and work stealing. A worker runs
+ * the jobs of its own queue from the most to the least recently added, and
+ * steals the oldest jobs of other queues when its queue is empty. Jobs added
+ * by threads that are not workers of the pool go to a shared queue.
+ *
+ * Threads that wait for a group of jobs help running pending jobs instead of
+ * blocking, so jobs can wait for other jobs without deadlocking the pool.
+ *
+ * Long-running jobs, such as loading files, can be added as background jobs.
+ * These are only run by workers, when there are no other jobs, so that they
+ * never delay a thread that waits for its own jobs.
+ *
+ * Without thread support (e.g., on Emscripten), the pool has no workers and
+ * all jobs run in abcg::JobSystem::wait.
+ */
+class abcg::JobSystem {
+ public:
+  using Job = std::function<void()>;
+
+  explicit JobSystem(std::size_t numWorkers = getDefaultNumWorkers());
+  ~JobSystem();
+
+  JobSystem(const JobSystem&) = delete;
+  JobSystem(JobSystem&&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  JobSystem& operator=(JobSystem&&) = delete;
+
+  void run(Job job, JobCounter* counter = nullptr);
+  void runInBackground(Job job, JobCounter* counter = nullptr);
+  void wait(JobCounter& counter);
+
+  template <typename TFun>
+  void parallelFor(std::size_t numItems, std::size_t grainSize,
+                   TFun&& function);
+
+  [[nodiscard]] std::size_t getNumWorkers() const noexcept {
+    return m_workers.size();
+  }
+
+  [[nodiscard]] static JobSystem& global();
+  [[nodiscard]] static std::size_t getDefaultNumWorkers();
+
+ private:
+  struct Task {
+    Job job;
+    JobCounter* counter{};
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // Queue 0 is shared by external threads. Queue i + 1 belongs to worker i
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  Queue m_backgroundQueue;
+  std::vector<std::thread> m_workers;
+
+  // Number of queued jobs, including background jobs, not yet taken by a
+  // thread
+  std::atomic<std::size_t> m_numQueued{};
+
+  std::mutex m_sleepMutex;
+  std::condition_variable m_wakeUp;
+  bool m_stop{};
+
+  [[nodiscard]] std::size_t getQueueIndex() const noexcept;
+  void push(Queue& queue, Task task);
+  bool tryRunOne(std::size_t queueIndex);
+  void execute(Task& task);
+  void workerLoop(std::size_t queueIndex);
+};
+
+/**
+ * @brief Calls a function for chunks of a range of items in parallel.
+ *
+ * The range `[0, numItems)` is split into chunks of `grainSize` items. The
+ * calling thread runs the first chunk and helps running the others, and
+ * returns when all chunks have been processed.
+ *
+ * @param numItems Number of items.
+ * @param grainSize Number of items per chunk. Larger chunks reduce the
+ * scheduling overhead; smaller chunks balance the load better.
+ * @param function Function called as `function(first, last)` for each chunk
+ * `[first, last)`. It must be safe to call concurrently for different chunks.
+ *
+ * @throw Rethrows the first exception thrown by `function`.
+ */
+template <typename TFun>
+void abcg::JobSystem::parallelFor(std::size_t numItems, std::size_t grainSize,
+                                  TFun&& function) {
+  if (numItems == 0) return;
+  grainSize = std::max<std::size_t>(grainSize, 1);
+  const auto numChunks{(numItems + grainSize - 1) / grainSize};
+  if (numChunks == 1 || getNumWorkers() == 0) {
+    for (std::size_t first{}; first < numItems; first += grainSize) {
+      function(first, std::min(first + grainSize, numItems));
+    }
+    return;
+  }
+
+  JobCounter counter;
+  for (std::size_t chunk{1}; chunk < numChunks; ++chunk) {
+    run(
+        [&function, chunk, grainSize, numItems] {
+          const auto first{chunk * grainSize};
+          function(first, std::min(first + grainSize, numItems));
+        },
+        &counter);
+  }
+
+  // The jobs reference this stack frame, so they must finish before leaving
+  try {
+    function(std::size_t{0}, std::min(grainSize, numItems));
+  } catch (...) {
+    try {
+      wait(counter);
+    } catch (...) {
+      // Keep the exception of the first chunk
+    }
+    throw;
+  }
+  wait(counter);
+}
+
+#endif
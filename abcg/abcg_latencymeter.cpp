@@ -0,0 +1,129 @@
+/**
+ * @file abcg_latencymeter.cpp
+ * @brief Definition of abcg::LatencyMeter class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_latencymeter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "abcg_exception.hpp"
+#include "abcg_openglfunctions.hpp"
+
+namespace {
+// Nearest-rank percentiles of a set of samples
+abcg::LatencyMeter::Percentiles getPercentiles(std::vector<double> samples) {
+  if (samples.empty()) return {};
+  std::sort(samples.begin(), samples.end());
+  const auto rank{[&samples](double percentile) {
+    const auto index{static_cast<std::size_t>(
+        std::ceil(percentile / 100.0 * static_cast<double>(samples.size())))};
+    return samples.at(std::max<std::size_t>(index, 1) - 1);
+  }};
+  return {.p50 = rank(50.0), .p95 = rank(95.0), .p99 = rank(99.0)};
+}
+}  // namespace
+
+/**
+ * @brief Enables or disables the measurement.
+ *
+ * @param enabled Whether to measure the latency.
+ * @param fenceSync Whether to also measure the completion of the frames on
+ * the GPU. Ignored on Emscripten, which cannot wait on fences.
+ */
+void abcg::LatencyMeter::setEnabled(bool enabled, bool fenceSync) noexcept {
+  m_enabled = enabled;
+#if defined(__EMSCRIPTEN__)
+  m_fenceSync = false;
+#else
+  m_fenceSync = enabled && fenceSync;
+#endif
+  m_inputTimes.clear();
+}
+
+/**
+ * @brief Adds an input event consumed by the next frame.
+ *
+ * @param event Input event with the SDL timestamp of its arrival.
+ */
+void abcg::LatencyMeter::addInput(const SDL_Event &event) {
+  if (!m_enabled) return;
+
+  // The SDL timestamp counts milliseconds since SDL was initialized. An event
+  // stamped after the current time (e.g., synthetic) has no age
+  const auto now{SDL_GetTicks()};
+  const auto timestamp{event.common.timestamp};
+  const auto age{timestamp < now ? now - timestamp : 0};
+  m_inputTimes.push_back(clock::now() - std::chrono::milliseconds(age));
+}
+
+/**
+ * @brief Marks the submission of the frame, before the buffers are swapped.
+ */
+void abcg::LatencyMeter::submit() {
+  if (!m_enabled || m_inputTimes.empty()) return;
+  m_submitTime = clock::now();
+}
+
+/**
+ * @brief Marks the return of SDL_GL_SwapWindow and records the latencies of
+ * the input events consumed by the frame.
+ *
+ * When fence sync is enabled, waits for the GPU to finish the frame.
+ *
+ * @throw abcg::Exception if waiting on the fence failed.
+ */
+void abcg::LatencyMeter::present() {
+  if (!m_enabled || m_inputTimes.empty()) return;
+
+  const auto presentTime{clock::now()};
+  auto completeTime{presentTime};
+#if !defined(__EMSCRIPTEN__)
+  if (m_fenceSync) {
+    auto *fence{glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)};
+    while (true) {
+      const auto result{
+          glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000)};
+      if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+        break;
+      }
+      if (result == GL_WAIT_FAILED) {
+        glDeleteSync(fence);
+        throw abcg::Exception{
+            abcg::Exception::Runtime("Failed to wait on latency fence")};
+      }
+    }
+    glDeleteSync(fence);
+    completeTime = clock::now();
+  }
+#endif
+
+  const auto milliseconds{[](clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }};
+  for (const auto &inputTime : m_inputTimes) {
+    m_submitLatencies.push_back(milliseconds(m_submitTime - inputTime));
+    m_presentLatencies.push_back(milliseconds(presentTime - inputTime));
+    if (m_fenceSync) {
+      m_completeLatencies.push_back(milliseconds(completeTime - inputTime));
+    }
+  }
+  m_inputTimes.clear();
+}
+
+/**
+ * @brief Returns the percentiles of the latencies recorded so far.
+ *
+ * @return Number of events and percentiles of their latencies in
+ * milliseconds. The complete latencies are zero unless fence sync is
+ * enabled.
+ */
+abcg::LatencyMeter::Report abcg::LatencyMeter::getReport() const {
+  return {.numSamples = m_presentLatencies.size(),
+          .submit = getPercentiles(m_submitLatencies),
+          .present = getPercentiles(m_presentLatencies),
+          .complete = getPercentiles(m_completeLatencies)};
+}
@@ -0,0 +1,85 @@
+/**
+ * @file abcg_latencymeter.hpp
+ * @brief abcg::LatencyMeter header file.
+ *
+ * Declaration of abcg::LatencyMeter class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_LATENCYMETER_HPP_
+#define ABCG_LATENCYMETER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class LatencyMeter;
+}  // namespace abcg
+
+/**
+ * @brief abcg::LatencyMeter class.
+ *
+ * Measures the latency from input events to the frames that show their
+ * effect. The time of an event is taken from its SDL timestamp, which has a
+ * resolution of one millisecond. For each event, three latencies are
+ * recorded:
+ *
+ * - submit: until the frame that consumed the event was submitted, i.e.,
+ * right before the buffers were swapped;
+ * - present: until SDL_GL_SwapWindow returned;
+ * - complete: until the GPU finished the frame, measured with a fence after
+ * the swap. This is optional, as waiting on the fence prevents the CPU from
+ * running ahead of the GPU.
+ *
+ * abcg::Application measures the latency of each window when the executable
+ * is called with `--latency` (or `--latency-fence` to also measure the
+ * completion of the frames), and prints the percentiles when it exits.
+ */
+class abcg::LatencyMeter {
+ public:
+  struct Percentiles {
+    double p50{};
+    double p95{};
+    double p99{};
+  };
+
+  struct Report {
+    std::size_t numSamples{};
+    Percentiles submit;
+    Percentiles present;
+    Percentiles complete;
+  };
+
+  void setEnabled(bool enabled, bool fenceSync = false) noexcept;
+  [[nodiscard]] bool isEnabled() const noexcept { return m_enabled; }
+  [[nodiscard]] bool isFenceSyncEnabled() const noexcept {
+    return m_fenceSync;
+  }
+
+  void addInput(const SDL_Event& event);
+  void submit();
+  void present();
+
+  [[nodiscard]] Report getReport() const;
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  bool m_enabled{};
+  bool m_fenceSync{};
+
+  // Times of the input events consumed by the frame being painted
+  std::vector<clock::time_point> m_inputTimes;
+  clock::time_point m_submitTime{};
+
+  // Latencies in milliseconds
+  std::vector<double> m_submitLatencies;
+  std::vector<double> m_presentLatencies;
+  std::vector<double> m_completeLatencies;
+};
+
+#endif
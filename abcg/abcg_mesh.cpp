@@ -0,0 +1,540 @@
+/**
+ * @file abcg_mesh.cpp
+ * @brief Definition of mesh processing helper functions.
+ *
+ * The mesh simplification uses the quadric error metric of Garland and
+ * Heckbert (1997) with half-edge collapses, so the simplified mesh only
+ * references vertices of the original mesh.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_mesh.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cppitertools/itertools.hpp>
+#include <glm/geometric.hpp>
+#include <glm/mat2x2.hpp>
+#include <limits>
+#include <queue>
+#include <utility>
+
+#include "abcg_exception.hpp"
+#include "abcg_jobsystem.hpp"
+
+namespace {
+// Number of vertices or triangles processed by each job
+constexpr std::size_t grainSize{16384};
+
+// Symmetric 4x4 matrix stored as its upper triangle
+using Quadric = std::array<double, 10>;
+
+Quadric planeQuadric(const glm::dvec3 &normal, double d) {
+  const auto &[a, b, c]{std::array{normal.x, normal.y, normal.z}};
+  return {a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d};
+}
+
+void accumulate(Quadric &q, const Quadric &other) {
+  for (auto &&[value, otherValue] : iter::zip(q, other)) {
+    value += otherValue;
+  }
+}
+
+double evaluate(const Quadric &q, const glm::dvec3 &p) {
+  // v^T Q v with v = (x, y, z, 1)
+  return q[0] * p.x * p.x + 2 * q[1] * p.x * p.y + 2 * q[2] * p.x * p.z +
+         2 * q[3] * p.x + q[4] * p.y * p.y + 2 * q[5] * p.y * p.z +
+         2 * q[6] * p.y + q[7] * p.z * p.z + 2 * q[8] * p.z + q[9];
+}
+
+struct Collapse {
+  double cost{};
+  GLuint from{};
+  GLuint to{};
+  unsigned fromVersion{};
+  unsigned toVersion{};
+
+  bool operator>(const Collapse &other) const noexcept {
+    return cost > other.cost;
+  }
+};
+}  // namespace
+
+/**
+ * @brief Simplifies a triangle mesh with quadric error metrics.
+ *
+ * Edges are collapsed in order of increasing quadric error until the number
+ * of indices drops to @a targetIndexCount or no valid collapse remains.
+ * Collapses that would flip a triangle are rejected.
+ *
+ * @param positions Vertex positions.
+ * @param indices Triangle list indices into @a positions.
+ * @param targetIndexCount Desired number of indices of the simplified mesh.
+ *
+ * @return Triangle list indices of the simplified mesh. The indices refer to
+ * the same @a positions array.
+ */
+std::vector<GLuint> abcg::mesh::simplify(
+    const std::vector<glm::vec3> &positions, const std::vector<GLuint> &indices,
+    std::size_t targetIndexCount) {
+  const auto numVertices{positions.size()};
+  auto triangles{indices};
+  auto numTriangles{triangles.size() / 3};
+  std::vector<bool> removed(numTriangles, false);
+
+  // Vertex to triangle adjacency and per-vertex quadrics
+  std::vector<std::vector<GLuint>> adjacency(numVertices);
+  std::vector<Quadric> quadrics(numVertices, Quadric{});
+  for (const auto triangle : iter::range(numTriangles)) {
+    const auto *face{&triangles.at(triangle * 3)};
+    const glm::dvec3 a{positions.at(face[0])};
+    const glm::dvec3 b{positions.at(face[1])};
+    const glm::dvec3 c{positions.at(face[2])};
+
+    auto normal{glm::cross(b - a, c - a)};
+    const auto area{glm::length(normal)};
+    if (area > 0.0) normal /= area;
+
+    auto q{planeQuadric(normal, -glm::dot(normal, a))};
+    for (auto &value : q) value *= area;
+
+    for (const auto vertex : {face[0], face[1], face[2]}) {
+      accumulate(quadrics.at(vertex), q);
+      adjacency.at(vertex).push_back(static_cast<GLuint>(triangle));
+    }
+  }
+
+  std::vector<unsigned> versions(numVertices, 0);
+  std::vector<bool> alive(numVertices, true);
+  std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> queue;
+
+  auto pushCollapse{[&](GLuint from, GLuint to) {
+    auto q{quadrics.at(from)};
+    accumulate(q, quadrics.at(to));
+    queue.push({.cost = evaluate(q, positions.at(to)),
+                .from = from,
+                .to = to,
+                .fromVersion = versions.at(from),
+                .toVersion = versions.at(to)});
+  }};
+
+  auto pushNeighbors{[&](GLuint vertex) {
+    for (const auto triangle : adjacency.at(vertex)) {
+      if (removed.at(triangle)) continue;
+      for (const auto offset : iter::range(3U)) {
+        const auto other{triangles.at(triangle * 3 + offset)};
+        if (other == vertex) continue;
+        pushCollapse(vertex, other);
+        pushCollapse(other, vertex);
+      }
+    }
+  }};
+
+  for (const auto vertex : iter::range(numVertices)) {
+    pushNeighbors(static_cast<GLuint>(vertex));
+  }
+
+  // Checks whether moving vertex "from" to "to" flips any of the triangles
+  // that do not collapse
+  auto flipsTriangle{[&](GLuint from, GLuint to) {
+    for (const auto triangle : adjacency.at(from)) {
+      if (removed.at(triangle)) continue;
+      std::array<GLuint, 3> face{};
+      std::copy_n(&triangles.at(triangle * 3), 3, face.begin());
+      if (std::find(face.begin(), face.end(), to) != face.end()) continue;
+
+      auto faceNormal{[&] {
+        const auto &a{positions.at(face[0])};
+        return glm::cross(positions.at(face[1]) - a, positions.at(face[2]) - a);
+      }};
+      const auto oldNormal{faceNormal()};
+      std::replace(face.begin(), face.end(), from, to);
+      const auto newNormal{faceNormal()};
+      if (glm::dot(oldNormal, newNormal) <= 0.0f) return true;
+    }
+    return false;
+  }};
+
+  auto numIndices{numTriangles * 3};
+  while (numIndices > targetIndexCount && !queue.empty()) {
+    const auto collapse{queue.top()};
+    queue.pop();
+
+    const auto &[cost, from, to, fromVersion, toVersion]{collapse};
+    if (!alive.at(from) || !alive.at(to) || versions.at(from) != fromVersion ||
+        versions.at(to) != toVersion) {
+      continue;  // Stale entry
+    }
+    if (flipsTriangle(from, to)) continue;
+
+    // Collapse "from" into "to"
+    for (const auto triangle : adjacency.at(from)) {
+      if (removed.at(triangle)) continue;
+      auto *face{&triangles.at(triangle * 3)};
+      if (face[0] == to || face[1] == to || face[2] == to) {
+        removed.at(triangle) = true;
+        numIndices -= 3;
+      } else {
+        std::replace(face, face + 3, from, to);
+        adjacency.at(to).push_back(triangle);
+      }
+    }
+    accumulate(quadrics.at(to), quadrics.at(from));
+    alive.at(from) = false;
+    ++versions.at(from);
+    ++versions.at(to);
+
+    pushNeighbors(to);
+  }
+
+  std::vector<GLuint> result;
+  result.reserve(numIndices);
+  for (const auto triangle : iter::range(numTriangles)) {
+    if (removed.at(triangle)) continue;
+    const auto *face{&triangles.at(triangle * 3)};
+    result.insert(result.end(), face, face + 3);
+  }
+  return result;
+}
+
+/**
+ * @brief Builds a chain of levels of detail of a triangle mesh.
+ *
+ * Each level simplifies the previous one to half of its indices, until
+ * @a maxLODs levels are built, a level has at most @a minIndices indices, or
+ * the simplification no longer reduces the mesh. All levels share the same
+ * vertices, and their indices are appended to @a indices so that they can be
+ * stored in the same element buffer.
+ *
+ * @param positions Vertex positions.
+ * @param indices Triangle list indices into @a positions. Receives the
+ * indices of the simplified levels after the original ones.
+ * @param maxLODs Maximum number of levels, including the original mesh.
+ * @param minIndices Minimum number of indices of a simplified level.
+ *
+ * @return Range of @a indices of each level, starting with the original mesh
+ * at level 0.
+ */
+std::vector<abcg::mesh::IndexRange> abcg::mesh::buildLODChain(
+    const std::vector<glm::vec3> &positions, std::vector<GLuint> &indices,
+    std::size_t maxLODs, std::size_t minIndices) {
+  std::vector<IndexRange> lods{{0, indices.size()}};
+
+  auto previous{indices};
+  while (lods.size() < maxLODs && previous.size() > minIndices) {
+    const auto targetIndexCount{std::max(previous.size() / 2, minIndices)};
+    auto simplified{simplify(positions, previous, targetIndexCount)};
+    if (simplified.empty() || simplified.size() >= previous.size()) break;
+
+    lods.push_back({indices.size(), simplified.size()});
+    indices.insert(indices.end(), simplified.begin(), simplified.end());
+    previous = std::move(simplified);
+  }
+  return lods;
+}
+
+/**
+ * @brief Computes the projected diameter, in pixels, of a bounding sphere.
+ *
+ * Works for both perspective and orthographic projection matrices.
+ *
+ * @param projMatrix Projection matrix.
+ * @param centerEyeSpace Center of the bounding sphere in eye space.
+ * @param radius Radius of the bounding sphere in eye space units.
+ * @param viewportHeight Height of the viewport in pixels.
+ *
+ * @return Diameter in pixels. Returns the largest float value if the sphere
+ * center is at or behind the camera plane.
+ */
+float abcg::mesh::projectedDiameter(const glm::mat4 &projMatrix,
+                                    const glm::vec3 &centerEyeSpace,
+                                    float radius, int viewportHeight) {
+  // Clip-space w of the sphere center (-z for perspective, 1 for orthographic)
+  const auto w{projMatrix[2][3] * centerEyeSpace.z + projMatrix[3][3]};
+  if (w <= std::numeric_limits<float>::epsilon()) {
+    return std::numeric_limits<float>::max();
+  }
+
+  return radius * projMatrix[1][1] * static_cast<float>(viewportHeight) / w;
+}
+
+/**
+ * @brief Selects a level of detail from the projected size of an object.
+ *
+ * Level 0 is used while the object covers at least @a fullDetailDiameter
+ * pixels. Each halving of the projected size moves to the next level.
+ *
+ * @param projectedDiameter Projected diameter in pixels, as returned by
+ * abcg::mesh::projectedDiameter.
+ * @param numLODs Number of available levels.
+ * @param fullDetailDiameter Diameter in pixels from which level 0 is used.
+ *
+ * @return Level of detail in the range [0, numLODs - 1].
+ */
+std::size_t abcg::mesh::selectLOD(float projectedDiameter, std::size_t numLODs,
+                                  float fullDetailDiameter) {
+  if (numLODs <= 1 || projectedDiameter >= fullDetailDiameter) return 0;
+  if (projectedDiameter <= 0.0f) return numLODs - 1;
+
+  const auto level{
+      std::floor(std::log2(fullDetailDiameter / projectedDiameter))};
+  return std::min(static_cast<std::size_t>(level), numLODs - 1);
+}
+
+/**
+ * @brief Encodes a unit vector with the octahedral mapping.
+ *
+ * The vector is projected onto an octahedron which is then unfolded onto
+ * the square [-1, 1]^2. Each component of the result can be stored as a
+ * normalized integer (e.g., two snorm16 values for 32 bits per vector).
+ *
+ * @param direction Unit vector to encode.
+ *
+ * @return Encoded vector in the range [-1, 1]^2.
+ */
+glm::vec2 abcg::mesh::octahedralEncode(const glm::vec3 &direction) {
+  const auto l1Norm{std::abs(direction.x) + std::abs(direction.y) +
+                    std::abs(direction.z)};
+  if (l1Norm <= 0.0f) return glm::vec2{0.0f};
+
+  const glm::vec2 projected{glm::vec2{direction} / l1Norm};
+  if (direction.z >= 0.0f) return projected;
+
+  // Fold the lower hemisphere over the diagonals
+  auto signNotZero{[](float value) { return value >= 0.0f ? 1.0f : -1.0f; }};
+  return {(1.0f - std::abs(projected.y)) * signNotZero(projected.x),
+          (1.0f - std::abs(projected.x)) * signNotZero(projected.y)};
+}
+
+/**
+ * @brief Decodes a unit vector encoded with abcg::mesh::octahedralEncode.
+ *
+ * @param encoded Encoded vector in the range [-1, 1]^2.
+ *
+ * @return Normalized decoded vector.
+ */
+glm::vec3 abcg::mesh::octahedralDecode(const glm::vec2 &encoded) {
+  glm::vec3 direction{encoded,
+                      1.0f - std::abs(encoded.x) - std::abs(encoded.y)};
+  const auto fold{std::max(-direction.z, 0.0f)};
+  direction.x += direction.x >= 0.0f ? -fold : fold;
+  direction.y += direction.y >= 0.0f ? -fold : fold;
+  return glm::normalize(direction);
+}
+
+/**
+ * @brief Builds the list of triangles incident to each vertex.
+ *
+ * The triangles are split into at most one range per thread of
+ * abcg::JobSystem::global. Each job counts the references to each vertex in
+ * its own range. The counts of the ranges are then turned into the position
+ * of each range in the list of each vertex, and each job writes the
+ * triangles of its range at these positions. Thus no synchronization is
+ * needed, each index is read twice in total, and the lists are filled in
+ * increasing triangle order.
+ *
+ * @param numVertices Number of vertices.
+ * @param indices Indices of the triangles, three per triangle.
+ *
+ * @throw abcg::Exception if an index is out of range.
+ *
+ * @return Triangles of each vertex.
+ */
+abcg::mesh::VertexFaces abcg::mesh::buildVertexFaces(
+    std::size_t numVertices, const std::vector<GLuint> &indices) {
+  auto &jobSystem{abcg::JobSystem::global()};
+  const auto numFaces{indices.size() / 3};
+  const auto numJobs{jobSystem.getNumWorkers() + 1};
+  const auto rangeSize{std::max((numFaces + numJobs - 1) / numJobs, grainSize)};
+  const auto numRanges{(numFaces + rangeSize - 1) / rangeSize};
+
+  VertexFaces vertexFaces;
+  auto &offsets{vertexFaces.offsets};
+  offsets.assign(numVertices + 1, 0);
+
+  // Number of references to each vertex in each range of triangles
+  std::vector<GLuint> counts(numRanges * numVertices);
+  jobSystem.parallelFor(
+      numFaces, rangeSize, [&](std::size_t first, std::size_t last) {
+        auto *rangeCounts{counts.data() + first / rangeSize * numVertices};
+        for (auto corner{first * 3}; corner < last * 3; ++corner) {
+          const auto vertex{indices[corner]};
+          if (vertex >= numVertices) {
+            throw abcg::Exception{abcg::Exception::Runtime(
+                fmt::format("Vertex index {} out of range", vertex))};
+          }
+          ++rangeCounts[vertex];
+        }
+      });
+
+  // Position of each range in the list of each vertex, and number of
+  // triangles of each vertex, stored after its offset
+  jobSystem.parallelFor(
+      numVertices, grainSize, [&](std::size_t first, std::size_t last) {
+        for (auto vertex{first}; vertex < last; ++vertex) {
+          GLuint count{};
+          for (std::size_t range{}; range < numRanges; ++range) {
+            count += std::exchange(counts[range * numVertices + vertex], count);
+          }
+          offsets[vertex + 1] = count;
+        }
+      });
+  for (std::size_t vertex{}; vertex < numVertices; ++vertex) {
+    offsets[vertex + 1] += offsets[vertex];
+  }
+
+  vertexFaces.faces.resize(numFaces * 3);
+  jobSystem.parallelFor(
+      numFaces, rangeSize, [&](std::size_t first, std::size_t last) {
+        auto *cursors{counts.data() + first / rangeSize * numVertices};
+        for (auto corner{first * 3}; corner < last * 3; ++corner) {
+          const auto vertex{indices[corner]};
+          vertexFaces.faces[offsets[vertex] + cursors[vertex]++] =
+              static_cast<GLuint>(corner / 3);
+        }
+      });
+
+  return vertexFaces;
+}
+
+/**
+ * @brief Computes smooth vertex normals.
+ *
+ * The normal of each vertex is the normalized sum of the (area-weighted)
+ * normals of its triangles. Triangle normals are computed in parallel, and
+ * each vertex then gathers the normals of its triangles, so no two threads
+ * write to the same vertex. As the normals are summed in triangle order, the
+ * result is the same as that of a serial scatter-add loop over the
+ * triangles.
+ *
+ * @param positions Vertex positions.
+ * @param indices Indices of the triangles, three per triangle.
+ * @param vertexFaces Triangles of each vertex, as returned by
+ * abcg::mesh::buildVertexFaces.
+ *
+ * @return Unit normal of each vertex.
+ */
+std::vector<glm::vec3> abcg::mesh::computeNormals(
+    const std::vector<glm::vec3> &positions,
+    const std::vector<GLuint> &indices, const VertexFaces &vertexFaces) {
+  auto &jobSystem{abcg::JobSystem::global()};
+
+  const auto numFaces{indices.size() / 3};
+  std::vector<glm::vec3> faceNormals(numFaces);
+  jobSystem.parallelFor(
+      numFaces, grainSize, [&](std::size_t first, std::size_t last) {
+        for (auto face{first}; face < last; ++face) {
+          const auto &a{positions[indices[face * 3 + 0]]};
+          const auto &b{positions[indices[face * 3 + 1]]};
+          const auto &c{positions[indices[face * 3 + 2]]};
+          faceNormals[face] = glm::cross(b - a, c - b);
+        }
+      });
+
+  std::vector<glm::vec3> normals(positions.size());
+  jobSystem.parallelFor(
+      normals.size(), grainSize, [&](std::size_t first, std::size_t last) {
+        for (auto vertex{first}; vertex < last; ++vertex) {
+          glm::vec3 normal{};
+          for (auto k{vertexFaces.offsets[vertex]};
+               k < vertexFaces.offsets[vertex + 1]; ++k) {
+            normal += faceNormals[vertexFaces.faces[k]];
+          }
+          normals[vertex] = glm::normalize(normal);
+        }
+      });
+
+  return normals;
+}
+
+/**
+ * @brief Computes vertex tangents for normal mapping.
+ *
+ * Triangle tangents and bitangents are computed in parallel from the texture
+ * coordinates and gathered by each vertex, as in abcg::mesh::computeNormals.
+ * The summed tangent is then orthogonalized with respect to the vertex
+ * normal.
+ *
+ * @param positions Vertex positions.
+ * @param normals Unit vertex normals.
+ * @param texCoords Vertex texture coordinates.
+ * @param indices Indices of the triangles, three per triangle.
+ * @param vertexFaces Triangles of each vertex, as returned by
+ * abcg::mesh::buildVertexFaces.
+ *
+ * @return Unit tangent of each vertex. The w component is the handedness
+ * (1 or -1) of the tangent space.
+ */
+std::vector<glm::vec4> abcg::mesh::computeTangents(
+    const std::vector<glm::vec3> &positions,
+    const std::vector<glm::vec3> &normals,
+    const std::vector<glm::vec2> &texCoords,
+    const std::vector<GLuint> &indices, const VertexFaces &vertexFaces) {
+  auto &jobSystem{abcg::JobSystem::global()};
+
+  const auto numFaces{indices.size() / 3};
+  // Tangent and bitangent of each triangle, interleaved for the gather
+  std::vector<std::array<glm::vec3, 2>> faceBases(numFaces);
+  jobSystem.parallelFor(
+      numFaces, grainSize, [&](std::size_t first, std::size_t last) {
+        for (auto face{first}; face < last; ++face) {
+          const auto i1{indices[face * 3 + 0]};
+          const auto i2{indices[face * 3 + 1]};
+          const auto i3{indices[face * 3 + 2]};
+
+          const auto e1{positions[i2] - positions[i1]};
+          const auto e2{positions[i3] - positions[i1]};
+          const auto delta1{texCoords[i2] - texCoords[i1]};
+          const auto delta2{texCoords[i3] - texCoords[i1]};
+
+          // clang-format off
+          glm::mat2 M;
+          M[0][0] =  delta2.t;
+          M[0][1] = -delta1.t;
+          M[1][0] = -delta2.s;
+          M[1][1] =  delta1.s;
+          M *= (1.0f / (delta1.s * delta2.t - delta2.s * delta1.t));
+
+          faceBases[face][0] = {M[0][0] * e1.x + M[0][1] * e2.x,
+                                M[0][0] * e1.y + M[0][1] * e2.y,
+                                M[0][0] * e1.z + M[0][1] * e2.z};
+
+          faceBases[face][1] = {M[1][0] * e1.x + M[1][1] * e2.x,
+                                M[1][0] * e1.y + M[1][1] * e2.y,
+                                M[1][0] * e1.z + M[1][1] * e2.z};
+          // clang-format on
+        }
+      });
+
+  std::vector<glm::vec4> tangents(positions.size());
+  jobSystem.parallelFor(
+      tangents.size(), grainSize, [&](std::size_t first, std::size_t last) {
+        for (auto vertex{first}; vertex < last; ++vertex) {
+          glm::vec3 t{};
+          glm::vec3 bitangent{};
+          for (auto k{vertexFaces.offsets[vertex]};
+               k < vertexFaces.offsets[vertex + 1]; ++k) {
+            const auto &basis{faceBases[vertexFaces.faces[k]]};
+            t += basis[0];
+            bitangent += basis[1];
+          }
+
+          // Orthogonalize t with respect to n
+          const auto &n{normals[vertex]};
+          const auto tangent{t - n * glm::dot(n, t)};
+
+          // Compute handedness of re-orthogonalized basis
+          const auto b{glm::cross(n, t)};
+          const auto handedness{glm::dot(b, bitangent)};
+          tangents[vertex] = glm::vec4(glm::normalize(tangent),
+                                       handedness < 0.0f ? -1.0f : 1.0f);
+        }
+      });
+
+  return tangents;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file abcg_mesh.hpp
+ * @brief Declaration of mesh processing helper functions.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_MESH_HPP_
+#define ABCG_MESH_HPP_
+
+#include <abcg_external.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+namespace abcg::mesh {
+struct IndexRange;
+struct VertexFaces;
+
+[[nodiscard]] VertexFaces buildVertexFaces(std::size_t numVertices,
+                                           const std::vector<GLuint>& indices);
+[[nodiscard]] std::vector<glm::vec3> computeNormals(
+    const std::vector<glm::vec3>& positions, const std::vector<GLuint>& indices,
+    const VertexFaces& vertexFaces);
+[[nodiscard]] std::vector<glm::vec4> computeTangents(
+    const std::vector<glm::vec3>& positions,
+    const std::vector<glm::vec3>& normals,
+    const std::vector<glm::vec2>& texCoords, const std::vector<GLuint>& indices,
+    const VertexFaces& vertexFaces);
+[[nodiscard]] std::vector<GLuint> simplify(
+    const std::vector<glm::vec3>& positions, const std::vector<GLuint>& indices,
+    std::size_t targetIndexCount);
+[[nodiscard]] std::vector<IndexRange> buildLODChain(
+    const std::vector<glm::vec3>& positions, std::vector<GLuint>& indices,
+    std::size_t maxLODs = 8, std::size_t minIndices = 12);
+[[nodiscard]] float projectedDiameter(const glm::mat4& projMatrix,
+                                      const glm::vec3& centerEyeSpace,
+                                      float radius, int viewportHeight);
+[[nodiscard]] std::size_t selectLOD(float projectedDiameter,
+                                    std::size_t numLODs,
+                                    float fullDetailDiameter = 256.0f);
+[[nodiscard]] glm::vec2 octahedralEncode(const glm::vec3& direction);
+[[nodiscard]] glm::vec3 octahedralDecode(const glm::vec2& encoded);
+}  // namespace abcg::mesh
+
+/**
+ * @brief Range of an index array, e.g., of a level of detail.
+ */
+struct abcg::mesh::IndexRange {
+  std::size_t firstIndex{};
+  std::size_t numIndices{};
+};
+
+/**
+ * @brief Triangles incident to each vertex of an indexed triangle mesh.
+ *
+ * Compressed sparse row format: the triangles of vertex `v` are
+ * `faces[offsets[v]]` to `faces[offsets[v + 1] - 1]`, in increasing order.
+ * A triangle that references a vertex more than once is listed once per
+ * reference.
+ */
+struct abcg::mesh::VertexFaces {
+  std::vector<GLuint> offsets;
+  std::vector<GLuint> faces;
+};
+
+#endif
@@ -0,0 +1,556 @@
+/**
+ * @file abcg_objfile.cpp
+ * @brief Definition of abcg::ObjFile class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_objfile.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <set>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "abcg_exception.hpp"
+#include "abcg_jobsystem.hpp"
+#include "abcg_trace.hpp"
+
+namespace {
+// Read-only view of a whole file mapped into memory
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string &path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile(MappedFile &&) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile &operator=(MappedFile &&) = delete;
+
+  [[nodiscard]] const char *begin() const noexcept { return m_data; }
+  [[nodiscard]] const char *end() const noexcept { return m_data + m_size; }
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+ private:
+  const char *m_data{};
+  std::size_t m_size{};
+#if defined(_WIN32)
+  HANDLE m_mapping{};
+#endif
+};
+
+MappedFile::MappedFile(const std::string &path) {
+  auto mapped{false};
+#if defined(_WIN32)
+  const auto file{CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                              nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr)};
+  if (file != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER size{};
+    if (GetFileSizeEx(file, &size) != 0) {
+      m_size = static_cast<std::size_t>(size.QuadPart);
+      mapped = m_size == 0;
+      if (m_size > 0) {
+        m_mapping =
+            CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (m_mapping != nullptr) {
+          m_data = static_cast<const char *>(
+              MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+          mapped = m_data != nullptr;
+          if (!mapped) CloseHandle(m_mapping);
+        }
+      }
+    }
+    // The mapping keeps the file open
+    CloseHandle(file);
+  }
+#else
+  const auto fd{open(path.c_str(), O_RDONLY)};
+  if (fd >= 0) {
+    struct stat status {};
+    if (fstat(fd, &status) == 0) {
+      m_size = static_cast<std::size_t>(status.st_size);
+      mapped = m_size == 0;
+      if (m_size > 0) {
+        auto *data{mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0)};
+        if (data != MAP_FAILED) {
+#if !defined(__EMSCRIPTEN__)
+          posix_madvise(data, m_size, POSIX_MADV_WILLNEED);
+#endif
+          m_data = static_cast<const char *>(data);
+          mapped = true;
+        }
+      }
+    }
+    // The mapping keeps the file open
+    close(fd);
+  }
+#endif
+
+  if (!mapped) {
+    throw abcg::Exception{
+        abcg::Exception::Runtime(fmt::format("Failed to open file {}", path))};
+  }
+}
+
+MappedFile::~MappedFile() {
+  if (m_data == nullptr) return;
+#if defined(_WIN32)
+  UnmapViewOfFile(m_data);
+  CloseHandle(m_mapping);
+#else
+  munmap(const_cast<char *>(m_data), m_size);
+#endif
+}
+
+// Number of elements of a chunk of lines, and state at the end of the chunk
+struct Chunk {
+  const char *begin{};
+  const char *end{};
+
+  std::size_t numLines{};
+  std::size_t numPositions{};
+  std::size_t numNormals{};
+  std::size_t numTexCoords{};
+  std::size_t numTriangles{};
+
+  std::vector<std::string> mtlFiles;
+  std::optional<std::string> lastMaterial;
+  std::set<std::string, std::less<>> unknownMaterials;
+};
+
+[[nodiscard]] bool isBlank(char c) noexcept {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Reads the tokens of a line, which are separated by blanks
+class LineReader {
+ public:
+  LineReader(const char *begin, const char *end) : m_p{begin}, m_end{end} {}
+
+  // Returns the next token, or an empty string at the end of the line
+  std::string_view next() noexcept {
+    skipBlanks();
+    const auto *first{m_p};
+    while (m_p < m_end && !isBlank(*m_p)) ++m_p;
+    return {first, static_cast<std::size_t>(m_p - first)};
+  }
+
+  // Returns the rest of the line without leading and trailing blanks
+  std::string_view rest() noexcept {
+    skipBlanks();
+    auto last{m_end};
+    while (last > m_p && isBlank(*(last - 1))) --last;
+    return {m_p, static_cast<std::size_t>(last - m_p)};
+  }
+
+  [[nodiscard]] bool atEnd() noexcept {
+    skipBlanks();
+    return m_p == m_end;
+  }
+
+  [[nodiscard]] bool atTokenEnd() const noexcept {
+    return m_p == m_end || isBlank(*m_p);
+  }
+
+  // Skips a character if it is the next one
+  bool skip(char c) noexcept {
+    if (m_p == m_end || *m_p != c) return false;
+    ++m_p;
+    return true;
+  }
+
+  bool readFloat(float &value);
+  bool readIndex(std::int64_t &value);
+
+ private:
+  const char *m_p;
+  const char *m_end;
+
+  void skipBlanks() noexcept {
+    while (m_p < m_end && isBlank(*m_p)) ++m_p;
+  }
+};
+
+// Reads a token with a decimal floating-point number. Numbers with at most 19
+// significant digits and a decimal exponent in [-22, 22] are converted with a
+// single multiplication or division of doubles, which is exact before the
+// final rounding to float. Other numbers fall back to std::strtod
+bool LineReader::readFloat(float &value) {
+  static constexpr std::array<double, 23> powersOf10{
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  skipBlanks();
+  const auto *p{m_p};
+
+  auto negative{false};
+  if (p < m_end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+
+  std::uint64_t mantissa{};
+  int numDigits{};
+  int exponent{};
+  auto truncated{false};
+  auto hasDigits{false};
+  const auto addDigit{[&](char c) {
+    if (numDigits == 19) {
+      truncated = truncated || c != '0';
+      return false;
+    }
+    mantissa = mantissa * 10 + static_cast<std::uint64_t>(c - '0');
+    if (mantissa != 0) ++numDigits;
+    return true;
+  }};
+
+  for (; p < m_end && *p >= '0' && *p <= '9'; ++p) {
+    hasDigits = true;
+    if (!addDigit(*p)) ++exponent;
+  }
+  if (p < m_end && *p == '.') {
+    for (++p; p < m_end && *p >= '0' && *p <= '9'; ++p) {
+      hasDigits = true;
+      if (addDigit(*p)) --exponent;
+    }
+  }
+  if (hasDigits && p < m_end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    auto negativeExponent{false};
+    if (p < m_end && (*p == '-' || *p == '+')) {
+      negativeExponent = *p == '-';
+      ++p;
+    }
+    int explicitExponent{};
+    auto hasExponentDigits{false};
+    for (; p < m_end && *p >= '0' && *p <= '9'; ++p) {
+      hasExponentDigits = true;
+      explicitExponent = std::min(explicitExponent * 10 + (*p - '0'), 10000);
+    }
+    hasDigits = hasExponentDigits;
+    exponent += negativeExponent ? -explicitExponent : explicitExponent;
+  }
+
+  if (hasDigits && (p == m_end || isBlank(*p)) && !truncated &&
+      mantissa <= (std::uint64_t{1} << 53) && exponent >= -22 &&
+      exponent <= 22) {
+    auto result{static_cast<double>(mantissa)};
+    result = exponent < 0
+                 ? result / powersOf10[static_cast<std::size_t>(-exponent)]
+                 : result * powersOf10[static_cast<std::size_t>(exponent)];
+    value = static_cast<float>(negative ? -result : result);
+    m_p = p;
+    return true;
+  }
+
+  // Slow path for long numbers, large exponents, inf and nan
+  const auto token{next()};
+  std::array<char, 64> buffer{};
+  if (token.empty() || token.size() >= buffer.size()) return false;
+  std::memcpy(buffer.data(), token.data(), token.size());
+  char *parsedEnd{};
+  const auto result{std::strtod(buffer.data(), &parsedEnd)};
+  if (parsedEnd != buffer.data() + token.size()) return false;
+  value = static_cast<float>(result);
+  return true;
+}
+
+// Reads an integer, which may be followed by other characters of the token
+bool LineReader::readIndex(std::int64_t &value) {
+  const auto negative{skip('-')};
+
+  const auto *first{m_p};
+  std::int64_t result{};
+  for (; m_p < m_end && *m_p >= '0' && *m_p <= '9'; ++m_p) {
+    result = std::min<std::int64_t>(result * 10 + (*m_p - '0'),
+                                    std::int64_t{1} << 40);
+  }
+  if (m_p == first) return false;
+
+  value = negative ? -result : result;
+  return true;
+}
+
+// Calls function(reader, keyword) for each line of a range of text
+template <typename TFun>
+void forEachLine(const char *begin, const char *end, TFun &&function) {
+  for (const auto *p{begin}; p < end;) {
+    const auto *lineEnd{static_cast<const char *>(
+        std::memchr(p, '\n', static_cast<std::size_t>(end - p)))};
+    if (lineEnd == nullptr) lineEnd = end;
+
+    LineReader reader{p, lineEnd};
+    const auto keyword{reader.next()};
+    function(reader, keyword);
+    p = lineEnd + 1;
+  }
+}
+
+// Converts a 1-based or negative (relative) OBJ index to a 0-based index.
+// Returns -1 if the index is out of range
+[[nodiscard]] GLint resolveIndex(std::int64_t index, std::size_t numDefined,
+                                 std::size_t numTotal) {
+  const auto resolved{
+      index > 0 ? index - 1 : static_cast<std::int64_t>(numDefined) + index};
+  if (index == 0 || resolved < 0 ||
+      resolved >= static_cast<std::int64_t>(numTotal)) {
+    return -1;
+  }
+  return static_cast<GLint>(resolved);
+}
+
+// Counts the elements of a chunk
+void countChunk(Chunk &chunk) {
+  forEachLine(chunk.begin, chunk.end,
+              [&chunk](LineReader &reader, std::string_view keyword) {
+                ++chunk.numLines;
+                if (keyword == "v") {
+                  ++chunk.numPositions;
+                } else if (keyword == "vn") {
+                  ++chunk.numNormals;
+                } else if (keyword == "vt") {
+                  ++chunk.numTexCoords;
+                } else if (keyword == "f") {
+                  std::size_t numCorners{};
+                  while (!reader.next().empty()) ++numCorners;
+                  chunk.numTriangles += numCorners > 2 ? numCorners - 2 : 0;
+                } else if (keyword == "usemtl") {
+                  chunk.lastMaterial = reader.rest();
+                } else if (keyword == "mtllib") {
+                  for (auto file{reader.next()}; !file.empty();
+                       file = reader.next()) {
+                    chunk.mtlFiles.emplace_back(file);
+                  }
+                }
+              });
+}
+}  // namespace
+
+/**
+ * @brief Loads an OBJ file.
+ *
+ * @param path Path to the OBJ file.
+ * @param mtlSearchPath Directory of the MTL files. If empty, the directory of
+ * the OBJ file is used.
+ *
+ * @throw abcg::Exception if the file cannot be opened or has invalid
+ * vertices, faces or indices.
+ *
+ * Missing MTL files and unknown materials are reported by
+ * abcg::ObjFile::getWarning.
+ */
+void abcg::ObjFile::load(std::string_view path,
+                         std::string_view mtlSearchPath) {
+  ABCG_TRACE_SCOPE("ObjFile::load");
+  const std::string pathString{path};
+  const MappedFile file{pathString};
+  auto &jobSystem{abcg::JobSystem::global()};
+
+  // Split the file into chunks of whole lines. Small files are parsed as a
+  // single chunk
+  constexpr std::size_t minChunkSize{1 << 20};
+  const auto numChunks{std::clamp<std::size_t>(
+      file.size() / minChunkSize, 1, (jobSystem.getNumWorkers() + 1) * 4)};
+  std::vector<Chunk> chunks(numChunks);
+  for (std::size_t index{}; index < numChunks; ++index) {
+    auto &chunk{chunks[index]};
+    chunk.begin = index == 0 ? file.begin() : chunks[index - 1].end;
+    chunk.end = file.begin() + file.size() * (index + 1) / numChunks;
+    if (index + 1 == numChunks) {
+      chunk.end = file.end();
+    } else {
+      chunk.end = std::max(chunk.begin, chunk.end);
+      const auto *newline{static_cast<const char *>(std::memchr(
+          chunk.end, '\n', static_cast<std::size_t>(file.end() - chunk.end)))};
+      chunk.end = newline == nullptr ? file.end() : newline + 1;
+    }
+  }
+
+  // First pass: count the elements of each chunk
+  jobSystem.parallelFor(numChunks, 1, [&](std::size_t first, std::size_t last) {
+    for (auto index{first}; index < last; ++index) {
+      countChunk(chunks[index]);
+    }
+  });
+
+  // Load the materials
+  m_materials.clear();
+  m_warning.clear();
+  std::map<std::string, int> materialMap;
+  const auto mtlDirectory{mtlSearchPath.empty()
+                              ? std::filesystem::path{pathString}.parent_path()
+                              : std::filesystem::path{mtlSearchPath}};
+  std::vector<std::string> loadedMtlFiles;
+  for (const auto &chunk : chunks) {
+    for (const auto &mtlFile : chunk.mtlFiles) {
+      if (std::find(loadedMtlFiles.begin(), loadedMtlFiles.end(), mtlFile) !=
+          loadedMtlFiles.end()) {
+        continue;
+      }
+      loadedMtlFiles.push_back(mtlFile);
+
+      std::ifstream stream{mtlDirectory / mtlFile};
+      if (!stream) {
+        m_warning += fmt::format("Material file {} not found\n", mtlFile);
+        continue;
+      }
+      std::string error;
+      tinyobj::LoadMtl(&materialMap, &m_materials, &stream, &m_warning,
+                       &error);
+      m_warning += error;
+    }
+  }
+
+  // Offsets of each chunk in the final arrays, and material at its start
+  struct Offsets {
+    std::size_t line{};
+    std::size_t position{};
+    std::size_t normal{};
+    std::size_t texCoord{};
+    std::size_t triangle{};
+    GLint materialID{-1};
+  };
+  std::vector<Offsets> offsets(numChunks + 1);
+  for (std::size_t index{}; index < numChunks; ++index) {
+    const auto &chunk{chunks[index]};
+    const auto &current{offsets[index]};
+    auto &next{offsets[index + 1]};
+    next.line = current.line + chunk.numLines;
+    next.position = current.position + chunk.numPositions;
+    next.normal = current.normal + chunk.numNormals;
+    next.texCoord = current.texCoord + chunk.numTexCoords;
+    next.triangle = current.triangle + chunk.numTriangles;
+    next.materialID = current.materialID;
+    if (chunk.lastMaterial) {
+      const auto material{materialMap.find(*chunk.lastMaterial)};
+      next.materialID = material == materialMap.end() ? -1 : material->second;
+    }
+  }
+
+  const auto &totals{offsets.back()};
+  m_positions.resize(totals.position);
+  m_normals.resize(totals.normal);
+  m_texCoords.resize(totals.texCoord);
+  m_corners.resize(totals.triangle * 3);
+  m_materialIDs.resize(totals.triangle);
+
+  // Second pass: parse each chunk into its part of the arrays
+  const auto parseChunk{[&](std::size_t index) {
+    auto &chunk{chunks[index]};
+    auto counts{offsets[index]};
+    const auto fail{[&](std::string_view message) {
+      throw abcg::Exception{abcg::Exception::Runtime(
+          fmt::format("Failed to load model {} (line {}: {})", path,
+                      counts.line, message))};
+    }};
+
+    forEachLine(chunk.begin, chunk.end, [&](LineReader &reader,
+                                            std::string_view keyword) {
+      ++counts.line;
+      if (keyword == "v" || keyword == "vn") {
+        glm::vec3 vector{};
+        for (auto *component : {&vector.x, &vector.y, &vector.z}) {
+          if (!reader.readFloat(*component)) fail("invalid vertex");
+        }
+        if (keyword == "v") {
+          m_positions[counts.position++] = vector;
+        } else {
+          m_normals[counts.normal++] = vector;
+        }
+      } else if (keyword == "vt") {
+        glm::vec2 texCoord{};
+        if (!reader.readFloat(texCoord.x) ||
+            (!reader.atEnd() && !reader.readFloat(texCoord.y))) {
+          fail("invalid texture coordinates");
+        }
+        m_texCoords[counts.texCoord++] = texCoord;
+      } else if (keyword == "f") {
+        // Triangle fan of the polygon
+        Corner firstCorner;
+        Corner previousCorner;
+        std::size_t numCorners{};
+        for (; !reader.atEnd(); ++numCorners) {
+          // v, v/vt, v//vn or v/vt/vn
+          Corner corner;
+          std::int64_t objIndex{};
+          if (!reader.readIndex(objIndex)) fail("invalid face");
+          corner.position =
+              resolveIndex(objIndex, counts.position, totals.position);
+          if (corner.position < 0) fail("vertex index out of range");
+          if (reader.skip('/')) {
+            // Texture coordinates, unless the corner is v//vn
+            auto hasNormal{reader.skip('/')};
+            if (!hasNormal) {
+              if (!reader.readIndex(objIndex)) fail("invalid face");
+              corner.texCoord =
+                  resolveIndex(objIndex, counts.texCoord, totals.texCoord);
+              if (corner.texCoord < 0) fail("texture index out of range");
+              hasNormal = reader.skip('/');
+            }
+            if (hasNormal) {
+              if (!reader.readIndex(objIndex)) fail("invalid face");
+              corner.normal =
+                  resolveIndex(objIndex, counts.normal, totals.normal);
+              if (corner.normal < 0) fail("normal index out of range");
+            }
+          }
+          if (!reader.atTokenEnd()) fail("invalid face");
+
+          if (numCorners == 0) {
+            firstCorner = corner;
+          } else if (numCorners >= 2) {
+            m_corners[counts.triangle * 3 + 0] = firstCorner;
+            m_corners[counts.triangle * 3 + 1] = previousCorner;
+            m_corners[counts.triangle * 3 + 2] = corner;
+            m_materialIDs[counts.triangle] = counts.materialID;
+            ++counts.triangle;
+          }
+          previousCorner = corner;
+        }
+        if (numCorners < 3) fail("face with less than three vertices");
+      } else if (keyword == "usemtl") {
+        const auto name{reader.rest()};
+        const auto material{materialMap.find(std::string{name})};
+        counts.materialID =
+            material == materialMap.end() ? -1 : material->second;
+        if (material == materialMap.end()) {
+          chunk.unknownMaterials.emplace(name);
+        }
+      }
+    });
+  }};
+  jobSystem.parallelFor(numChunks, 1, [&](std::size_t first, std::size_t last) {
+    for (auto index{first}; index < last; ++index) {
+      parseChunk(index);
+    }
+  });
+
+  std::set<std::string, std::less<>> unknownMaterials;
+  for (auto &chunk : chunks) {
+    unknownMaterials.merge(chunk.unknownMaterials);
+  }
+  for (const auto &name : unknownMaterials) {
+    m_warning += fmt::format("Material {} not found\n", name);
+  }
+}
@@ -0,0 +1,95 @@
+/**
+ * @file abcg_objfile.hpp
+ * @brief abcg::ObjFile header file.
+ *
+ * Declaration of abcg::ObjFile class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_OBJFILE_HPP_
+#define ABCG_OBJFILE_HPP_
+
+#include <tiny_obj_loader.h>
+
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class ObjFile;
+}  // namespace abcg
+
+/**
+ * @brief abcg::ObjFile class.
+ *
+ * Parser of Wavefront OBJ files with triangulated faces, as an alternative to
+ * tinyobj::ObjReader for large models.
+ *
+ * The file is mapped into memory and split into chunks of whole lines. A
+ * first pass counts the elements of each chunk, so that all arrays are
+ * allocated once, and a second pass parses the chunks in parallel on
+ * abcg::JobSystem::global directly into their final positions. Materials
+ * are loaded from the MTL files with tinyobj::LoadMtl.
+ *
+ * Only vertices (`v`, `vt`, `vn`), faces (`f`) and materials (`mtllib`,
+ * `usemtl`) are read. Polygons are triangulated as fans. Groups, objects,
+ * smoothing groups and lines are ignored.
+ */
+class abcg::ObjFile {
+ public:
+  /**
+   * @brief Indices of the attributes of a face corner.
+   *
+   * Indices start at 0. Attributes not given by the face are -1.
+   */
+  struct Corner {
+    GLint position{-1};
+    GLint texCoord{-1};
+    GLint normal{-1};
+  };
+
+  void load(std::string_view path, std::string_view mtlSearchPath = {});
+
+  [[nodiscard]] const std::vector<glm::vec3>& getPositions() const noexcept {
+    return m_positions;
+  }
+  [[nodiscard]] const std::vector<glm::vec3>& getNormals() const noexcept {
+    return m_normals;
+  }
+  [[nodiscard]] const std::vector<glm::vec2>& getTexCoords() const noexcept {
+    return m_texCoords;
+  }
+  [[nodiscard]] const std::vector<Corner>& getCorners() const noexcept {
+    return m_corners;
+  }
+  [[nodiscard]] const std::vector<GLint>& getMaterialIDs() const noexcept {
+    return m_materialIDs;
+  }
+  [[nodiscard]] const std::vector<tinyobj::material_t>& getMaterials()
+      const noexcept {
+    return m_materials;
+  }
+  [[nodiscard]] const std::string& getWarning() const noexcept {
+    return m_warning;
+  }
+
+ private:
+  std::vector<glm::vec3> m_positions;
+  std::vector<glm::vec3> m_normals;
+  std::vector<glm::vec2> m_texCoords;
+
+  // Three corners and one material per triangle. Triangles without a
+  // material have material ID -1
+  std::vector<Corner> m_corners;
+  std::vector<GLint> m_materialIDs;
+  std::vector<tinyobj::material_t> m_materials;
+
+  std::string m_warning;
+};
+
+#endif
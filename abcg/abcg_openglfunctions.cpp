@@ -7,10 +7,50 @@
 
 #include "abcg_openglfunctions.hpp"
 
+#include <fmt/core.h>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include "abcg_exception.hpp"
 #include "abcg_external.hpp"
 
 #if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+namespace {
+struct GLDebugMessage {
+  GLenum type{};
+  GLenum severity{};
+  std::string text;
+  const char *fileName{};
+  const char *functionName{};
+  std::uint_least32_t line{};
+};
+
+// Messages received since the last call to abcg::flushGLDebugOutput. The
+// callback may be called from another thread if the context is not
+// synchronous
+std::mutex debugMessagesMutex;
+std::vector<GLDebugMessage> debugMessages;
+
+void GLAPIENTRY onGLDebugMessage(GLenum /*source*/, GLenum type, GLuint /*id*/,
+                                 GLenum severity, GLsizei length,
+                                 const GLchar *message,
+                                 const void * /*userParam*/) {
+  if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) return;
+
+  const auto &site{abcg::lastGLCallSite};
+  const std::scoped_lock lock{debugMessagesMutex};
+  debugMessages.push_back(
+      {type, severity,
+       length < 0 ? std::string{message}
+                  : std::string{message, static_cast<std::size_t>(length)},
+       site.fileName.load(std::memory_order_relaxed),
+       site.functionName.load(std::memory_order_relaxed),
+       site.line.load(std::memory_order_relaxed)});
+}
+}  // namespace
+
 /**
  * @brief Checks OpenGL error status and throws on error with a log message.
  *
@@ -27,4 +67,80 @@ void abcg::checkGLError(
         abcg::Exception::OpenGL(prefix, status, sourceLocation)};
   }
 }
-#endif
\ No newline at end of file
+
+/**
+ * @brief Installs the debug output callback in the current OpenGL context.
+ *
+ * Errors are then reported asynchronously by the debug output instead of
+ * calls to glGetError before and after each OpenGL function, which
+ * synchronize the CPU with the driver. The debug output is enabled with
+ * abcg::setGLDebugOutput.
+ *
+ * @return Whether KHR_debug is supported by the context.
+ */
+bool abcg::initializeGLDebugOutput() {
+  if (!GLEW_KHR_debug) return false;
+
+  ::glDebugMessageCallback(onGLDebugMessage, nullptr);
+  // Only errors and warnings are reported
+  ::glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE,
+                          GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr,
+                          GL_FALSE);
+  return true;
+}
+
+/**
+ * @brief Selects between the debug output and glGetError for checking
+ * errors of the wrapped OpenGL functions.
+ *
+ * @param enabled Whether to use the debug output of the current context. The
+ * context must have been initialized with abcg::initializeGLDebugOutput.
+ */
+void abcg::setGLDebugOutput(bool enabled) {
+  // GL_DEBUG_OUTPUT is a state of the context, so it is set even if the
+  // mode has not changed
+  if (enabled) {
+    ::glEnable(GL_DEBUG_OUTPUT);
+  } else {
+    ::glDisable(GL_DEBUG_OUTPUT);
+    // Errors already reported by the debug output are still in the error
+    // flags, and would be reported again by abcg::checkGLError
+    if (isGLDebugOutputEnabled) {
+      while (glGetError() != GL_NO_ERROR) {
+      }
+    }
+  }
+  isGLDebugOutputEnabled = enabled;
+}
+
+/**
+ * @brief Reports the messages of the debug output received since the last
+ * call.
+ *
+ * Each message is reported with the source location of the last wrapped
+ * OpenGL function called before the message.
+ *
+ * @param throwOnError Whether to throw on the first message of type
+ * GL_DEBUG_TYPE_ERROR. Other messages are printed to the standard error.
+ *
+ * @throw abcg::Exception with a log message if throwOnError is true and an
+ * error was reported.
+ */
+void abcg::flushGLDebugOutput(bool throwOnError) {
+  std::vector<GLDebugMessage> messages;
+  {
+    const std::scoped_lock lock{debugMessagesMutex};
+    messages.swap(debugMessages);
+  }
+
+  for (const auto &message : messages) {
+    auto what{abcg::Exception::OpenGLDebug(message.text, message.fileName,
+                                           message.functionName,
+                                           message.line)};
+    if (throwOnError && message.type == GL_DEBUG_TYPE_ERROR) {
+      throw abcg::Exception{what};
+    }
+    fmt::print(stderr, "{}\n", what);
+  }
+}
+#endif
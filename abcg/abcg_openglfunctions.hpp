@@ -2,8 +2,10 @@
  * @file abcg_openglfunctions.hpp
  * @brief Declaration of OpenGL-related error checking functions.
  *
- * Error checking wrappers for OpenGL functions are defined here as inline
- * functions.
+ * Wrappers for OpenGL functions are defined here as inline functions. In
+ * debug builds, they check for errors. If abcg is built with ABCG_GL_STATS
+ * defined (CMake option ENABLE_GL_STATS), they also count the work submitted
+ * to the driver. Otherwise, they only forward the call.
  *
  * This project is released under the MIT License.
  */
@@ -12,21 +14,82 @@
 #define ABCG_OPENGLFUNCTIONS_HPP_
 
 #if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+#include <atomic>
+#include <cstdint>
 #include <experimental/source_location>
 #endif
 
+#include <cstddef>
 #include <string_view>
+#include <type_traits>
+#include <utility>
 
 #include "abcg_external.hpp"
 
 namespace abcg {
+/**
+ * @brief Counters of the work submitted through the OpenGL wrappers.
+ *
+ * Only calls made through the abcg:: wrappers are counted. Bytes written to
+ * mapped buffers are counted only for abcg::StreamBuffer.
+ */
+struct GLStats {
+  std::size_t drawCalls{};
+  std::size_t vertices{};
+  std::size_t instances{};
+  std::size_t programBinds{};
+  std::size_t vertexArrayBinds{};
+  std::size_t textureBinds{};
+  std::size_t uniformUploads{};
+  std::size_t bufferBytes{};
+};
+
+#if defined(ABCG_GL_STATS)
+inline constexpr bool isGLStatsEnabled{true};
+#else
+inline constexpr bool isGLStatsEnabled{false};
+#endif
+
+// Counters since the beginning of the current frame
+inline GLStats glStats;
+
+inline void countGL(std::size_t GLStats::*counter,
+                    std::size_t value = 1) noexcept {
+  if constexpr (isGLStatsEnabled) glStats.*counter += value;
+}
+
 #if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
 void checkGLError(const std::experimental::source_location& sourceLocation,
                   std::string_view prefix);
+bool initializeGLDebugOutput();
+void setGLDebugOutput(bool enabled);
+void flushGLDebugOutput(bool throwOnError);
+
+/**
+ * @brief Source location of the last wrapped OpenGL call.
+ *
+ * Messages of the debug output are reported with this location. The fields
+ * are atomic because the debug output may call its callback from a thread
+ * of the driver.
+ */
+struct GLCallSite {
+  std::atomic<const char*> fileName{""};
+  std::atomic<const char*> functionName{""};
+  std::atomic<std::uint_least32_t> line{};
+};
+inline GLCallSite lastGLCallSite;
+
+// Whether errors of the current context are reported by the debug output
+// instead of glGetError
+inline bool isGLDebugOutputEnabled{false};
 
 /**
  * @brief Check for OpenGL errors before and after a function call.
  *
+ * If the debug output is enabled, the call is not checked. Only its source
+ * location is recorded, and errors are reported by
+ * abcg::flushGLDebugOutput.
+ *
  * @tparam TFun Function typename.
  * @tparam TArgs Variadic arguments typename.
  * @param sourceLocation Information about the source code, used for logging.
@@ -37,6 +100,16 @@ void checkGLError(const std::experimental::source_location& sourceLocation,
 template <typename TFun, typename... TArgs>
 auto callGL(const std::experimental::source_location& sourceLocation,
             TFun&& function, TArgs&&... args) {
+  if (isGLDebugOutputEnabled) {
+    lastGLCallSite.fileName.store(sourceLocation.file_name(),
+                                  std::memory_order_relaxed);
+    lastGLCallSite.functionName.store(sourceLocation.function_name(),
+                                      std::memory_order_relaxed);
+    lastGLCallSite.line.store(sourceLocation.line(),
+                              std::memory_order_relaxed);
+    return std::forward<TFun>(function)(std::forward<TArgs>(args)...);
+  }
+
   checkGLError(sourceLocation, "BEFORE function call");
   if constexpr (!std::is_void<
                     typename std::result_of<TFun(TArgs...)>::type>::value) {
@@ -51,6 +124,23 @@ auto callGL(const std::experimental::source_location& sourceLocation,
 }
 
 using sl = std::experimental::source_location;
+#else
+/**
+ * @brief Empty replacement of std::experimental::source_location for builds
+ * without error checking.
+ */
+struct GLSourceLocation {
+  static constexpr GLSourceLocation current() noexcept { return {}; }
+};
+
+template <typename TFun, typename... TArgs>
+auto callGL(const GLSourceLocation& /*sourceLocation*/, TFun&& function,
+            TArgs&&... args) {
+  return std::forward<TFun>(function)(std::forward<TArgs>(args)...);
+}
+
+using sl = GLSourceLocation;
+#endif
 
 inline void glActiveTexture(GLenum texture,
                             const sl& sourceLocation = sl::current()) {
@@ -60,6 +150,10 @@ inline void glAttachShader(GLuint program, GLuint shader,
                            const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glAttachShader, program, shader);
 }
+inline void glBeginQuery(GLenum target, GLuint id,
+                         const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glBeginQuery, target, id);
+}
 inline void glBindBuffer(GLenum target, GLuint buffer,
                          const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glBindBuffer, target, buffer);
@@ -68,11 +162,19 @@ inline void glBindBufferBase(GLenum target, GLuint index, GLuint buffer,
                              const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glBindBufferBase, target, index, buffer);
 }
+inline void glBindBufferRange(GLenum target, GLuint index, GLuint buffer,
+                              GLintptr offset, GLsizeiptr size,
+                              const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glBindBufferRange, target, index, buffer, offset,
+         size);
+}
+#if !defined(__EMSCRIPTEN__)
 inline void glBindFragDataLocation(GLuint program, GLuint colorNumber,
                                    const char* name,
                                    const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glBindFragDataLocation, program, colorNumber, name);
 }
+#endif
 inline void glBindFramebuffer(GLenum target, GLuint framebuffer,
                               const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glBindFramebuffer, target, framebuffer);
@@ -81,12 +183,18 @@ inline void glBindRenderbuffer(GLenum target, GLuint renderbuffer,
                                const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glBindRenderbuffer, target, renderbuffer);
 }
+inline void glBindSampler(GLuint unit, GLuint sampler,
+                          const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glBindSampler, unit, sampler);
+}
 inline void glBindTexture(GLenum target, GLuint texture,
                           const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::textureBinds);
   callGL(sourceLocation, ::glBindTexture, target, texture);
 }
 inline void glBindVertexArray(GLuint array,
                               const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::vertexArrayBinds);
   callGL(sourceLocation, ::glBindVertexArray, array);
 }
 inline void glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1,
@@ -97,11 +205,36 @@ inline void glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1,
   callGL(sourceLocation, ::glBlitFramebuffer, srcX0, srcY0, srcX1, srcY1, dstX0,
          dstY0, dstX1, dstY1, mask, filter);
 }
+inline void glBlendFunc(GLenum sfactor, GLenum dfactor,
+                        const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glBlendFunc, sfactor, dfactor);
+}
 inline void glBufferData(GLenum target, GLsizeiptr size, const void* data,
                          GLenum usage,
                          const sl& sourceLocation = sl::current()) {
+  if (data != nullptr) {
+    countGL(&GLStats::bufferBytes, static_cast<std::size_t>(size));
+  }
   callGL(sourceLocation, ::glBufferData, target, size, data, usage);
 }
+#if !defined(__EMSCRIPTEN__)
+inline void glBufferStorage(GLenum target, GLsizeiptr size, const void* data,
+                            GLbitfield flags,
+                            const sl& sourceLocation = sl::current()) {
+  if (data != nullptr) {
+    countGL(&GLStats::bufferBytes, static_cast<std::size_t>(size));
+  }
+  callGL(sourceLocation, ::glBufferStorage, target, size, data, flags);
+}
+#endif
+inline void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size,
+                            const void* data,
+                            const sl& sourceLocation = sl::current()) {
+  if (data != nullptr) {
+    countGL(&GLStats::bufferBytes, static_cast<std::size_t>(size));
+  }
+  callGL(sourceLocation, ::glBufferSubData, target, offset, size, data);
+}
 inline void glClear(GLbitfield mask, const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glClear, mask);
 }
@@ -125,6 +258,9 @@ inline void glCompileShader(GLuint shader,
                             const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glCompileShader, shader);
 }
+inline void glCullFace(GLenum mode, const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glCullFace, mode);
+}
 inline void glDeleteBuffers(GLsizei n, const GLuint* buffers,
                             const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glDeleteBuffers, n, buffers);
@@ -137,10 +273,18 @@ inline void glDeleteProgram(GLuint program,
                             const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glDeleteProgram, program);
 }
+inline void glDeleteQueries(GLsizei n, const GLuint* ids,
+                            const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glDeleteQueries, n, ids);
+}
 inline void glDeleteRenderbuffers(GLsizei n, GLuint* renderbuffers,
                                   const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glDeleteRenderbuffers, n, renderbuffers);
 }
+inline void glDeleteSamplers(GLsizei n, const GLuint* samplers,
+                             const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glDeleteSamplers, n, samplers);
+}
 inline void glDeleteShader(GLuint shader,
                            const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glDeleteShader, shader);
@@ -153,6 +297,16 @@ inline void glDeleteVertexArrays(GLsizei n, const GLuint* arrays,
                                  const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glDeleteVertexArrays, n, arrays);
 }
+inline void glDepthFunc(GLenum func, const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glDepthFunc, func);
+}
+inline void glDepthMask(GLboolean flag,
+                        const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glDepthMask, flag);
+}
+inline void glDisable(GLenum cap, const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glDisable, cap);
+}
 inline void glDrawBuffers(GLsizei n, const GLenum* bufs,
                           const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glDrawBuffers, n, bufs);
@@ -160,31 +314,73 @@ inline void glDrawBuffers(GLsizei n, const GLenum* bufs,
 inline void glDrawElements(GLenum mode, GLsizei count, GLenum type,
                            const void* indices,
                            const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::drawCalls);
+  countGL(&GLStats::vertices, static_cast<std::size_t>(count));
+  countGL(&GLStats::instances);
   callGL(sourceLocation, ::glDrawElements, mode, count, type, indices);
 }
 inline void glDrawArrays(GLenum mode, GLint first, GLsizei count,
                          const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::drawCalls);
+  countGL(&GLStats::vertices, static_cast<std::size_t>(count));
+  countGL(&GLStats::instances);
   callGL(sourceLocation, ::glDrawArrays, mode, first, count);
 }
+inline void glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count,
+                                  GLsizei instancecount,
+                                  const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::drawCalls);
+  countGL(&GLStats::vertices,
+          static_cast<std::size_t>(count) *
+              static_cast<std::size_t>(instancecount));
+  countGL(&GLStats::instances, static_cast<std::size_t>(instancecount));
+  callGL(sourceLocation, ::glDrawArraysInstanced, mode, first, count,
+         instancecount);
+}
+inline void glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type,
+                                    const void* indices,
+                                    GLsizei instancecount,
+                                    const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::drawCalls);
+  countGL(&GLStats::vertices,
+          static_cast<std::size_t>(count) *
+              static_cast<std::size_t>(instancecount));
+  countGL(&GLStats::instances, static_cast<std::size_t>(instancecount));
+  callGL(sourceLocation, ::glDrawElementsInstanced, mode, count, type,
+         indices, instancecount);
+}
 inline void glEnable(GLenum cap, const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glEnable, cap);
 }
+inline void glEndQuery(GLenum target,
+                       const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glEndQuery, target);
+}
 inline void glEnableVertexAttribArray(
     GLuint index, const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glEnableVertexAttribArray, index);
 }
+inline GLsync glFenceSync(GLenum condition, GLbitfield flags,
+                          const sl& sourceLocation = sl::current()) {
+  return callGL(sourceLocation, ::glFenceSync, condition, flags);
+}
 inline void glFramebufferRenderbuffer(
     GLenum target, GLenum attachment, GLenum renderbuffertarget,
     GLuint renderbuffer, const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glFramebufferRenderbuffer, target, attachment,
          renderbuffertarget, renderbuffer);
 }
+#if !defined(__EMSCRIPTEN__)
 inline void glFramebufferTexture(GLenum target, GLenum attachment,
                                  GLuint texture, GLint level,
                                  const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glFramebufferTexture, target, attachment, texture,
          level);
 }
+#endif
+inline void glFrontFace(GLenum mode, const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glFrontFace, mode);
+}
 inline void glGenerateMipmap(GLenum target,
                              const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glGenerateMipmap, target);
@@ -197,10 +393,18 @@ inline void glGenFramebuffers(GLsizei n, GLuint* ids,
                               const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glGenFramebuffers, n, ids);
 }
+inline void glGenQueries(GLsizei n, GLuint* ids,
+                         const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glGenQueries, n, ids);
+}
 inline void glGenRenderbuffers(GLsizei n, GLuint* renderbuffers,
                                const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glGenRenderbuffers, n, renderbuffers);
 }
+inline void glGenSamplers(GLsizei n, GLuint* samplers,
+                          const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glGenSamplers, n, samplers);
+}
 inline void glGenTextures(GLsizei n, GLuint* textures,
                           const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glGenTextures, n, textures);
@@ -217,10 +421,12 @@ inline void glGetBooleanv(GLenum pname, GLboolean* params,
                           const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glGetBooleanv, pname, params);
 }
+#if !defined(__EMSCRIPTEN__)
 inline void glGetDoublev(GLenum pname, GLdouble* params,
                          const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glGetDoublev, pname, params);
 }
+#endif
 inline void glGetFloatv(GLenum pname, GLfloat* params,
                         const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glGetFloatv, pname, params);
@@ -229,6 +435,16 @@ inline void glGetIntegerv(GLenum pname, GLint* params,
                           const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glGetIntegerv, pname, params);
 }
+#if !defined(__EMSCRIPTEN__)
+inline void glGetQueryObjectiv(GLuint id, GLenum pname, GLint* params,
+                               const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glGetQueryObjectiv, id, pname, params);
+}
+inline void glGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params,
+                                  const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glGetQueryObjectui64v, id, pname, params);
+}
+#endif
 inline void glGetShaderiv(GLuint shader, GLenum pname, GLint* params,
                           const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glGetShaderiv, shader, pname, params);
@@ -255,12 +471,26 @@ inline void glLinkProgram(GLuint program,
                           const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glLinkProgram, program);
 }
+inline void* glMapBufferRange(GLenum target, GLintptr offset,
+                              GLsizeiptr length, GLbitfield access,
+                              const sl& sourceLocation = sl::current()) {
+  return callGL(sourceLocation, ::glMapBufferRange, target, offset, length,
+                access);
+}
 inline void glRenderbufferStorage(GLenum target, GLenum internalformat,
                                   GLsizei width, GLsizei height,
                                   const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glRenderbufferStorage, target, internalformat, width,
          height);
 }
+inline void glSamplerParameterf(GLuint sampler, GLenum pname, GLfloat param,
+                                const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glSamplerParameterf, sampler, pname, param);
+}
+inline void glSamplerParameteri(GLuint sampler, GLenum pname, GLint param,
+                                const sl& sourceLocation = sl::current()) {
+  callGL(sourceLocation, ::glSamplerParameteri, sampler, pname, param);
+}
 inline void glShaderSource(GLuint shader, GLsizei count, const GLchar** string,
                            const GLint* length,
                            const sl& sourceLocation = sl::current()) {
@@ -273,6 +503,7 @@ inline void glTexImage2D(GLenum target, GLint level, GLint internalformat,
   callGL(sourceLocation, ::glTexImage2D, target, level, internalformat, width,
          height, border, format, type, data);
 }
+#if !defined(__EMSCRIPTEN__)
 inline void glTexImage2DMultisample(GLenum target, GLsizei samples,
                                     GLenum internalformat, GLsizei width,
                                     GLsizei height,
@@ -281,31 +512,42 @@ inline void glTexImage2DMultisample(GLenum target, GLsizei samples,
   callGL(sourceLocation, ::glTexImage2DMultisample, target, samples,
          internalformat, width, height, fixedsamplelocations);
 }
+#endif
 inline void glTexParameteri(GLenum target, GLenum pname, GLint param,
                             const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glTexParameteri, target, pname, param);
 }
 inline void glUniform1f(GLint location, GLfloat v0,
                         const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::uniformUploads);
   callGL(sourceLocation, ::glUniform1f, location, v0);
 }
 inline void glUniform1i(GLint location, GLint v0,
                         const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::uniformUploads);
   callGL(sourceLocation, ::glUniform1i, location, v0);
 }
 inline void glUniform3fv(GLint location, GLsizei count, const GLfloat* value,
                          const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::uniformUploads);
   callGL(sourceLocation, ::glUniform3fv, location, count, value);
 }
+inline void glUniform4fv(GLint location, GLsizei count, const GLfloat* value,
+                         const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::uniformUploads);
+  callGL(sourceLocation, ::glUniform4fv, location, count, value);
+}
 inline void glUniformMatrix3fv(GLint location, GLsizei count,
                                GLboolean transpose, const GLfloat* value,
                                const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::uniformUploads);
   callGL(sourceLocation, ::glUniformMatrix3fv, location, count, transpose,
          value);
 }
 inline void glUniformMatrix4fv(GLint location, GLsizei count,
                                GLboolean transpose, const GLfloat* value,
                                const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::uniformUploads);
   callGL(sourceLocation, ::glUniformMatrix4fv, location, count, transpose,
          value);
 }
@@ -315,8 +557,13 @@ inline void glUniformBlockBinding(GLuint program, GLuint uniformBlockIndex,
   callGL(sourceLocation, ::glUniformBlockBinding, program, uniformBlockIndex,
          uniformBlockBinding);
 }
+inline GLboolean glUnmapBuffer(GLenum target,
+                               const sl& sourceLocation = sl::current()) {
+  return callGL(sourceLocation, ::glUnmapBuffer, target);
+}
 inline void glUseProgram(GLuint program,
                          const sl& sourceLocation = sl::current()) {
+  countGL(&GLStats::programBinds);
   callGL(sourceLocation, ::glUseProgram, program);
 }
 inline void glVertexAttribPointer(GLuint index, GLint size, GLenum type,
@@ -330,7 +577,6 @@ inline void glViewport(GLint x, GLint y, GLsizei width, GLsizei height,
                        const sl& sourceLocation = sl::current()) {
   callGL(sourceLocation, ::glViewport, x, y, width, height);
 }
-#endif
 }  // namespace abcg
 
 #endif
\ No newline at end of file
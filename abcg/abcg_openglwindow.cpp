@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <limits>
 #include <regex>
 #include <sstream>
 #include <string_view>
@@ -22,8 +23,14 @@
 #include "SDL_video.h"
 #include "abcg_application.hpp"
 #include "abcg_embeddedfonts.hpp"
+#include "abcg_globject.hpp"
+#include "abcg_image.hpp"
 #include "abcg_openglfunctions.hpp"
 #include "abcg_string.hpp"
+#include "abcg_trace.hpp"
+
+// Number of frames painted after an event when the render policy is OnDemand
+constexpr int imGuiEventFrames{3};
 
 void printShaderInfoLog(GLuint shader, std::string_view prefix) {
   GLint infoLogLength{};
@@ -164,11 +171,16 @@ EM_BOOL abcg::fullscreenchangeCallback(
 
 abcg::OpenGLWindow::~OpenGLWindow() {
   if (m_window != nullptr) {
-    if (ImGui::GetCurrentContext() != nullptr) {
+    if (m_imGuiContext != nullptr) {
+      SDL_GL_MakeCurrent(m_window, m_GLContext);
+      ImGui::SetCurrentContext(m_imGuiContext);
+      GLStateCache::makeCurrent(&m_stateCache);
       terminateGL();
+      opengl::releaseSamplers();
+      GLStateCache::makeCurrent(nullptr);
       ImGui_ImplOpenGL3_Shutdown();
       ImGui_ImplSDL2_Shutdown();
-      ImGui::DestroyContext();
+      ImGui::DestroyContext(m_imGuiContext);
     }
 
     if (m_GLContext != nullptr) {
@@ -203,6 +215,18 @@ void abcg::OpenGLWindow::setWindowSettings(
   }
 
   m_windowSettings = windowSettings;
+  requestRedraw();
+}
+
+/**
+ * @brief Requests the window to be painted when the render policy is
+ * abcg::RenderPolicy::OnDemand.
+ *
+ * An animation calls this function on each frame (e.g., in
+ * abcg::OpenGLWindow::paintGL) while it is active.
+ */
+void abcg::OpenGLWindow::requestRedraw() noexcept {
+  m_redrawFrames = std::max(m_redrawFrames, 1);
 }
 
 void abcg::OpenGLWindow::handleEvent([[maybe_unused]] SDL_Event &event) {}
@@ -213,30 +237,76 @@ void abcg::OpenGLWindow::paintGL() { glClear(GL_COLOR_BUFFER_BIT); }
 
 void abcg::OpenGLWindow::paintUI() {
   // FPS counter
+  auto overlayBottom{0.0f};
   if (m_windowSettings.showFPS) {
-    float fps = ImGui::GetIO().Framerate;
-
-    static size_t offset{0};
-    static double refreshTime = ImGui::GetTime();
-    static std::array<float, 150> frames{};
-
-    while (refreshTime < ImGui::GetTime()) {
-      const auto refreshFrequency{60.0};
-      frames.at(offset) = fps;
-      offset = (offset + 1) % frames.size();
-      refreshTime += (1.0 / refreshFrequency);
-    }
+    // Frame times of this window, in milliseconds
+    const auto &frames{m_frameStats.getHistory()};
+    const auto recentMean{m_frameStats.getRecentMean()};
 
     ImGui::SetNextWindowPos(ImVec2(5, 5));
     ImGui::Begin("FPS", nullptr,
                  ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs |
                      ImGuiWindowFlags_NoBringToFrontOnFocus |
-                     ImGuiWindowFlags_NoFocusOnAppearing);
-    std::string label{fmt::format("avg {:.1f} FPS", fps)};
-    ImGui::PlotLines("", &frames[0], static_cast<int>(frames.size()),
-                     static_cast<int>(offset), label.c_str(), 0.0f,
+                     ImGuiWindowFlags_NoFocusOnAppearing |
+                     ImGuiWindowFlags_AlwaysAutoResize);
+    std::string label{fmt::format(
+        "avg {:.1f} FPS", recentMean > 0.0 ? 1000.0 / recentMean : 0.0)};
+    ImGui::PlotLines("", frames.data(), static_cast<int>(frames.size()),
+                     static_cast<int>(m_frameStats.getHistoryOffset()),
+                     label.c_str(), 0.0f,
                      *std::max_element(frames.begin(), frames.end()) * 2,
                      ImVec2(static_cast<float>(frames.size()), 50));
+    ImGui::Text("p99 %.1f ms, max %.1f ms", m_frameStats.getPercentile(99.0),
+                m_frameStats.getMax());
+    ImGui::Text("%zu stutters", m_frameStats.getStutterCount());
+    overlayBottom = ImGui::GetWindowPos().y + ImGui::GetWindowHeight();
+    ImGui::End();
+  }
+
+  // Live OpenGL objects owned by abcg::GLObject, to spot leaks
+  if (m_windowSettings.showGLObjects) {
+    ImGui::SetNextWindowPos(ImVec2(5, overlayBottom + 5.0f));
+    ImGui::Begin("GL objects", nullptr,
+                 ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs |
+                     ImGuiWindowFlags_NoBringToFrontOnFocus |
+                     ImGuiWindowFlags_NoFocusOnAppearing |
+                     ImGuiWindowFlags_AlwaysAutoResize);
+    for (const auto type :
+         {GLObjectType::Buffer, GLObjectType::VertexArray,
+          GLObjectType::Texture, GLObjectType::Program,
+          GLObjectType::Framebuffer}) {
+      const auto stats{GLObjectTracker::getStats(type)};
+      const auto name{GLObjectTracker::getTypeName(type)};
+      ImGui::Text("%.*s: %zu (%.1f KB)", static_cast<int>(name.size()),
+                  name.data(), stats.count,
+                  static_cast<double>(stats.bytes) / 1024.0);
+    }
+    ImGui::End();
+  }
+
+  // Work submitted through the OpenGL wrappers in the previous frame
+  if (m_windowSettings.showGLStats) {
+    ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - 5, 5),
+                            ImGuiCond_Always, ImVec2(1, 0));
+    ImGui::Begin("GL stats", nullptr,
+                 ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs |
+                     ImGuiWindowFlags_NoBringToFrontOnFocus |
+                     ImGuiWindowFlags_NoFocusOnAppearing |
+                     ImGuiWindowFlags_AlwaysAutoResize);
+    if (isGLStatsEnabled) {
+      const auto &stats{m_glFrameStats};
+      ImGui::Text("Draw calls: %zu", stats.drawCalls);
+      ImGui::Text("Vertices: %zu", stats.vertices);
+      ImGui::Text("Instances: %zu", stats.instances);
+      ImGui::Text("Program binds: %zu", stats.programBinds);
+      ImGui::Text("VAO binds: %zu", stats.vertexArrayBinds);
+      ImGui::Text("Texture binds: %zu", stats.textureBinds);
+      ImGui::Text("Uniform uploads: %zu", stats.uniformUploads);
+      ImGui::Text("Buffer uploads: %.1f KB",
+                  static_cast<double>(stats.bufferBytes) / 1024.0);
+    } else {
+      ImGui::Text("Build with ENABLE_GL_STATS=ON");
+    }
     ImGui::End();
   }
 
@@ -402,6 +472,39 @@ double abcg::OpenGLWindow::getElapsedTime() const {
   return m_windowStartTime.elapsed();
 }
 
+/**
+ * @brief Returns the mouse state of the current frame.
+ *
+ * Same as SDL_GetMouseState, but returns the recorded state when a session
+ * is replayed (see abcg::EventLog).
+ *
+ * @param x Pointer to the x coordinate of the mouse relative to the focused
+ * window, or nullptr.
+ * @param y Pointer to the y coordinate of the mouse relative to the focused
+ * window, or nullptr.
+ *
+ * @return Bit mask of the pressed mouse buttons.
+ */
+Uint32 abcg::OpenGLWindow::getMouseState(int *x, int *y) const {
+  if (!m_mouseState) return SDL_GetMouseState(x, y);
+
+  if (x != nullptr) *x = m_mouseState->x;
+  if (y != nullptr) *y = m_mouseState->y;
+  return m_mouseState->buttons;
+}
+
+/**
+ * @brief Returns the cache of OpenGL state of this window.
+ *
+ * The cache is also returned by abcg::GLStateCache::current while the window
+ * is being initialized, resized or painted.
+ *
+ * @return Reference to the state cache.
+ */
+abcg::GLStateCache &abcg::OpenGLWindow::getStateCache() noexcept {
+  return m_stateCache;
+}
+
 void abcg::OpenGLWindow::toggleFullscreen() {
 #if defined(__EMSCRIPTEN__)
   EM_ASM(toggleFullscreen(););
@@ -431,74 +534,80 @@ void abcg::OpenGLWindow::toggleFullscreen() {
 }
 
 void abcg::OpenGLWindow::handleEvent(SDL_Event &event, bool &done) {
+  // The application only passes the events of this window, or global events
+  ImGui::SetCurrentContext(m_imGuiContext);
   ImGui_ImplSDL2_ProcessEvent(&event);
 
-  if (event.window.windowID == m_windowID) {
-    if (event.type == SDL_WINDOWEVENT) {
-      if (event.window.event == SDL_WINDOWEVENT_CLOSE) {
-        done = true;
-      }
-      if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
-        auto &newWidth{event.window.data1};
-        auto &newHeight{event.window.data2};
-        if (newWidth >= 0 && newHeight >= 0 &&
-            (newWidth != m_viewportWidth || newHeight != m_viewportHeight)) {
-          m_viewportWidth = newWidth;
-          m_viewportHeight = newHeight;
-          resizeGL(newWidth, newHeight);
-        }
+  // ImGui may take a few frames to respond to an event (e.g., to resize a
+  // window to its new contents)
+  m_redrawFrames = std::max(m_redrawFrames, imGuiEventFrames);
+
+  if (event.type == SDL_WINDOWEVENT) {
+    if (event.window.event == SDL_WINDOWEVENT_CLOSE) {
+      done = true;
+    }
+    if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+      auto &newWidth{event.window.data1};
+      auto &newHeight{event.window.data2};
+      if (newWidth >= 0 && newHeight >= 0 &&
+          (newWidth != m_viewportWidth || newHeight != m_viewportHeight)) {
+        m_viewportWidth = newWidth;
+        m_viewportHeight = newHeight;
+        GLStateCache::makeCurrent(&m_stateCache);
+        resizeGL(newWidth, newHeight);
       }
-      if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
-        bool fullscreen{
-            (SDL_GetWindowFlags(m_window) & SDL_WINDOW_FULLSCREEN) != 0u};
-        if (!fullscreen) {
-          m_windowSettings.width = event.window.data1;
-          m_windowSettings.height = event.window.data2;
-        }
-#if defined(__EMSCRIPTEN__)
+    }
+    if (event.window.event == SDL_WINDOWEVENT_RESIZED) {
+      bool fullscreen{
+          (SDL_GetWindowFlags(m_window) & SDL_WINDOW_FULLSCREEN) != 0u};
+      if (!fullscreen) {
         m_windowSettings.width = event.window.data1;
         m_windowSettings.height = event.window.data2;
-        SDL_SetWindowSize(m_window, m_windowSettings.width,
-                          m_windowSettings.height);
-#endif
-        m_viewportWidth = event.window.data1;
-        m_viewportHeight = event.window.data2;
-        resizeGL(event.window.data1, event.window.data2);
       }
-    }
-    if (event.type == SDL_KEYUP) {
-      if (event.key.keysym.sym == SDLK_F11) {
 #if defined(__EMSCRIPTEN__)
-        bool isFullscreenAvailable =
-            static_cast<bool>(
-                EM_ASM_INT({ return document.fullscreenEnabled; })) &&
-            static_cast<bool>(EM_ASM_INT({ return !isMobile(); }));
-        if (isFullscreenAvailable)
+      m_windowSettings.width = event.window.data1;
+      m_windowSettings.height = event.window.data2;
+      SDL_SetWindowSize(m_window, m_windowSettings.width,
+                        m_windowSettings.height);
 #endif
-          toggleFullscreen();
-      }
+      m_viewportWidth = event.window.data1;
+      m_viewportHeight = event.window.data2;
+      GLStateCache::makeCurrent(&m_stateCache);
+      resizeGL(event.window.data1, event.window.data2);
     }
-
-    // Won't pass mouse events to the application if ImGUI has captured the
-    // mouse
-    bool useCustomEventHandler{true};
-    if (ImGui::GetIO().WantCaptureMouse &&
-        (event.type == SDL_MOUSEMOTION || event.type == SDL_MOUSEBUTTONDOWN ||
-         event.type == SDL_MOUSEBUTTONUP || event.type == SDL_MOUSEWHEEL)) {
-      useCustomEventHandler = false;
+  }
+  if (event.type == SDL_KEYUP) {
+    if (event.key.keysym.sym == SDLK_F11) {
+#if defined(__EMSCRIPTEN__)
+      bool isFullscreenAvailable =
+          static_cast<bool>(
+              EM_ASM_INT({ return document.fullscreenEnabled; })) &&
+          static_cast<bool>(EM_ASM_INT({ return !isMobile(); }));
+      if (isFullscreenAvailable)
+#endif
+        toggleFullscreen();
     }
+  }
 
-    // Won't pass keyboard events to the application if ImGUI has captured the
-    // keyboard
-    if (ImGui::GetIO().WantCaptureKeyboard &&
-        (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP ||
-         event.type == SDL_TEXTEDITING || event.type == SDL_TEXTINPUT ||
-         event.type == SDL_KEYMAPCHANGED)) {
-      useCustomEventHandler = false;
-    }
+  // Won't pass mouse events to the application if ImGUI has captured the
+  // mouse
+  bool useCustomEventHandler{true};
+  if (ImGui::GetIO().WantCaptureMouse &&
+      (event.type == SDL_MOUSEMOTION || event.type == SDL_MOUSEBUTTONDOWN ||
+       event.type == SDL_MOUSEBUTTONUP || event.type == SDL_MOUSEWHEEL)) {
+    useCustomEventHandler = false;
+  }
 
-    if (useCustomEventHandler) handleEvent(event);
+  // Won't pass keyboard events to the application if ImGUI has captured the
+  // keyboard
+  if (ImGui::GetIO().WantCaptureKeyboard &&
+      (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP ||
+       event.type == SDL_TEXTEDITING || event.type == SDL_TEXTINPUT ||
+       event.type == SDL_KEYMAPCHANGED)) {
+    useCustomEventHandler = false;
   }
+
+  if (useCustomEventHandler) handleEvent(event);
 }
 
 void abcg::OpenGLWindow::initialize(std::string_view basePath) {
@@ -562,6 +671,14 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
       m_GLSLVersion = "#version 300 es";
       break;
   }
+#if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  if (m_openGLSettings.debugOutput) {
+    int contextFlags{};
+    SDL_GL_GetAttribute(SDL_GL_CONTEXT_FLAGS, &contextFlags);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_FLAGS,
+                        contextFlags | SDL_GL_CONTEXT_DEBUG_FLAG);
+  }
+#endif
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, majorVersion);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, minorVersion);
 
@@ -578,10 +695,12 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
   }
 
   // Create window with graphics context
+  Uint32 windowFlags{SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE};
+  if (m_hidden) windowFlags |= SDL_WINDOW_HIDDEN;
   m_window = SDL_CreateWindow(m_windowSettings.title.c_str(),
                               SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
                               m_windowSettings.width, m_windowSettings.height,
-                              SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE);
+                              windowFlags);
   if (m_window == nullptr) {
     throw abcg::Exception{abcg::Exception::SDL("SDL_CreateWindow failed")};
   }
@@ -612,14 +731,20 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
   fmt::print("Using GLEW.....: {}\n", glewGetString(GLEW_VERSION));
 #endif
 
+#if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  m_debugOutputAvailable = initializeGLDebugOutput();
+#endif
+
   fmt::print("OpenGL vendor..: {}\n", glGetString(GL_VENDOR));
   fmt::print("OpenGL renderer: {}\n", glGetString(GL_RENDERER));
   fmt::print("OpenGL version.: {}\n", glGetString(GL_VERSION));
   fmt::print("GLSL version...: {}\n", glGetString(GL_SHADING_LANGUAGE_VERSION));
 
-  // Setup Dear ImGui context
+  // Setup Dear ImGui context. Each window has its own context, made current
+  // before the window handles events or is painted
   IMGUI_CHECKVERSION();
-  ImGui::CreateContext();
+  m_imGuiContext = ImGui::CreateContext();
+  ImGui::SetCurrentContext(m_imGuiContext);
   ImGuiIO &io{ImGui::GetIO()};
   // Enable Keyboard Controls
   io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
@@ -649,6 +774,8 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
     throw abcg::Exception{abcg::Exception::Runtime("Failed to load font file")};
   }
 
+  GLStateCache::makeCurrent(&m_stateCache);
+  m_stateCache.invalidate();
   initializeGL();
 
   if (io.DisplaySize.x >= 0 && io.DisplaySize.y >= 0) {
@@ -660,10 +787,21 @@ void abcg::OpenGLWindow::initialize(std::string_view basePath) {
   } else {
     resizeGL(m_windowSettings.width, m_windowSettings.height);
   }
+
+  m_redrawFrames = imGuiEventFrames;
 }
 
 void abcg::OpenGLWindow::paint() {
+  ABCG_TRACE_SCOPE("OpenGLWindow::paint");
   SDL_GL_MakeCurrent(m_window, m_GLContext);
+  ImGui::SetCurrentContext(m_imGuiContext);
+  GLStateCache::makeCurrent(&m_stateCache);
+  m_stateCache.beginFrame();
+  m_frameStats.beginFrame();
+  glStats = {};
+#if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  setGLDebugOutput(m_openGLSettings.debugOutput && m_debugOutputAvailable);
+#endif
 
 #if defined(__EMSCRIPTEN__)
   // Force window size in windowed mode
@@ -675,18 +813,61 @@ void abcg::OpenGLWindow::paint() {
   }
 #endif
 
-  ImGui_ImplOpenGL3_NewFrame();
-  ImGui_ImplSDL2_NewFrame(m_window);
-  ImGui::NewFrame();
-  paintUI();
-  ImGui::Render();
-  paintGL();
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-  SDL_GL_SwapWindow(m_window);
+  // Consumes the pending request before painting, so that a request made by
+  // paintUI or paintGL paints the next frame
+  if (m_redrawFrames > 0) --m_redrawFrames;
+
+  {
+    ABCG_TRACE_SCOPE("paintUI");
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplSDL2_NewFrame(m_window);
+    ImGui::NewFrame();
+    paintUI();
+    ImGui::Render();
+  }
+  {
+    ABCG_TRACE_SCOPE("paintGL");
+    paintGL();
+  }
+  {
+    ABCG_TRACE_SCOPE("Render ImGui");
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+  }
+#if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+  flushGLDebugOutput(m_openGLSettings.throwOnDebugError);
+#endif
+  // Calls of ImGui_ImplOpenGL3 do not go through the wrappers and are not
+  // counted
+  m_glFrameStats = glStats;
+  m_latencyMeter.submit();
+  {
+    ABCG_TRACE_SCOPE("SDL_GL_SwapWindow");
+    SDL_GL_SwapWindow(m_window);
+  }
+  m_latencyMeter.present();
 
   // Cap to 480 Hz
   if (m_deltaTime.elapsed() >= 1.0 / 480.0) {
     m_lastDeltaTime = m_deltaTime.restart();
   } else
     m_lastDeltaTime = 0.0;
+
+  m_paintTime.restart();
+}
+
+// Seconds until the window must be painted according to its render policy,
+// or infinity if it waits for an event or a redraw request
+double abcg::OpenGLWindow::getTimeToNextPaint() const {
+  switch (m_windowSettings.renderPolicy) {
+    case RenderPolicy::OnDemand:
+      if (m_redrawFrames > 0) return 0.0;
+      ImGui::SetCurrentContext(m_imGuiContext);
+      if (ImGui::GetIO().WantTextInput) return 0.0;
+      return std::numeric_limits<double>::infinity();
+    case RenderPolicy::Throttled:
+      return std::max(0.0, 1.0 / m_windowSettings.throttledFPS -
+                               m_paintTime.elapsed());
+    default:
+      return 0.0;
+  }
 }
\ No newline at end of file
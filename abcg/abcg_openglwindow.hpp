@@ -10,15 +10,24 @@
 #ifndef ABCG_OPENGLWINDOW_HPP_
 #define ABCG_OPENGLWINDOW_HPP_
 
+#include <optional>
 #include <string>
 
 #include "abcg_elapsedtimer.hpp"
+#include "abcg_eventlog.hpp"
 #include "abcg_external.hpp"
+#include "abcg_framestats.hpp"
+#include "abcg_glstatecache.hpp"
+#include "abcg_latencymeter.hpp"
+#include "abcg_openglfunctions.hpp"
+
+struct ImGuiContext;
 
 namespace abcg {
 enum class OpenGLProfile;
 class Application;
 class OpenGLWindow;
+enum class RenderPolicy;
 struct OpenGLSettings;
 struct WindowSettings;
 #if defined(__EMSCRIPTEN__)
@@ -34,6 +43,18 @@ EM_BOOL fullscreenchangeCallback(int eventType,
  */
 enum class abcg::OpenGLProfile { Core, Compatibility, ES };
 
+/**
+ * @brief Enumeration of policies that decide when a window is painted.
+ *
+ * - Continuous: the window is painted on every iteration of the main loop.
+ * - OnDemand: the window is painted when it receives an event, when
+ * abcg::OpenGLWindow::requestRedraw is called, or while ImGui expects text
+ * input. The application sleeps while no window needs to be painted.
+ * - Throttled: the window is painted continuously, at most
+ * abcg::WindowSettings::throttledFPS times per second.
+ */
+enum class abcg::RenderPolicy { Continuous, OnDemand, Throttled };
+
 struct abcg::OpenGLSettings {
   OpenGLProfile profile{OpenGLProfile::Core};
   int majorVersion{4};
@@ -43,6 +64,10 @@ struct abcg::OpenGLSettings {
   int samples{0};
   bool vsync{false};
   bool preserveWebGLDrawingBuffer{false};
+  // Debug builds only: check errors with the KHR_debug output, reported at
+  // the end of each frame, instead of glGetError around each call
+  bool debugOutput{true};
+  bool throwOnDebugError{true};
 };
 
 struct abcg::WindowSettings {
@@ -50,7 +75,11 @@ struct abcg::WindowSettings {
   int height{600};
   bool showFPS{true};
   bool showFullscreenButton{true};
+  bool showGLObjects{false};
+  bool showGLStats{false};
   std::string title{"ABCg Window"};
+  RenderPolicy renderPolicy{RenderPolicy::Continuous};
+  double throttledFPS{30.0};
 };
 
 /**
@@ -71,6 +100,7 @@ class abcg::OpenGLWindow {
   [[nodiscard]] WindowSettings getWindowSettings() noexcept;
   void setOpenGLSettings(const OpenGLSettings& openGLSettings) noexcept;
   void setWindowSettings(const WindowSettings& windowSettings);
+  void requestRedraw() noexcept;
 
  protected:
   virtual void handleEvent(SDL_Event& event);
@@ -89,12 +119,21 @@ class abcg::OpenGLWindow {
   std::string getAssetsPath();
   [[nodiscard]] double getDeltaTime() const;
   [[nodiscard]] double getElapsedTime() const;
+  Uint32 getMouseState(int* x, int* y) const;
+  [[nodiscard]] GLStateCache& getStateCache() noexcept;
+  [[nodiscard]] GLStats getGLFrameStats() const noexcept {
+    return m_glFrameStats;
+  }
+  [[nodiscard]] const FrameStats& getFrameStats() const noexcept {
+    return m_frameStats;
+  }
   void toggleFullscreen();
 
  private:
   void handleEvent(SDL_Event& event, bool& done);
   void initialize(std::string_view basePath);
   void paint();
+  [[nodiscard]] double getTimeToNextPaint() const;
 
   WindowSettings m_windowSettings{};
   OpenGLSettings m_openGLSettings{};
@@ -104,15 +143,33 @@ class abcg::OpenGLWindow {
 
   SDL_Window* m_window{};
   SDL_GLContext m_GLContext{};
+  ImGuiContext* m_imGuiContext{};
   Uint32 m_windowID{};
+  bool m_debugOutputAvailable{};
+  // Set by the application in headless mode
+  bool m_hidden{};
+
+  // Mouse state of the frame, set by the application while an event log is
+  // recorded or replayed
+  std::optional<EventLog::MouseState> m_mouseState;
 
   int m_viewportWidth{};
   int m_viewportHeight{};
 
+  GLStateCache m_stateCache;
+  GLStats m_glFrameStats{};
+  LatencyMeter m_latencyMeter;
+  FrameStats m_frameStats;
+
   ElapsedTimer m_deltaTime;
   ElapsedTimer m_windowStartTime;
   double m_lastDeltaTime{0.0};
 
+  // Frames still to be painted by the OnDemand policy, and time since the
+  // last paint for the Throttled policy
+  int m_redrawFrames{};
+  ElapsedTimer m_paintTime;
+
   friend Application;
 
 #if defined(__EMSCRIPTEN__)
@@ -0,0 +1,58 @@
+/**
+ * @file abcg_random.cpp
+ * @brief Definition of random seed helper functions.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_random.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace {
+std::optional<unsigned int> baseSeed;
+std::atomic<std::uint64_t> numSeeds{};
+}  // namespace
+
+/**
+ * @brief Returns a seed for a random number engine.
+ *
+ * Without a base seed, the seed is taken from the steady clock. Otherwise,
+ * the n-th call returns the same seed for the same base seed, so that a
+ * session can be replayed with the same random numbers.
+ *
+ * @return Seed for a random number engine.
+ */
+unsigned int abcg::randomSeed() {
+  if (!baseSeed) {
+    return static_cast<unsigned int>(
+        std::chrono::steady_clock::now().time_since_epoch().count());
+  }
+
+  // Finalizer of SplitMix64 applied to the base seed and the call index
+  auto seed{static_cast<std::uint64_t>(*baseSeed) +
+            0x9E3779B97F4A7C15ULL * (numSeeds.fetch_add(1) + 1)};
+  seed = (seed ^ (seed >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+  seed = (seed ^ (seed >> 27U)) * 0x94D049BB133111EBULL;
+  return static_cast<unsigned int>(seed ^ (seed >> 31U));
+}
+
+/**
+ * @brief Sets the base seed of abcg::randomSeed.
+ *
+ * @param seed Base seed, or std::nullopt to take seeds from the steady clock.
+ */
+void abcg::setRandomSeed(std::optional<unsigned int> seed) {
+  baseSeed = seed;
+  numSeeds = 0;
+}
+
+/**
+ * @brief Returns the base seed of abcg::randomSeed.
+ *
+ * @return Base seed, or std::nullopt if seeds are taken from the steady
+ * clock.
+ */
+std::optional<unsigned int> abcg::getRandomSeed() { return baseSeed; }
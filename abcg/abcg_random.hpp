@@ -0,0 +1,19 @@
+/**
+ * @file abcg_random.hpp
+ * @brief Declaration of random seed helper functions.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_RANDOM_HPP_
+#define ABCG_RANDOM_HPP_
+
+#include <optional>
+
+namespace abcg {
+[[nodiscard]] unsigned int randomSeed();
+void setRandomSeed(std::optional<unsigned int> seed);
+[[nodiscard]] std::optional<unsigned int> getRandomSeed();
+}  // namespace abcg
+
+#endif
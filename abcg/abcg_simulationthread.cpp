@@ -0,0 +1,145 @@
+/**
+ * @file abcg_simulationthread.cpp
+ * @brief Definition of abcg::SimulationThread class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_simulationthread.hpp"
+
+#include <utility>
+
+#include "abcg_trace.hpp"
+
+/**
+ * @brief Stops the simulation.
+ */
+abcg::SimulationThread::~SimulationThread() { stop(); }
+
+/**
+ * @brief Starts running the simulation.
+ *
+ * The first step runs immediately. If the simulation is already running, it
+ * is stopped first.
+ *
+ * @param simulate Function that advances the simulation by the timestep, in
+ * seconds, given as argument.
+ * @param rate Number of steps per second.
+ */
+void abcg::SimulationThread::start(SimulateFunction simulate, double rate) {
+  stop();
+
+  m_simulate = std::move(simulate);
+  m_deltaTime = 1.0 / rate;
+  m_timestep = std::chrono::duration_cast<clock::duration>(
+      std::chrono::duration<double>{m_deltaTime});
+  m_numSteps.store(0, std::memory_order_relaxed);
+  m_running = true;
+
+#if !defined(__EMSCRIPTEN__)
+  if (!ElapsedTimer::usesFrameClock()) {
+    m_stop = false;
+    m_thread = std::thread{[this] { run(); }};
+    return;
+  }
+#endif
+
+  // The first step is due at the first poll
+  m_clock.restart();
+  m_lag = m_deltaTime;
+}
+
+/**
+ * @brief Stops the simulation and waits for the step in progress to finish.
+ *
+ * An exception thrown by the simulation function that was not rethrown by
+ * abcg::SimulationThread::poll is discarded.
+ */
+void abcg::SimulationThread::stop() {
+  if (!m_running) return;
+  m_running = false;
+
+  if (m_thread.joinable()) {
+    {
+      const std::lock_guard lock{m_mutex};
+      m_stop = true;
+    }
+    m_wakeUp.notify_one();
+    m_thread.join();
+    m_exception = nullptr;
+  }
+}
+
+/**
+ * @brief Checks the simulation, and runs the steps that are due if there is
+ * no simulation thread (on Emscripten, or while the frame clock is enabled).
+ *
+ * Called once per frame by the thread that started the simulation.
+ *
+ * @throw Exception thrown by the simulation function, after which the
+ * simulation is stopped.
+ */
+void abcg::SimulationThread::poll() {
+  if (!m_running) return;
+
+  if (m_thread.joinable()) {
+    std::exception_ptr exception;
+    {
+      const std::lock_guard lock{m_mutex};
+      exception = std::exchange(m_exception, nullptr);
+    }
+    if (exception) {
+      stop();
+      std::rethrow_exception(exception);
+    }
+    return;
+  }
+
+  m_lag += m_clock.restart();
+  for (auto numSteps{0}; m_lag >= m_deltaTime; ++numSteps) {
+    if (numSteps == maxCatchUpSteps) {
+      m_lag = 0.0;
+      break;
+    }
+    try {
+      step();
+    } catch (...) {
+      m_running = false;
+      throw;
+    }
+    m_lag -= m_deltaTime;
+  }
+}
+
+void abcg::SimulationThread::run() {
+  Trace::setThreadName("Simulation");
+
+  auto nextStep{clock::now()};
+  std::unique_lock lock{m_mutex};
+  while (!m_stop) {
+    lock.unlock();
+    try {
+      step();
+    } catch (...) {
+      lock.lock();
+      m_exception = std::current_exception();
+      return;
+    }
+
+    nextStep += m_timestep;
+    if (const auto now{clock::now()};
+        now - nextStep > maxCatchUpSteps * m_timestep) {
+      nextStep = now;
+    }
+
+    // Sleeps until the next step, but wakes up as soon as it is stopped
+    lock.lock();
+    m_wakeUp.wait_until(lock, nextStep, [this] { return m_stop; });
+  }
+}
+
+void abcg::SimulationThread::step() {
+  ABCG_TRACE_SCOPE("Simulate");
+  m_simulate(m_deltaTime);
+  m_numSteps.fetch_add(1, std::memory_order_relaxed);
+}
@@ -0,0 +1,104 @@
+/**
+ * @file abcg_simulationthread.hpp
+ * @brief abcg::SimulationThread header file.
+ *
+ * Declaration of abcg::SimulationThread class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_SIMULATIONTHREAD_HPP_
+#define ABCG_SIMULATIONTHREAD_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "abcg_elapsedtimer.hpp"
+
+namespace abcg {
+class SimulationThread;
+}  // namespace abcg
+
+/**
+ * @brief abcg::SimulationThread class.
+ *
+ * Runs a simulation function at a fixed rate on its own thread, so that the
+ * simulation neither waits for the frames nor depends on the frame rate.
+ *
+ * The simulation function must not make OpenGL calls. It usually hands each
+ * new state over to the thread that renders through an abcg::TripleBuffer,
+ * and reads the input of the rendering thread from atomic variables.
+ *
+ * abcg::SimulationThread::poll is called once per frame by the thread that
+ * started the simulation. It rethrows an exception thrown by the simulation
+ * function.
+ *
+ * Without threads (on Emscripten), and while the frame clock of
+ * abcg::ElapsedTimer is enabled (i.e., while abcg::EventLog records or
+ * replays a session), there is no simulation thread: poll runs the steps that
+ * are due on the calling thread, measured by abcg::ElapsedTimer. Thus a
+ * replay runs the same steps, with the same input, as the recorded session.
+ *
+ * If the simulation falls behind by more than
+ * abcg::SimulationThread::maxCatchUpSteps (e.g., after a breakpoint), the
+ * steps that are late are dropped instead of run at once.
+ */
+class abcg::SimulationThread {
+ public:
+  using SimulateFunction = std::function<void(double)>;
+
+  /** @brief Default number of steps per second. */
+  static constexpr double defaultRate{120.0};
+  /** @brief Maximum number of late steps that are run to catch up. */
+  static constexpr int maxCatchUpSteps{8};
+
+  SimulationThread() = default;
+  ~SimulationThread();
+
+  SimulationThread(const SimulationThread&) = delete;
+  SimulationThread(SimulationThread&&) = delete;
+  SimulationThread& operator=(const SimulationThread&) = delete;
+  SimulationThread& operator=(SimulationThread&&) = delete;
+
+  void start(SimulateFunction simulate, double rate = defaultRate);
+  void stop();
+  void poll();
+
+  [[nodiscard]] bool isRunning() const noexcept { return m_running; }
+  [[nodiscard]] double getTimestep() const noexcept { return m_deltaTime; }
+  [[nodiscard]] std::uint64_t getNumSteps() const noexcept {
+    return m_numSteps.load(std::memory_order_relaxed);
+  }
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  SimulateFunction m_simulate;
+  double m_deltaTime{};
+  clock::duration m_timestep{};
+  bool m_running{};
+  std::atomic<std::uint64_t> m_numSteps{};
+
+  // Without a simulation thread: time since the last step was due
+  ElapsedTimer m_clock;
+  double m_lag{};
+
+  // Simulation thread, and the stop request and exception guarded by the
+  // mutex
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_wakeUp;
+  bool m_stop{};
+  std::exception_ptr m_exception;
+
+  void run();
+  void step();
+};
+
+#endif
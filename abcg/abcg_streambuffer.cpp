@@ -0,0 +1,179 @@
+/**
+ * @file abcg_streambuffer.cpp
+ * @brief Definition of abcg::StreamBuffer class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_streambuffer.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "abcg_exception.hpp"
+#include "abcg_openglfunctions.hpp"
+
+/**
+ * @brief Creates the buffer.
+ *
+ * Must be called when no VAO is bound, as the buffer is bound to `target`
+ * once to define its type.
+ *
+ * @param target Intended use of the buffer (e.g. GL_ARRAY_BUFFER or
+ * GL_ELEMENT_ARRAY_BUFFER).
+ * @param frameCapacity Maximum number of bytes pushed per frame.
+ * @param numFrames Number of frames whose data can be in flight.
+ */
+void abcg::StreamBuffer::create(GLenum target, std::size_t frameCapacity,
+                                std::size_t numFrames) {
+  destroy();
+
+  m_frameCapacity = frameCapacity;
+  m_fences.assign(std::max<std::size_t>(numFrames, 1), nullptr);
+  m_segment = 0;
+  m_head = 0;
+  const auto size{static_cast<GLsizeiptr>(m_frameCapacity * m_fences.size())};
+
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(target, m_buffer);
+#if !defined(__EMSCRIPTEN__)
+  if (GLEW_ARB_buffer_storage) {
+    const GLbitfield flags{GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                           GL_MAP_COHERENT_BIT};
+    glBufferStorage(target, size, nullptr, flags);
+    m_mapped = static_cast<std::byte *>(
+        glMapBufferRange(target, 0, size, flags));
+    if (m_mapped == nullptr) {
+      throw abcg::Exception{
+          abcg::Exception::Runtime("Failed to map stream buffer")};
+    }
+  } else
+#endif
+  {
+    glBufferData(target, size, nullptr, GL_STREAM_DRAW);
+  }
+  glBindBuffer(target, 0);
+}
+
+/**
+ * @brief Deletes the buffer and its pending fences.
+ */
+void abcg::StreamBuffer::destroy() {
+  for (auto &fence : m_fences) {
+    if (fence != nullptr) glDeleteSync(fence);
+    fence = nullptr;
+  }
+
+#if !defined(__EMSCRIPTEN__)
+  if (m_mapped != nullptr) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    m_mapped = nullptr;
+  }
+#endif
+
+  glDeleteBuffers(1, &m_buffer);
+  m_buffer = 0;
+}
+
+/**
+ * @brief Fences the segment of the previous frame and starts writing to the
+ * next one.
+ *
+ * Waits until the GPU has finished reading the next segment, which only
+ * happens if the CPU is more than `numFrames` frames ahead.
+ */
+void abcg::StreamBuffer::beginFrame() {
+#if !defined(__EMSCRIPTEN__)
+  auto &lastFence{m_fences.at(m_segment)};
+  if (getFrameSize() > 0) {
+    if (lastFence != nullptr) glDeleteSync(lastFence);
+    lastFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+#endif
+
+  m_segment = (m_segment + 1) % m_fences.size();
+  m_head = m_segment * m_frameCapacity;
+
+#if !defined(__EMSCRIPTEN__)
+  if (auto &fence{m_fences.at(m_segment)}; fence != nullptr) {
+    while (true) {
+      const auto result{
+          glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000)};
+      if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+        break;
+      }
+      if (result == GL_WAIT_FAILED) {
+        throw abcg::Exception{
+            abcg::Exception::Runtime("Failed to wait on stream buffer fence")};
+      }
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+  }
+#endif
+}
+
+/**
+ * @brief Copies data to the segment of the current frame.
+ *
+ * @param data Pointer to the data.
+ * @param size Size of the data in bytes.
+ * @param alignment Alignment of the returned offset in bytes.
+ *
+ * @throw abcg::Exception if the data does not fit in the remaining capacity
+ * of the frame, or if the buffer cannot be mapped.
+ *
+ * @return Byte offset of the data in the buffer.
+ */
+std::size_t abcg::StreamBuffer::push(const void *data, std::size_t size,
+                                     std::size_t alignment) {
+  alignment = std::max<std::size_t>(alignment, 1);
+  const auto offset{(m_head + alignment - 1) / alignment * alignment};
+  const auto segmentEnd{(m_segment + 1) * m_frameCapacity};
+  if (offset + size > segmentEnd) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Stream buffer frame capacity exceeded ({} bytes)",
+                    m_frameCapacity))};
+  }
+  if (size == 0) {
+    m_head = offset;
+    return offset;
+  }
+
+  if (m_mapped != nullptr) {
+    std::memcpy(m_mapped + offset, data, size);
+    countGL(&GLStats::bufferBytes, size);
+    m_head = offset + size;
+    return offset;
+  }
+
+  // GL_COPY_WRITE_BUFFER does not disturb the bindings of the current VAO
+  glBindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+#if defined(__EMSCRIPTEN__)
+  glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(offset),
+                  static_cast<GLsizeiptr>(size), data);
+#else
+  // The range is not in use by the GPU, so it is mapped without waiting
+  auto *mapped{glMapBufferRange(GL_COPY_WRITE_BUFFER,
+                                static_cast<GLintptr>(offset),
+                                static_cast<GLsizeiptr>(size),
+                                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                                    GL_MAP_UNSYNCHRONIZED_BIT)};
+  if (mapped == nullptr) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    throw abcg::Exception{
+        abcg::Exception::Runtime("Failed to map stream buffer")};
+  }
+  std::memcpy(mapped, data, size);
+  glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+  countGL(&GLStats::bufferBytes, size);
+#endif
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  m_head = offset + size;
+  return offset;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file abcg_streambuffer.hpp
+ * @brief abcg::StreamBuffer header file.
+ *
+ * Declaration of abcg::StreamBuffer class.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_STREAMBUFFER_HPP_
+#define ABCG_STREAMBUFFER_HPP_
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+namespace abcg {
+class StreamBuffer;
+}  // namespace abcg
+
+/**
+ * @brief abcg::StreamBuffer class.
+ *
+ * Ring allocator over a single buffer object for vertex and index data that
+ * changes every frame.
+ *
+ * The buffer is divided into one segment per frame in flight. Data pushed
+ * during a frame is written to the segment of that frame and is referenced
+ * by its byte offset in the buffer (e.g., as the first vertex of
+ * `glDrawArrays` or as the index pointer of `glDrawElements`). When the ring
+ * wraps around, abcg::StreamBuffer::beginFrame waits on the fence of the
+ * segment that is about to be reused.
+ *
+ * The buffer is persistently mapped when `GL_ARB_buffer_storage` is
+ * available. Otherwise, each push maps the range it writes with
+ * `GL_MAP_UNSYNCHRONIZED_BIT`. In WebGL, which does not support buffer
+ * mapping, data is uploaded with `glBufferSubData`.
+ */
+class abcg::StreamBuffer {
+ public:
+  void create(GLenum target, std::size_t frameCapacity,
+              std::size_t numFrames = 3);
+  void destroy();
+
+  void beginFrame();
+  [[nodiscard]] std::size_t push(const void* data, std::size_t size,
+                                 std::size_t alignment = 16);
+
+  /**
+   * @brief Pushes the elements of a contiguous container.
+   *
+   * @param data Container of trivially copyable elements (e.g. `std::array`
+   * or `std::vector`).
+   * @return Byte offset of the first element in the buffer.
+   */
+  template <typename TContainer>
+  [[nodiscard]] std::size_t push(const TContainer& data) {
+    using TValue = typename TContainer::value_type;
+    return push(std::data(data), std::size(data) * sizeof(TValue),
+                alignof(TValue));
+  }
+
+  [[nodiscard]] GLuint getBuffer() const noexcept { return m_buffer; }
+  [[nodiscard]] std::size_t getFrameCapacity() const noexcept {
+    return m_frameCapacity;
+  }
+  [[nodiscard]] std::size_t getFrameSize() const noexcept {
+    return m_head - m_segment * m_frameCapacity;
+  }
+
+ private:
+  GLuint m_buffer{};
+  std::size_t m_frameCapacity{};
+  std::size_t m_segment{};
+  std::size_t m_head{};
+
+  // Fence of the last frame that wrote each segment
+  std::vector<GLsync> m_fences;
+
+  // Base address of the buffer if persistently mapped
+  std::byte* m_mapped{};
+};
+
+#endif
@@ -9,6 +9,7 @@
 #define ABCG_STRING_HPP_
 
 #include <string>
+#include <string_view>
 
 namespace abcg {
 void leftTrim(std::string &s);
@@ -17,6 +18,7 @@ void trim(std::string &s);
 [[nodiscard]] std::string leftTrimCopy(std::string s);
 [[nodiscard]] std::string rightTrimCopy(std::string s);
 [[nodiscard]] std::string trimCopy(std::string s);
+[[nodiscard]] std::string escapeJSON(std::string_view text);
 }  // namespace abcg
 
 #endif
\ No newline at end of file
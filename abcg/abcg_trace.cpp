@@ -0,0 +1,390 @@
+/**
+ * @file abcg_trace.cpp
+ * @brief Definition of abcg::Trace class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_trace.hpp"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "abcg_exception.hpp"
+#include "abcg_string.hpp"
+
+namespace {
+enum class EventType : std::uint8_t { Begin = 1, End = 2 };
+
+// Slots are atomic because abcg::Trace::write may read a slot while its
+// thread overwrites it. Such slots are discarded by the reader
+struct Slot {
+  std::atomic<std::int64_t> time{};
+  std::atomic<const char *> name{};
+  std::atomic<EventType> type{};
+};
+
+struct ThreadBuffer {
+  explicit ThreadBuffer(std::uint32_t id)
+      : slots{std::make_unique<Slot[]>(abcg::Trace::defaultEventsPerThread)},
+        threadID{id} {}
+
+  std::unique_ptr<Slot[]> slots;
+  // Number of events written since the thread started tracing
+  std::atomic<std::uint64_t> head{};
+  std::uint32_t threadID{};
+  std::string threadName;
+};
+
+struct Event {
+  std::int64_t time{};
+  const char *name{};
+  EventType type{};
+  std::uint32_t threadID{};
+};
+
+struct ThreadInfo {
+  std::uint32_t threadID{};
+  std::string name;
+};
+
+static_assert((abcg::Trace::defaultEventsPerThread &
+               (abcg::Trace::defaultEventsPerThread - 1)) == 0,
+              "Capacity of the ring buffers must be a power of two");
+
+// Buffers of all threads that recorded events. They are kept after their
+// threads exit, until the program ends
+std::mutex buffersMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+thread_local ThreadBuffer *currentBuffer{};
+thread_local std::string currentThreadName;
+
+const auto traceEpoch{std::chrono::steady_clock::now()};
+
+std::int64_t now() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - traceEpoch)
+      .count();
+}
+
+ThreadBuffer &getThreadBuffer() {
+  if (currentBuffer == nullptr) {
+    const std::scoped_lock lock{buffersMutex};
+    buffers.push_back(std::make_unique<ThreadBuffer>(
+        static_cast<std::uint32_t>(buffers.size() + 1)));
+    currentBuffer = buffers.back().get();
+    currentBuffer->threadName =
+        currentThreadName.empty()
+            ? fmt::format("Thread {}", currentBuffer->threadID)
+            : currentThreadName;
+  }
+  return *currentBuffer;
+}
+
+void record(const char *name, EventType type) noexcept {
+  ThreadBuffer *buffer{};
+  try {
+    buffer = &getThreadBuffer();
+  } catch (...) {
+    // Out of memory: the event is dropped
+    return;
+  }
+
+  const auto index{buffer->head.load(std::memory_order_relaxed)};
+  auto &slot{
+      buffer->slots[index & (abcg::Trace::defaultEventsPerThread - 1)]};
+  slot.time.store(now(), std::memory_order_relaxed);
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.type.store(type, std::memory_order_relaxed);
+  buffer->head.store(index + 1, std::memory_order_release);
+}
+
+// Copies the events of a buffer that were not overwritten during the copy
+void readEvents(const ThreadBuffer &buffer, std::vector<Event> &events) {
+  constexpr auto capacity{abcg::Trace::defaultEventsPerThread};
+  const auto head{buffer.head.load(std::memory_order_acquire)};
+  const auto first{head > capacity ? head - capacity : 0};
+
+  std::vector<Event> copied;
+  copied.reserve(head - first);
+  for (auto index{first}; index < head; ++index) {
+    const auto &slot{buffer.slots[index & (capacity - 1)]};
+    copied.push_back({slot.time.load(std::memory_order_relaxed),
+                      slot.name.load(std::memory_order_relaxed),
+                      slot.type.load(std::memory_order_relaxed),
+                      buffer.threadID});
+  }
+
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const auto newHead{buffer.head.load(std::memory_order_relaxed)};
+  const auto firstValid{newHead > capacity ? newHead - capacity : 0};
+  const auto skip{std::min<std::uint64_t>(
+      firstValid > first ? firstValid - first : 0, copied.size())};
+  events.insert(events.end(),
+                copied.begin() + static_cast<std::ptrdiff_t>(skip),
+                copied.end());
+}
+
+// Events of the last seconds, sorted by time, and the names of their threads
+std::vector<Event> collectEvents(double seconds,
+                                 std::vector<ThreadInfo> &threads) {
+  const auto cutoff{now() - static_cast<std::int64_t>(seconds * 1.0e9)};
+  std::vector<Event> events;
+  {
+    const std::scoped_lock lock{buffersMutex};
+    for (const auto &buffer : buffers) {
+      std::vector<Event> threadEvents;
+      readEvents(*buffer, threadEvents);
+
+      // End events of scopes that began before the time window are
+      // discarded, as viewers cannot match them
+      std::size_t depth{};
+      auto hasEvents{false};
+      for (const auto &event : threadEvents) {
+        if (event.time < cutoff) continue;
+        if (event.type == EventType::Begin) {
+          ++depth;
+        } else if (depth > 0) {
+          --depth;
+        } else {
+          continue;
+        }
+        events.push_back(event);
+        hasEvents = true;
+      }
+      if (hasEvents) {
+        threads.push_back({buffer->threadID, buffer->threadName});
+      }
+    }
+  }
+
+  std::stable_sort(
+      events.begin(), events.end(),
+      [](const auto &a, const auto &b) { return a.time < b.time; });
+  return events;
+}
+
+void writeChrome(std::ofstream &stream, const std::vector<Event> &events,
+                 const std::vector<ThreadInfo> &threads) {
+  std::string json{"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"};
+  auto out{std::back_inserter(json)};
+  auto first{true};
+  const auto separator{[&] {
+    if (!first) json += ",\n";
+    first = false;
+  }};
+
+  for (const auto &thread : threads) {
+    separator();
+    fmt::format_to(out,
+                   R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},)"
+                   R"("args":{{"name":"{}"}}}})",
+                   thread.threadID, abcg::escapeJSON(thread.name));
+  }
+  for (const auto &event : events) {
+    separator();
+    // Timestamps are in microseconds
+    if (event.type == EventType::Begin) {
+      fmt::format_to(
+          out, R"({{"name":"{}","ph":"B","ts":{:.3f},"pid":1,"tid":{}}})",
+          abcg::escapeJSON(event.name), static_cast<double>(event.time) / 1.0e3,
+          event.threadID);
+    } else {
+      fmt::format_to(out, R"({{"ph":"E","ts":{:.3f},"pid":1,"tid":{}}})",
+                     static_cast<double>(event.time) / 1.0e3, event.threadID);
+    }
+  }
+  json += "\n]}\n";
+  stream.write(json.data(), static_cast<std::streamsize>(json.size()));
+}
+
+// Minimal protobuf encoder for the fields of perfetto.protos.Trace used here
+class ProtoWriter {
+ public:
+  void varint(std::uint32_t field, std::uint64_t value) {
+    tag(field, 0);
+    encode(value);
+  }
+  void bytes(std::uint32_t field, std::string_view value) {
+    tag(field, 2);
+    encode(value.size());
+    m_data.append(value);
+  }
+  void message(std::uint32_t field, const ProtoWriter &writer) {
+    bytes(field, writer.m_data);
+  }
+  [[nodiscard]] const std::string &data() const noexcept { return m_data; }
+
+ private:
+  std::string m_data;
+
+  void tag(std::uint32_t field, std::uint32_t wireType) {
+    encode(field << 3U | wireType);
+  }
+  void encode(std::uint64_t value) {
+    while (value >= 0x80) {
+      m_data += static_cast<char>((value & 0x7F) | 0x80);
+      value >>= 7U;
+    }
+    m_data += static_cast<char>(value);
+  }
+};
+
+void writePerfetto(std::ofstream &stream, const std::vector<Event> &events,
+                   const std::vector<ThreadInfo> &threads) {
+  // Field numbers of perfetto/protos/perfetto/trace/*.proto
+  constexpr std::uint32_t tracePacket{1};
+  constexpr std::uint32_t packetTimestamp{8};
+  constexpr std::uint32_t packetSequenceID{10};
+  constexpr std::uint32_t packetTrackEvent{11};
+  constexpr std::uint32_t packetTrackDescriptor{60};
+  constexpr std::uint32_t descriptorUUID{1};
+  constexpr std::uint32_t descriptorName{2};
+  constexpr std::uint32_t descriptorThread{4};
+  constexpr std::uint32_t threadPID{1};
+  constexpr std::uint32_t threadTID{2};
+  constexpr std::uint32_t threadName{5};
+  constexpr std::uint32_t eventType{9};
+  constexpr std::uint32_t eventTrackUUID{11};
+  constexpr std::uint32_t eventName{23};
+  constexpr std::uint32_t sequenceID{1};
+  constexpr std::uint32_t pid{1};
+
+  ProtoWriter trace;
+  for (const auto &thread : threads) {
+    ProtoWriter threadDescriptor;
+    threadDescriptor.varint(threadPID, pid);
+    threadDescriptor.varint(threadTID, thread.threadID);
+    threadDescriptor.bytes(threadName, thread.name);
+
+    ProtoWriter trackDescriptor;
+    trackDescriptor.varint(descriptorUUID, thread.threadID);
+    trackDescriptor.bytes(descriptorName, thread.name);
+    trackDescriptor.message(descriptorThread, threadDescriptor);
+
+    ProtoWriter packet;
+    packet.varint(packetSequenceID, sequenceID);
+    packet.message(packetTrackDescriptor, trackDescriptor);
+    trace.message(tracePacket, packet);
+  }
+
+  for (const auto &event : events) {
+    ProtoWriter trackEvent;
+    trackEvent.varint(eventType, static_cast<std::uint64_t>(event.type));
+    trackEvent.varint(eventTrackUUID, event.threadID);
+    if (event.type == EventType::Begin) trackEvent.bytes(eventName, event.name);
+
+    ProtoWriter packet;
+    packet.varint(packetTimestamp, static_cast<std::uint64_t>(event.time));
+    packet.varint(packetSequenceID, sequenceID);
+    packet.message(packetTrackEvent, trackEvent);
+    trace.message(tracePacket, packet);
+  }
+
+  stream.write(trace.data().data(),
+               static_cast<std::streamsize>(trace.data().size()));
+}
+}  // namespace
+
+/**
+ * @brief Enables the recording of events.
+ */
+void abcg::Trace::start() { m_enabled.store(true, std::memory_order_relaxed); }
+
+/**
+ * @brief Disables the recording of events.
+ *
+ * Events already recorded are kept, and can still be written.
+ */
+void abcg::Trace::stop() noexcept {
+  m_enabled.store(false, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Records the beginning of a scope on the calling thread.
+ *
+ * Prefer ABCG_TRACE_SCOPE, which also records the end of the scope.
+ *
+ * @param name Name of the scope. Must outlive the trace, e.g., a string
+ * literal.
+ */
+void abcg::Trace::begin(const char *name) noexcept {
+  record(name, EventType::Begin);
+}
+
+/**
+ * @brief Records the end of the innermost scope of the calling thread.
+ */
+void abcg::Trace::end() noexcept { record(nullptr, EventType::End); }
+
+/**
+ * @brief Sets the name of the calling thread shown in the trace.
+ *
+ * @param name Name of the thread.
+ */
+void abcg::Trace::setThreadName(std::string_view name) {
+  currentThreadName = name;
+  if (currentBuffer != nullptr) {
+    const std::scoped_lock lock{buffersMutex};
+    currentBuffer->threadName = name;
+  }
+}
+
+/**
+ * @brief Writes the events of the last seconds to a file.
+ *
+ * The format is chosen from the extension of the file: `.json` for
+ * abcg::Trace::Format::Chrome, anything else for
+ * abcg::Trace::Format::Perfetto.
+ *
+ * @param path Path of the file.
+ * @param seconds Length of the time window, ending now.
+ *
+ * @throw abcg::Exception if the file cannot be written.
+ */
+void abcg::Trace::write(const std::string &path, double seconds) {
+  const auto isJSON{path.size() >= 5 &&
+                    path.compare(path.size() - 5, 5, ".json") == 0};
+  write(path, seconds, isJSON ? Format::Chrome : Format::Perfetto);
+}
+
+/**
+ * @brief Writes the events of the last seconds to a file.
+ *
+ * Scopes still open are written without their end events.
+ *
+ * @param path Path of the file.
+ * @param seconds Length of the time window, ending now.
+ * @param format Format of the file.
+ *
+ * @throw abcg::Exception if the file cannot be written.
+ */
+void abcg::Trace::write(const std::string &path, double seconds,
+                        Format format) {
+  std::vector<ThreadInfo> threads;
+  const auto events{collectEvents(seconds, threads)};
+
+  std::ofstream stream{path, std::ios::binary};
+  if (!stream) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Failed to open trace file {}", path))};
+  }
+  if (format == Format::Chrome) {
+    writeChrome(stream, events, threads);
+  } else {
+    writePerfetto(stream, events, threads);
+  }
+  if (!stream) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Failed to write trace file {}", path))};
+  }
+}
@@ -0,0 +1,110 @@
+/**
+ * @file abcg_trace.hpp
+ * @brief abcg::Trace header file.
+ *
+ * Declaration of abcg::Trace and abcg::TraceScope classes, and of the tracing
+ * macros.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_TRACE_HPP_
+#define ABCG_TRACE_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace abcg {
+class Trace;
+class TraceScope;
+}  // namespace abcg
+
+#define ABCG_TRACE_CONCAT_(a, b) a##b
+#define ABCG_TRACE_CONCAT(a, b) ABCG_TRACE_CONCAT_(a, b)
+
+/**
+ * @brief Records a begin event now and an end event at the end of the
+ * enclosing scope.
+ *
+ * The name must outlive the trace, e.g., a string literal.
+ */
+#define ABCG_TRACE_SCOPE(name) \
+  const abcg::TraceScope ABCG_TRACE_CONCAT(abcgTraceScope, __LINE__) { name }
+
+/**
+ * @brief Traces the enclosing function.
+ */
+#define ABCG_TRACE_FUNCTION() ABCG_TRACE_SCOPE(__func__)
+
+/**
+ * @brief abcg::Trace class.
+ *
+ * Records begin and end events of the threads of the application, to be
+ * written as a Chrome trace (JSON, opened by chrome://tracing or
+ * https://ui.perfetto.dev) or as a Perfetto trace (protobuf).
+ *
+ * Each thread writes its events to its own ring buffer, without locks. A
+ * buffer keeps the last abcg::Trace::defaultEventsPerThread events of its
+ * thread, so only the last events are written if the trace runs for long.
+ *
+ * Tracing is disabled until abcg::Trace::start is called. While it is
+ * disabled, a traced scope costs a relaxed atomic load.
+ *
+ * abcg::Application starts tracing when the executable is called with
+ * `--trace <file>`, and writes the last `--trace-seconds <seconds>` (default
+ * 10) to the file when the application exits. Files ending in `.json` are
+ * written as Chrome traces, other files as Perfetto traces.
+ */
+class abcg::Trace {
+ public:
+  enum class Format { Chrome, Perfetto };
+
+  /** @brief Capacity of the ring buffer of each thread. */
+  static constexpr std::size_t defaultEventsPerThread{1 << 16};
+
+  static void start();
+  static void stop() noexcept;
+  [[nodiscard]] static bool isEnabled() noexcept {
+    return m_enabled.load(std::memory_order_relaxed);
+  }
+
+  static void begin(const char* name) noexcept;
+  static void end() noexcept;
+  static void setThreadName(std::string_view name);
+
+  static void write(const std::string& path, double seconds);
+  static void write(const std::string& path, double seconds, Format format);
+
+ private:
+  inline static std::atomic<bool> m_enabled{false};
+};
+
+/**
+ * @brief abcg::TraceScope class.
+ *
+ * Records a begin event when constructed and the matching end event when
+ * destroyed. Used by ABCG_TRACE_SCOPE.
+ */
+class abcg::TraceScope {
+ public:
+  explicit TraceScope(const char* name) noexcept
+      : m_active{Trace::isEnabled()} {
+    if (m_active) Trace::begin(name);
+  }
+  ~TraceScope() {
+    if (m_active) Trace::end();
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope(TraceScope&&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+  TraceScope& operator=(TraceScope&&) = delete;
+
+ private:
+  // The end event is recorded even if tracing stops within the scope
+  bool m_active{};
+};
+
+#endif
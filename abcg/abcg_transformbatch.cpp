@@ -0,0 +1,348 @@
+/**
+ * @file abcg_transformbatch.cpp
+ * @brief Definition of abcg::TransformBatch class members.
+ *
+ * This project is released under the MIT License.
+ */
+
+#include "abcg_transformbatch.hpp"
+
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/mat3x3.hpp>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+// Column of the transform of an object. Indices 0-3 are the columns of the
+// model matrix, 4-7 of the model-view matrix and 8-10 of the normal matrix
+glm::vec4 &column(abcg::InstanceTransform &transform, std::size_t index) {
+  if (index < 4) {
+    return transform.modelMatrix[static_cast<glm::length_t>(index)];
+  }
+  if (index < 8) {
+    return transform.modelViewMatrix[static_cast<glm::length_t>(index - 4)];
+  }
+  return transform.normalMatrix.at(index - 8);
+}
+
+// One float per pack, used when there is no SIMD support and for the objects
+// that do not fill a SIMD register
+struct ScalarPack {
+  static constexpr std::size_t width{1};
+  float v;
+
+  static ScalarPack load(const float *p) { return {*p}; }
+  static ScalarPack broadcast(float f) { return {f}; }
+  friend ScalarPack operator+(ScalarPack a, ScalarPack b) {
+    return {a.v + b.v};
+  }
+  friend ScalarPack operator-(ScalarPack a, ScalarPack b) {
+    return {a.v - b.v};
+  }
+  friend ScalarPack operator*(ScalarPack a, ScalarPack b) {
+    return {a.v * b.v};
+  }
+  friend ScalarPack operator/(ScalarPack a, ScalarPack b) {
+    return {a.v / b.v};
+  }
+
+  // Stores the given column of one object
+  static void store(abcg::InstanceTransform *out, std::size_t index, ScalarPack x,
+                    ScalarPack y, ScalarPack z, ScalarPack w) {
+    column(*out, index) = {x.v, y.v, z.v, w.v};
+  }
+};
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+// Transposes four lanes of x, y, z and w and stores them as the given column
+// of four consecutive objects
+void storeTransposed(abcg::InstanceTransform *out, std::size_t index, __m128 x,
+                     __m128 y, __m128 z, __m128 w) {
+  _MM_TRANSPOSE4_PS(x, y, z, w);
+  _mm_storeu_ps(&column(out[0], index).x, x);
+  _mm_storeu_ps(&column(out[1], index).x, y);
+  _mm_storeu_ps(&column(out[2], index).x, z);
+  _mm_storeu_ps(&column(out[3], index).x, w);
+}
+#endif
+
+#if defined(__AVX__)
+struct SIMDPack {
+  static constexpr std::size_t width{8};
+  __m256 v;
+
+  static SIMDPack load(const float *p) { return {_mm256_loadu_ps(p)}; }
+  static SIMDPack broadcast(float f) { return {_mm256_set1_ps(f)}; }
+  friend SIMDPack operator+(SIMDPack a, SIMDPack b) {
+    return {_mm256_add_ps(a.v, b.v)};
+  }
+  friend SIMDPack operator-(SIMDPack a, SIMDPack b) {
+    return {_mm256_sub_ps(a.v, b.v)};
+  }
+  friend SIMDPack operator*(SIMDPack a, SIMDPack b) {
+    return {_mm256_mul_ps(a.v, b.v)};
+  }
+  friend SIMDPack operator/(SIMDPack a, SIMDPack b) {
+    return {_mm256_div_ps(a.v, b.v)};
+  }
+
+  static void store(abcg::InstanceTransform *out, std::size_t index, SIMDPack x,
+                    SIMDPack y, SIMDPack z, SIMDPack w) {
+    storeTransposed(out, index, _mm256_castps256_ps128(x.v),
+                    _mm256_castps256_ps128(y.v), _mm256_castps256_ps128(z.v),
+                    _mm256_castps256_ps128(w.v));
+    storeTransposed(out + 4, index, _mm256_extractf128_ps(x.v, 1),
+                    _mm256_extractf128_ps(y.v, 1),
+                    _mm256_extractf128_ps(z.v, 1),
+                    _mm256_extractf128_ps(w.v, 1));
+  }
+};
+#elif defined(__SSE2__) || defined(_M_X64)
+struct SIMDPack {
+  static constexpr std::size_t width{4};
+  __m128 v;
+
+  static SIMDPack load(const float *p) { return {_mm_loadu_ps(p)}; }
+  static SIMDPack broadcast(float f) { return {_mm_set1_ps(f)}; }
+  friend SIMDPack operator+(SIMDPack a, SIMDPack b) {
+    return {_mm_add_ps(a.v, b.v)};
+  }
+  friend SIMDPack operator-(SIMDPack a, SIMDPack b) {
+    return {_mm_sub_ps(a.v, b.v)};
+  }
+  friend SIMDPack operator*(SIMDPack a, SIMDPack b) {
+    return {_mm_mul_ps(a.v, b.v)};
+  }
+  friend SIMDPack operator/(SIMDPack a, SIMDPack b) {
+    return {_mm_div_ps(a.v, b.v)};
+  }
+
+  static void store(abcg::InstanceTransform *out, std::size_t index, SIMDPack x,
+                    SIMDPack y, SIMDPack z, SIMDPack w) {
+    storeTransposed(out, index, x.v, y.v, z.v, w.v);
+  }
+};
+#elif defined(__ARM_NEON)
+struct SIMDPack {
+  static constexpr std::size_t width{4};
+  float32x4_t v;
+
+  static SIMDPack load(const float *p) { return {vld1q_f32(p)}; }
+  static SIMDPack broadcast(float f) { return {vdupq_n_f32(f)}; }
+  friend SIMDPack operator+(SIMDPack a, SIMDPack b) {
+    return {vaddq_f32(a.v, b.v)};
+  }
+  friend SIMDPack operator-(SIMDPack a, SIMDPack b) {
+    return {vsubq_f32(a.v, b.v)};
+  }
+  friend SIMDPack operator*(SIMDPack a, SIMDPack b) {
+    return {vmulq_f32(a.v, b.v)};
+  }
+  friend SIMDPack operator/(SIMDPack a, SIMDPack b) {
+    // Reciprocal estimate refined with two Newton-Raphson steps
+    auto reciprocal{vrecpeq_f32(b.v)};
+    reciprocal = vmulq_f32(vrecpsq_f32(b.v, reciprocal), reciprocal);
+    reciprocal = vmulq_f32(vrecpsq_f32(b.v, reciprocal), reciprocal);
+    return {vmulq_f32(a.v, reciprocal)};
+  }
+
+  static void store(abcg::InstanceTransform *out, std::size_t index, SIMDPack x,
+                    SIMDPack y, SIMDPack z, SIMDPack w) {
+    const auto xy{vtrnq_f32(x.v, y.v)};
+    const auto zw{vtrnq_f32(z.v, w.v)};
+    vst1q_f32(&column(out[0], index).x,
+              vcombine_f32(vget_low_f32(xy.val[0]), vget_low_f32(zw.val[0])));
+    vst1q_f32(&column(out[1], index).x,
+              vcombine_f32(vget_low_f32(xy.val[1]), vget_low_f32(zw.val[1])));
+    vst1q_f32(&column(out[2], index).x,
+              vcombine_f32(vget_high_f32(xy.val[0]), vget_high_f32(zw.val[0])));
+    vst1q_f32(&column(out[3], index).x,
+              vcombine_f32(vget_high_f32(xy.val[1]), vget_high_f32(zw.val[1])));
+  }
+};
+#else
+using SIMDPack = ScalarPack;
+#endif
+
+struct Inputs {
+  const float *translationX;
+  const float *translationY;
+  const float *translationZ;
+  const float *scale;
+  const float *rotationX;
+  const float *rotationY;
+  const float *rotationZ;
+  const float *rotationW;
+};
+
+// Computes the transforms of the objects in [first, last) that fill whole
+// packs. Returns the end of the computed range
+template <typename Pack>
+std::size_t computeRange(const Inputs &in, std::size_t first, std::size_t last,
+                         const glm::mat4 &viewMatrix,
+                         const glm::mat3 &viewNormalMatrix,
+                         abcg::InstanceTransform *out) {
+  const auto zero{Pack::broadcast(0.0f)};
+  const auto one{Pack::broadcast(1.0f)};
+  const auto two{Pack::broadcast(2.0f)};
+
+  // Entries of the view and normal matrices are the same for every object
+  std::array<std::array<Pack, 4>, 4> V{};
+  for (glm::length_t col{}; col < 4; ++col) {
+    for (glm::length_t row{}; row < 4; ++row) {
+      V.at(static_cast<std::size_t>(col)).at(static_cast<std::size_t>(row)) =
+          Pack::broadcast(viewMatrix[col][row]);
+    }
+  }
+  std::array<std::array<Pack, 3>, 3> A{};
+  for (glm::length_t col{}; col < 3; ++col) {
+    for (glm::length_t row{}; row < 3; ++row) {
+      A.at(static_cast<std::size_t>(col)).at(static_cast<std::size_t>(row)) =
+          Pack::broadcast(viewNormalMatrix[col][row]);
+    }
+  }
+
+  auto index{first};
+  for (; index + Pack::width <= last; index += Pack::width) {
+    const auto tx{Pack::load(in.translationX + index)};
+    const auto ty{Pack::load(in.translationY + index)};
+    const auto tz{Pack::load(in.translationZ + index)};
+    const auto s{Pack::load(in.scale + index)};
+    const auto qx{Pack::load(in.rotationX + index)};
+    const auto qy{Pack::load(in.rotationY + index)};
+    const auto qz{Pack::load(in.rotationZ + index)};
+    const auto qw{Pack::load(in.rotationW + index)};
+
+    // Rotation matrix of the unit quaternion
+    const auto xx{qx * qx};
+    const auto yy{qy * qy};
+    const auto zz{qz * qz};
+    const auto xy{qx * qy};
+    const auto xz{qx * qz};
+    const auto yz{qy * qz};
+    const auto wx{qw * qx};
+    const auto wy{qw * qy};
+    const auto wz{qw * qz};
+    const std::array<std::array<Pack, 3>, 3> R{
+        {{one - two * (yy + zz), two * (xy + wz), two * (xz - wy)},
+         {two * (xy - wz), one - two * (xx + zz), two * (yz + wx)},
+         {two * (xz + wy), two * (yz - wx), one - two * (xx + yy)}}};
+
+    auto *transforms{out + index};
+
+    // Model matrix: T * R * S
+    for (std::size_t col{}; col < 3; ++col) {
+      const auto &r{R.at(col)};
+      Pack::store(transforms, col, r[0] * s, r[1] * s, r[2] * s, zero);
+    }
+    Pack::store(transforms, 3, tx, ty, tz, one);
+
+    // Model-view matrix: V * M
+    for (std::size_t col{}; col < 3; ++col) {
+      const auto &r{R.at(col)};
+      std::array<Pack, 4> mv{};
+      for (std::size_t row{}; row < 4; ++row) {
+        mv.at(row) = (V[0][row] * r[0] + V[1][row] * r[1] + V[2][row] * r[2]) *
+                     s;
+      }
+      Pack::store(transforms, 4 + col, mv[0], mv[1], mv[2], mv[3]);
+    }
+    {
+      std::array<Pack, 4> mv{};
+      for (std::size_t row{}; row < 4; ++row) {
+        mv.at(row) =
+            V[0][row] * tx + V[1][row] * ty + V[2][row] * tz + V[3][row];
+      }
+      Pack::store(transforms, 7, mv[0], mv[1], mv[2], mv[3]);
+    }
+
+    // Normal matrix: inverseTranspose(mat3(V)) * R / s
+    const auto invScale{one / s};
+    for (std::size_t col{}; col < 3; ++col) {
+      const auto &r{R.at(col)};
+      std::array<Pack, 3> n{};
+      for (std::size_t row{}; row < 3; ++row) {
+        n.at(row) = (A[0][row] * r[0] + A[1][row] * r[1] + A[2][row] * r[2]) *
+                    invScale;
+      }
+      Pack::store(transforms, 8 + col, n[0], n[1], n[2], zero);
+    }
+  }
+
+  return index;
+}
+}  // namespace
+
+/**
+ * @brief Removes all objects from the batch.
+ */
+void abcg::TransformBatch::clear() {
+  for (auto *array : {&m_translationX, &m_translationY, &m_translationZ,
+                      &m_scale, &m_rotationX, &m_rotationY, &m_rotationZ,
+                      &m_rotationW}) {
+    array->clear();
+  }
+}
+
+/**
+ * @brief Reserves memory for a number of objects.
+ *
+ * @param size Number of objects.
+ */
+void abcg::TransformBatch::reserve(std::size_t size) {
+  for (auto *array : {&m_translationX, &m_translationY, &m_translationZ,
+                      &m_scale, &m_rotationX, &m_rotationY, &m_rotationZ,
+                      &m_rotationW}) {
+    array->reserve(size);
+  }
+}
+
+/**
+ * @brief Adds an object to the batch.
+ *
+ * @param translation Position of the object.
+ * @param scale Uniform scale factor. Must not be zero.
+ * @param rotation Orientation of the object as a unit quaternion.
+ */
+void abcg::TransformBatch::push(const glm::vec3 &translation, float scale,
+                                const glm::quat &rotation) {
+  m_translationX.push_back(translation.x);
+  m_translationY.push_back(translation.y);
+  m_translationZ.push_back(translation.z);
+  m_scale.push_back(scale);
+  m_rotationX.push_back(rotation.x);
+  m_rotationY.push_back(rotation.y);
+  m_rotationZ.push_back(rotation.z);
+  m_rotationW.push_back(rotation.w);
+}
+
+/**
+ * @brief Computes the matrices of all objects.
+ *
+ * @param viewMatrix View matrix used for the model-view and normal matrices.
+ * It must be invertible and its last row must be (0, 0, 0, 1).
+ * @param transforms Vector that receives one transform per object, in the
+ * order the objects were added. It is resized to the size of the batch.
+ */
+void abcg::TransformBatch::compute(
+    const glm::mat4 &viewMatrix,
+    std::vector<InstanceTransform> &transforms) const {
+  transforms.resize(size());
+
+  const Inputs inputs{m_translationX.data(), m_translationY.data(),
+                      m_translationZ.data(), m_scale.data(),
+                      m_rotationX.data(),    m_rotationY.data(),
+                      m_rotationZ.data(),    m_rotationW.data()};
+  const auto viewNormalMatrix{glm::inverseTranspose(glm::mat3(viewMatrix))};
+
+  const auto last{computeRange<SIMDPack>(inputs, 0, size(), viewMatrix,
+                                         viewNormalMatrix, transforms.data())};
+  computeRange<ScalarPack>(inputs, last, size(), viewMatrix, viewNormalMatrix,
+                           transforms.data());
+}
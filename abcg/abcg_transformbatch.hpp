@@ -0,0 +1,78 @@
+/**
+ * @file abcg_transformbatch.hpp
+ * @brief abcg::TransformBatch header file.
+ *
+ * Declaration of abcg::TransformBatch class and abcg::InstanceTransform.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_TRANSFORMBATCH_HPP_
+#define ABCG_TRANSFORMBATCH_HPP_
+
+#include <array>
+#include <cstddef>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+namespace abcg {
+class TransformBatch;
+struct InstanceTransform;
+}  // namespace abcg
+
+/**
+ * @brief Matrices of one object computed by abcg::TransformBatch.
+ *
+ * The layout is the same as that of a std140 uniform block or an instanced
+ * vertex buffer with one vec4 attribute per column: the normal matrix is a
+ * mat3 with each column padded to a vec4.
+ */
+struct abcg::InstanceTransform {
+  glm::mat4 modelMatrix{1.0f};
+  glm::mat4 modelViewMatrix{1.0f};
+  std::array<glm::vec4, 3> normalMatrix{};
+};
+
+/**
+ * @brief abcg::TransformBatch class.
+ *
+ * Translation, uniform scale and rotation of a set of objects stored as a
+ * structure of arrays, so that the model, model-view and normal matrices of
+ * all objects can be computed with SIMD instructions. SSE (or AVX, if
+ * enabled at compile time) is used on x86, and NEON is used on ARM.
+ * Otherwise, and for the objects that do not fill a SIMD register, the
+ * computation is scalar.
+ *
+ * The model matrix of each object is `T * R * S`, where `T` is the
+ * translation, `R` the rotation and `S` the uniform scale. As `R` is
+ * orthonormal and `S` is uniform, the normal matrix
+ * `inverseTranspose(mat3(V * T * R * S))` simplifies to
+ * `inverseTranspose(mat3(V)) * R / s`, and the inverse is computed only once
+ * per batch.
+ */
+class abcg::TransformBatch {
+ public:
+  void clear();
+  void reserve(std::size_t size);
+  void push(const glm::vec3& translation, float scale = 1.0f,
+            const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+  void compute(const glm::mat4& viewMatrix,
+               std::vector<InstanceTransform>& transforms) const;
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_scale.size(); }
+
+ private:
+  std::vector<float> m_translationX;
+  std::vector<float> m_translationY;
+  std::vector<float> m_translationZ;
+  std::vector<float> m_scale;
+  std::vector<float> m_rotationX;
+  std::vector<float> m_rotationY;
+  std::vector<float> m_rotationZ;
+  std::vector<float> m_rotationW;
+};
+
+#endif
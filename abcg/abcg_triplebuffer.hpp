@@ -0,0 +1,107 @@
+/**
+ * @file abcg_triplebuffer.hpp
+ * @brief abcg::TripleBuffer header file.
+ *
+ * Declaration and definition of abcg::TripleBuffer class template.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_TRIPLEBUFFER_HPP_
+#define ABCG_TRIPLEBUFFER_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace abcg {
+template <typename T>
+class TripleBuffer;
+}  // namespace abcg
+
+/**
+ * @brief abcg::TripleBuffer class template.
+ *
+ * Hands values over from one writer thread to one reader thread without
+ * locks and without blocking either of them.
+ *
+ * The three buffers are the back buffer, owned by the writer, the front
+ * buffer, owned by the reader, and the middle buffer, which holds the latest
+ * published value. Publishing swaps the back buffer with the middle buffer,
+ * and abcg::TripleBuffer::update swaps the middle buffer with the front
+ * buffer if a value was published since the last update. Thus the reader
+ * always sees the latest complete value, and values that the reader did not
+ * take in time are overwritten.
+ *
+ * The writer fills abcg::TripleBuffer::getWriteBuffer and calls
+ * abcg::TripleBuffer::publish. The back buffer holds an older value, not
+ * necessarily the one published last, so the writer must overwrite all of
+ * it. The reader calls abcg::TripleBuffer::update and reads
+ * abcg::TripleBuffer::getReadBuffer.
+ *
+ * @tparam T Type of the values.
+ */
+template <typename T>
+class abcg::TripleBuffer {
+ public:
+  TripleBuffer() = default;
+  explicit TripleBuffer(const T& value) : m_buffers{value, value, value} {}
+
+  TripleBuffer(const TripleBuffer&) = delete;
+  TripleBuffer(TripleBuffer&&) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+  TripleBuffer& operator=(TripleBuffer&&) = delete;
+
+  [[nodiscard]] T& getWriteBuffer() noexcept { return m_buffers[m_back]; }
+  void publish() noexcept;
+
+  bool update() noexcept;
+  [[nodiscard]] const T& getReadBuffer() const noexcept {
+    return m_buffers[m_front];
+  }
+
+ private:
+  static constexpr std::uint8_t indexMask{0x3};
+  static constexpr std::uint8_t publishedBit{0x4};
+
+  std::array<T, 3> m_buffers{};
+
+  // The indices are in separate cache lines so that the writer and the
+  // reader do not invalidate each other's line when they touch their own
+  alignas(64) std::uint8_t m_back{2};
+  alignas(64) std::atomic<std::uint8_t> m_middle{1};
+  alignas(64) std::uint8_t m_front{0};
+};
+
+/**
+ * @brief Makes the back buffer the latest value, and takes the old middle
+ * buffer as the new back buffer.
+ *
+ * Called by the writer only.
+ */
+template <typename T>
+void abcg::TripleBuffer<T>::publish() noexcept {
+  // Release makes the writes to the back buffer visible to the reader, and
+  // acquire waits for the reader to finish with the buffer that it returned
+  m_back = m_middle.exchange(m_back | publishedBit, std::memory_order_acq_rel) &
+           indexMask;
+}
+
+/**
+ * @brief Takes the latest published value, if any.
+ *
+ * Called by the reader only. References returned by
+ * abcg::TripleBuffer::getReadBuffer are invalidated if this returns true.
+ *
+ * @return Whether a value was published since the last update.
+ */
+template <typename T>
+bool abcg::TripleBuffer<T>::update() noexcept {
+  if ((m_middle.load(std::memory_order_relaxed) & publishedBit) == 0) {
+    return false;
+  }
+  m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & indexMask;
+  return true;
+}
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ * @file abcg_uniformblock.hpp
+ * @brief abcg::UniformBlock header file.
+ *
+ * Declaration and definition of abcg::UniformBlock class template.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_UNIFORMBLOCK_HPP_
+#define ABCG_UNIFORMBLOCK_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <type_traits>
+
+#include "abcg_external.hpp"
+#include "abcg_openglfunctions.hpp"
+
+namespace abcg {
+template <typename T>
+class UniformBlock;
+}  // namespace abcg
+
+/**
+ * @brief abcg::UniformBlock class template.
+ *
+ * Uniform buffer object holding a block of type `T`, which must match the
+ * std140 layout of the block declared in the shaders.
+ *
+ * The buffer is divided into a ring of slots. Each call to
+ * abcg::UniformBlock::update writes the next slot and binds it to the binding
+ * point of the block, so the data of previous frames that may still be read
+ * by the GPU is never overwritten.
+ *
+ * Every program linked to the block with abcg::UniformBlock::bindProgram
+ * reads the same data, so the block is uploaded once per frame regardless of
+ * the number of programs that use it.
+ *
+ * @tparam T Trivially copyable type with the std140 layout of the block.
+ */
+template <typename T>
+class abcg::UniformBlock {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Uniform block type must be trivially copyable");
+
+ public:
+  void create(GLuint bindingPoint, std::size_t numSlots = 3);
+  void destroy();
+
+  void bindProgram(GLuint program, std::string_view blockName) const;
+  void update(const T& data);
+
+  [[nodiscard]] GLuint getBindingPoint() const noexcept {
+    return m_bindingPoint;
+  }
+
+ private:
+  GLuint m_buffer{};
+  GLuint m_bindingPoint{};
+  std::size_t m_numSlots{};
+  std::size_t m_slotSize{};
+  std::size_t m_slot{};
+};
+
+/**
+ * @brief Creates the uniform buffer.
+ *
+ * @param bindingPoint Uniform buffer binding point of the block.
+ * @param numSlots Number of slots of the ring, i.e., number of frames whose
+ * data can be in flight.
+ */
+template <typename T>
+void abcg::UniformBlock<T>::create(GLuint bindingPoint, std::size_t numSlots) {
+  destroy();
+
+  // Each slot starts at a multiple of the uniform buffer offset alignment
+  GLint alignment{};
+  glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+  const auto offsetAlignment{static_cast<std::size_t>(std::max(alignment, 1))};
+
+  m_bindingPoint = bindingPoint;
+  m_numSlots = std::max<std::size_t>(numSlots, 1);
+  m_slotSize =
+      (sizeof(T) + offsetAlignment - 1) / offsetAlignment * offsetAlignment;
+  m_slot = 0;
+
+  glGenBuffers(1, &m_buffer);
+  glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+  glBufferData(GL_UNIFORM_BUFFER,
+               static_cast<GLsizeiptr>(m_slotSize * m_numSlots), nullptr,
+               GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+/**
+ * @brief Deletes the uniform buffer.
+ */
+template <typename T>
+void abcg::UniformBlock<T>::destroy() {
+  glDeleteBuffers(1, &m_buffer);
+  m_buffer = 0;
+}
+
+/**
+ * @brief Makes a program read the named uniform block from this buffer.
+ *
+ * Programs that do not declare the block (or where it was optimized out) are
+ * ignored.
+ *
+ * @param program ID of the program object.
+ * @param blockName Name of the uniform block in the shaders.
+ */
+template <typename T>
+void abcg::UniformBlock<T>::bindProgram(GLuint program,
+                                        std::string_view blockName) const {
+  const auto blockIndex{glGetUniformBlockIndex(program, blockName.data())};
+  if (blockIndex != GL_INVALID_INDEX) {
+    glUniformBlockBinding(program, blockIndex, m_bindingPoint);
+  }
+}
+
+/**
+ * @brief Uploads new block data to the next slot of the ring and binds it.
+ *
+ * @param data Block data.
+ */
+template <typename T>
+void abcg::UniformBlock<T>::update(const T& data) {
+  m_slot = (m_slot + 1) % m_numSlots;
+  const auto offset{static_cast<GLintptr>(m_slot * m_slotSize)};
+
+  glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+  // Passed as void pointer so that argument-dependent lookup does not find
+  // the unchecked OpenGL function
+  const void* source{&data};
+  glBufferSubData(GL_UNIFORM_BUFFER, offset, sizeof(T), source);
+  glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+  glBindBufferRange(GL_UNIFORM_BUFFER, m_bindingPoint, m_buffer, offset,
+                    sizeof(T));
+}
+
+#endif
@@ -0,0 +1,255 @@
+/**
+ * @file abcg_vertexdedup.hpp
+ * @brief abcg::VertexDedup header file.
+ *
+ * Declaration and definition of abcg::VertexDedup class template.
+ *
+ * This project is released under the MIT License.
+ */
+
+#ifndef ABCG_VERTEXDEDUP_HPP_
+#define ABCG_VERTEXDEDUP_HPP_
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "abcg_external.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace abcg {
+template <typename T>
+class VertexDedup;
+}  // namespace abcg
+
+/**
+ * @brief abcg::VertexDedup class template.
+ *
+ * Builds an indexed vertex array from a stream of possibly repeated
+ * vertices, such as the face corners of an OBJ file.
+ *
+ * Vertices are compared by their exact bytes and stored in an open-addressing
+ * hash table. The table is split into groups of 16 slots, each with 16
+ * control bytes that hold 7 bits of the hash of the vertex in the slot (or
+ * mark the slot as empty). A lookup compares the control bytes of a whole
+ * group at once with SSE2 or NEON, and only compares the vertices of the
+ * slots whose control bytes match.
+ *
+ * @tparam T Trivially copyable vertex type without padding bytes.
+ */
+template <typename T>
+class abcg::VertexDedup {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Vertex type must be trivially copyable");
+
+ public:
+  explicit VertexDedup(std::size_t expectedCount = 0) {
+    reserve(expectedCount);
+  }
+
+  void clear();
+  void reserve(std::size_t count);
+  GLuint insert(const T& vertex);
+
+  [[nodiscard]] const std::vector<T>& getVertices() const noexcept {
+    return m_vertices;
+  }
+  [[nodiscard]] std::vector<T> takeVertices();
+  [[nodiscard]] std::size_t size() const noexcept { return m_vertices.size(); }
+
+ private:
+  static constexpr std::size_t groupSize{16};
+  static constexpr std::int8_t empty{-128};
+
+  // Control bytes and vertex indices of the slots
+  std::vector<std::int8_t> m_control;
+  std::vector<GLuint> m_slots;
+  std::size_t m_groupMask{};
+
+  std::vector<T> m_vertices;
+
+  [[nodiscard]] static std::uint64_t hash(const T& vertex) noexcept;
+  [[nodiscard]] static std::uint32_t match(const std::int8_t* group,
+                                           std::int8_t value) noexcept;
+  void rehash(std::size_t numGroups);
+  void place(std::uint64_t hash, GLuint index);
+};
+
+/**
+ * @brief Removes all vertices, keeping the allocated memory.
+ */
+template <typename T>
+void abcg::VertexDedup<T>::clear() {
+  std::fill(m_control.begin(), m_control.end(), empty);
+  m_vertices.clear();
+}
+
+/**
+ * @brief Allocates the hash table for a number of unique vertices.
+ *
+ * When the number of unique vertices is not known, the number of vertices
+ * that will be inserted (e.g., three times the number of triangles) is a
+ * safe upper bound. This only sizes the table, which takes 5 bytes per slot;
+ * the array of unique vertices grows as vertices are added, as it is usually
+ * much smaller than the upper bound.
+ *
+ * @param count Number of unique vertices.
+ */
+template <typename T>
+void abcg::VertexDedup<T>::reserve(std::size_t count) {
+  // At most 7/8 of the slots are used
+  const auto numSlots{count + count / 7};
+  const auto numGroups{
+      std::bit_ceil(std::max<std::size_t>(1, (numSlots + groupSize - 1) /
+                                                 groupSize))};
+  if (numGroups > m_groupMask + 1 || m_control.empty()) rehash(numGroups);
+}
+
+/**
+ * @brief Returns the index of a vertex, adding it if it is new.
+ *
+ * @param vertex Vertex to look up.
+ *
+ * @return Index of the vertex in the array of unique vertices.
+ */
+template <typename T>
+GLuint abcg::VertexDedup<T>::insert(const T& vertex) {
+  const auto h{hash(vertex)};
+  const auto tag{static_cast<std::int8_t>(h & 0x7F)};
+
+  auto group{(h >> 7) & m_groupMask};
+  for (std::size_t step{1};; ++step) {
+    const auto* control{m_control.data() + group * groupSize};
+
+    for (auto candidates{match(control, tag)}; candidates != 0;
+         candidates &= candidates - 1) {
+      const auto index{m_slots[group * groupSize +
+                               static_cast<std::size_t>(
+                                   std::countr_zero(candidates))]};
+      if (std::memcmp(&m_vertices[index], &vertex, sizeof(T)) == 0) {
+        return index;
+      }
+    }
+
+    // Vertices are never removed, so an empty slot ends the probe sequence
+    if (match(control, empty) != 0) break;
+    group = (group + step) & m_groupMask;
+  }
+
+  const auto index{static_cast<GLuint>(m_vertices.size())};
+  m_vertices.push_back(vertex);
+  const auto numGroups{m_groupMask + 1};
+  if (m_vertices.size() * 8 > numGroups * groupSize * 7) {
+    rehash(numGroups * 2);
+  } else {
+    place(h, index);
+  }
+  return index;
+}
+
+/**
+ * @brief Moves the array of unique vertices out of the table and clears it.
+ *
+ * @return Unique vertices, in order of insertion.
+ */
+template <typename T>
+std::vector<T> abcg::VertexDedup<T>::takeVertices() {
+  auto vertices{std::move(m_vertices)};
+  m_vertices = {};
+  std::fill(m_control.begin(), m_control.end(), empty);
+  return vertices;
+}
+
+// 64-bit hash of the bytes of the vertex, mixing 8 bytes at a time with the
+// finalizer of MurmurHash3
+template <typename T>
+std::uint64_t abcg::VertexDedup<T>::hash(const T& vertex) noexcept {
+  const auto mix{[](std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+    return h;
+  }};
+
+  const auto* bytes{reinterpret_cast<const unsigned char*>(&vertex)};
+  std::uint64_t h{sizeof(T)};
+  std::size_t offset{};
+  for (; offset + 8 <= sizeof(T); offset += 8) {
+    std::uint64_t word{};
+    std::memcpy(&word, bytes + offset, 8);
+    h = mix(h ^ word) + 0x9E3779B97F4A7C15ULL;
+  }
+  if (offset < sizeof(T)) {
+    std::uint64_t word{};
+    std::memcpy(&word, bytes + offset, sizeof(T) - offset);
+    h = mix(h ^ word) + 0x9E3779B97F4A7C15ULL;
+  }
+  return mix(h);
+}
+
+// Bit mask of the control bytes of a group that are equal to the given value
+template <typename T>
+std::uint32_t abcg::VertexDedup<T>::match(const std::int8_t* group,
+                                          std::int8_t value) noexcept {
+#if defined(__SSE2__) || defined(_M_X64)
+  const auto control{
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(group))};
+  return static_cast<std::uint32_t>(
+      _mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(value))));
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  static constexpr std::array<std::uint8_t, 16> bits{
+      1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+  const auto equal{vandq_u8(vceqq_s8(vld1q_s8(group), vdupq_n_s8(value)),
+                            vld1q_u8(bits.data()))};
+  return static_cast<std::uint32_t>(vaddv_u8(vget_low_u8(equal))) |
+         static_cast<std::uint32_t>(vaddv_u8(vget_high_u8(equal))) << 8;
+#else
+  std::uint32_t mask{};
+  for (std::size_t slot{}; slot < groupSize; ++slot) {
+    mask |= static_cast<std::uint32_t>(group[slot] == value) << slot;
+  }
+  return mask;
+#endif
+}
+
+template <typename T>
+void abcg::VertexDedup<T>::rehash(std::size_t numGroups) {
+  m_groupMask = numGroups - 1;
+  m_control.assign(numGroups * groupSize, empty);
+  m_slots.resize(numGroups * groupSize);
+  for (std::size_t index{}; index < m_vertices.size(); ++index) {
+    place(hash(m_vertices[index]), static_cast<GLuint>(index));
+  }
+}
+
+// Stores an index in the first empty slot of the probe sequence of a hash
+template <typename T>
+void abcg::VertexDedup<T>::place(std::uint64_t hash, GLuint index) {
+  auto group{(hash >> 7) & m_groupMask};
+  for (std::size_t step{1};; ++step) {
+    if (const auto free{match(m_control.data() + group * groupSize, empty)};
+        free != 0) {
+      const auto slot{group * groupSize +
+                      static_cast<std::size_t>(std::countr_zero(free))};
+      m_control[slot] = static_cast<std::int8_t>(hash & 0x7F);
+      m_slots[slot] = index;
+      return;
+    }
+    group = (group + step) & m_groupMask;
+  }
+}
+
+#endif
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cppitertools/itertools.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmarks.hpp"
+
+namespace {
+struct Vertex {
+  glm::vec3 position{};
+  glm::vec3 normal{};
+  glm::vec2 texCoord{};
+};
+
+// CPU data of a model, and a copy that stands for its GPU buffers
+struct Model {
+  std::vector<Vertex> vertices;
+  std::vector<GLuint> indices;
+  std::vector<std::byte> buffer;
+};
+
+// Parses an OBJ file and builds the indexed vertex array. Returns the number
+// of bytes to upload
+std::size_t loadModel(const std::string& path, Model& model) {
+  abcg::ObjFile objFile;
+  objFile.load(path);
+
+  const auto& corners{objFile.getCorners()};
+  abcg::VertexDedup<Vertex> vertexDedup{corners.size()};
+  model.indices.clear();
+  model.indices.reserve(corners.size());
+  for (const auto& corner : corners) {
+    Vertex vertex{};
+    vertex.position = objFile.getPositions()[corner.position];
+    vertex.normal = objFile.getNormals()[corner.normal];
+    vertex.texCoord = objFile.getTexCoords()[corner.texCoord];
+    model.indices.push_back(vertexDedup.insert(vertex));
+  }
+  model.vertices = vertexDedup.takeVertices();
+  return sizeof(Vertex) * model.vertices.size() +
+         sizeof(GLuint) * model.indices.size();
+}
+
+// Copies the vertices and indices, as glBufferData does with the data of a
+// buffer
+void uploadModel(Model& model) {
+  const auto vertexBytes{sizeof(Vertex) * model.vertices.size()};
+  const auto indexBytes{sizeof(GLuint) * model.indices.size()};
+  model.buffer.resize(vertexBytes + indexBytes);
+  std::memcpy(model.buffer.data(), model.vertices.data(), vertexBytes);
+  std::memcpy(model.buffer.data() + vertexBytes, model.indices.data(),
+              indexBytes);
+}
+}  // namespace
+
+// Time to first frame of a scene of four models of different sizes, loaded
+// before the first frame or by abcg::AssetManager while frames are drawn
+void benchmarkAssetManager() {
+  std::vector<std::string> paths;
+  for (const auto resolution : {700, 400, 150, 10}) {
+    paths.push_back((std::filesystem::temp_directory_path() /
+                     fmt::format("abcg_benchmark_{}.obj", resolution))
+                        .string());
+    std::ofstream{paths.back(), std::ios::binary} << createGridObj(resolution);
+  }
+  fmt::print("{} models, {} worker threads\n", paths.size(),
+             abcg::JobSystem::global().getNumWorkers());
+
+  // Synchronous loading: the first frame is drawn after all uploads
+  std::vector<Model> syncModels(paths.size());
+  abcg::ElapsedTimer syncTimer;
+  for (const auto index : iter::range(paths.size())) {
+    loadModel(paths.at(index), syncModels.at(index));
+    uploadModel(syncModels.at(index));
+  }
+  const auto syncTime{syncTimer.elapsed() * 1000.0};
+
+  // Asynchronous loading: frames are drawn while the models load. The frame
+  // time is the time spent in abcg::AssetManager::update
+  std::vector<Model> asyncModels(paths.size());
+  abcg::AssetManager assets;
+  for (const auto index : iter::range(paths.size())) {
+    auto& model{asyncModels.at(index)};
+    const auto& path{paths.at(index)};
+    assets.add([&model, &path] { return loadModel(path, model); },
+               [&model] { uploadModel(model); });
+  }
+
+  abcg::ElapsedTimer asyncTimer;
+  double firstFrameTime{};
+  double firstModelTime{};
+  double maxFrameTime{};
+  std::size_t numFrames{};
+  while (!assets.isDone()) {
+    abcg::ElapsedTimer frameTimer;
+    assets.update();
+    maxFrameTime = std::max(maxFrameTime, frameTimer.elapsed() * 1000.0);
+    if (++numFrames == 1) firstFrameTime = asyncTimer.elapsed() * 1000.0;
+    if (firstModelTime == 0.0 && assets.getProgress() > 0.0f) {
+      for (const auto handle : iter::range(paths.size())) {
+        if (assets.isReady(handle)) {
+          firstModelTime = asyncTimer.elapsed() * 1000.0;
+        }
+      }
+    }
+
+    // Time left of a 60 Hz frame
+    std::this_thread::sleep_for(std::chrono::milliseconds(16));
+  }
+  const auto asyncTime{asyncTimer.elapsed() * 1000.0};
+
+  for (const auto& path : paths) {
+    std::filesystem::remove(path);
+  }
+
+  auto sameModels{true};
+  for (const auto& [a, b] : iter::zip(syncModels, asyncModels)) {
+    sameModels = sameModels && a.buffer == b.buffer;
+  }
+
+  fmt::print("  synchronous:  first frame after {:.2f} ms\n", syncTime);
+  fmt::print("  AssetManager: first frame after {:.2f} ms, first model after "
+             "{:.2f} ms, all models after {:.2f} ms ({} frames, longest "
+             "update {:.2f} ms, {:.1f} MB uploaded)\n",
+             firstFrameTime, firstModelTime, asyncTime, numFrames,
+             maxFrameTime,
+             static_cast<double>(assets.getUploadedBytes()) / (1 << 20));
+  fmt::print("  same models: {}\n", sameModels);
+}
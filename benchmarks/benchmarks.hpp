@@ -0,0 +1,39 @@
+#ifndef BENCHMARKS_HPP_
+#define BENCHMARKS_HPP_
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "abcg.hpp"
+
+// Returns the best time, in milliseconds, of a few runs of a function
+template <typename Function>
+double measure(Function&& function, int runs = 5) {
+  auto best{std::numeric_limits<double>::max()};
+  for (auto run{0}; run < runs; ++run) {
+    abcg::ElapsedTimer timer;
+    function();
+    best = std::min(best, timer.elapsed() * 1000.0);
+  }
+  return best;
+}
+
+// Bytes allocated with operator new, and the peak since the last reset
+std::size_t getAllocatedBytes();
+std::size_t getPeakAllocatedBytes();
+void resetPeakAllocatedBytes();
+
+// OBJ text of a grid of resolution x resolution quads
+std::string createGridObj(int resolution);
+
+void benchmarkAssetManager();
+void benchmarkMeshNormals();
+void benchmarkObjFile();
+void benchmarkTransformBatch();
+void benchmarkVertexDedup();
+void benchmarkVertexPacking();
+
+#endif
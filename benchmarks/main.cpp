@@ -0,0 +1,42 @@
+#include <fmt/core.h>
+
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "benchmarks.hpp"
+
+struct Benchmark {
+  std::string_view name;
+  std::function<void()> function;
+};
+
+// Runs all benchmarks, or only the ones given as arguments
+int main(int argc, char** argv) {
+  const std::vector<Benchmark> benchmarks{
+      {"assetmanager", benchmarkAssetManager},
+      {"meshnormals", benchmarkMeshNormals},
+      {"objfile", benchmarkObjFile},
+      {"transformbatch", benchmarkTransformBatch},
+      {"vertexdedup", benchmarkVertexDedup},
+      {"vertexpacking", benchmarkVertexPacking},
+  };
+
+  try {
+    for (const auto& benchmark : benchmarks) {
+      auto selected{argc <= 1};
+      for (auto i{1}; i < argc; ++i) {
+        selected = selected || benchmark.name == argv[i];
+      }
+      if (!selected) continue;
+
+      fmt::print("== {}\n", benchmark.name);
+      benchmark.function();
+      fmt::print("\n");
+    }
+  } catch (abcg::Exception& exception) {
+    fmt::print(stderr, "{}\n", exception.what());
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,52 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "benchmarks.hpp"
+
+// Replacements of the global allocation functions that keep track of the
+// number of allocated bytes. Each block starts with a header with its size
+namespace {
+constexpr std::size_t headerSize{alignof(std::max_align_t)};
+
+std::atomic<std::size_t> allocatedBytes{};
+std::atomic<std::size_t> peakAllocatedBytes{};
+
+void* allocate(std::size_t size) {
+  auto* block{static_cast<std::byte*>(std::malloc(size + headerSize))};
+  if (block == nullptr) throw std::bad_alloc{};
+  *reinterpret_cast<std::size_t*>(block) = size;
+
+  const auto current{allocatedBytes.fetch_add(size) + size};
+  auto peak{peakAllocatedBytes.load()};
+  while (current > peak &&
+         !peakAllocatedBytes.compare_exchange_weak(peak, current)) {
+  }
+  return block + headerSize;
+}
+
+void deallocate(void* pointer) noexcept {
+  if (pointer == nullptr) return;
+  auto* block{static_cast<std::byte*>(pointer) - headerSize};
+  allocatedBytes.fetch_sub(*reinterpret_cast<std::size_t*>(block));
+  std::free(block);
+}
+}  // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void operator delete(void* pointer) noexcept { deallocate(pointer); }
+void operator delete[](void* pointer) noexcept { deallocate(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept {
+  deallocate(pointer);
+}
+void operator delete[](void* pointer, std::size_t) noexcept {
+  deallocate(pointer);
+}
+
+void resetPeakAllocatedBytes() {
+  peakAllocatedBytes.store(allocatedBytes.load());
+}
+
+std::size_t getPeakAllocatedBytes() { return peakAllocatedBytes.load(); }
+std::size_t getAllocatedBytes() { return allocatedBytes.load(); }
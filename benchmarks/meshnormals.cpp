@@ -0,0 +1,194 @@
+#include <cppitertools/itertools.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/mat2x2.hpp>
+#include <vector>
+
+#include "benchmarks.hpp"
+
+namespace {
+// Same layout as examples/maze3d
+struct Vertex {
+  glm::vec3 position{};
+  glm::vec3 normal{};
+  glm::vec2 texCoord{};
+  glm::vec4 tangent{};
+};
+
+struct Mesh {
+  std::vector<Vertex> vertices;
+  std::vector<GLuint> indices;
+};
+
+// Wavy grid of resolution x resolution quads (two triangles each)
+Mesh createGrid(int resolution) {
+  Mesh mesh;
+  mesh.vertices.reserve((resolution + 1) * (resolution + 1));
+  for (const auto i : iter::range(resolution + 1)) {
+    for (const auto j : iter::range(resolution + 1)) {
+      const glm::vec2 uv{static_cast<float>(j) / resolution,
+                         static_cast<float>(i) / resolution};
+      Vertex vertex{};
+      vertex.position = {uv.x * 2.0f - 1.0f,
+                         0.1f * std::sin(uv.x * 40.0f) * std::cos(uv.y * 30.0f),
+                         uv.y * 2.0f - 1.0f};
+      vertex.texCoord = uv;
+      mesh.vertices.push_back(vertex);
+    }
+  }
+
+  mesh.indices.reserve(resolution * resolution * 6);
+  const auto stride{static_cast<GLuint>(resolution + 1)};
+  for (const auto i : iter::range<GLuint>(resolution)) {
+    for (const auto j : iter::range<GLuint>(resolution)) {
+      const auto v0{i * stride + j};
+      mesh.indices.insert(mesh.indices.end(), {v0, v0 + stride, v0 + 1, v0 + 1,
+                                               v0 + stride, v0 + stride + 1});
+    }
+  }
+  return mesh;
+}
+
+// Serial scatter-add versions of examples/maze3d before abcg::mesh
+void computeNormalsSerial(Mesh& mesh) {
+  for (auto& vertex : mesh.vertices) {
+    vertex.normal = glm::zero<glm::vec3>();
+  }
+
+  for (const auto offset : iter::range<int>(0, mesh.indices.size(), 3)) {
+    Vertex& a{mesh.vertices.at(mesh.indices.at(offset + 0))};
+    Vertex& b{mesh.vertices.at(mesh.indices.at(offset + 1))};
+    Vertex& c{mesh.vertices.at(mesh.indices.at(offset + 2))};
+
+    const auto edge1{b.position - a.position};
+    const auto edge2{c.position - b.position};
+    glm::vec3 normal{glm::cross(edge1, edge2)};
+
+    a.normal += normal;
+    b.normal += normal;
+    c.normal += normal;
+  }
+
+  for (auto& vertex : mesh.vertices) {
+    vertex.normal = glm::normalize(vertex.normal);
+  }
+}
+
+void computeTangentsSerial(Mesh& mesh) {
+  std::vector<glm::vec3> bitangents(mesh.vertices.size(), glm::vec3(0));
+
+  for (const auto offset : iter::range<int>(0, mesh.indices.size(), 3)) {
+    const auto i1{mesh.indices.at(offset + 0)};
+    const auto i2{mesh.indices.at(offset + 1)};
+    const auto i3{mesh.indices.at(offset + 2)};
+
+    Vertex& v1{mesh.vertices.at(i1)};
+    Vertex& v2{mesh.vertices.at(i2)};
+    Vertex& v3{mesh.vertices.at(i3)};
+
+    const auto e1{v2.position - v1.position};
+    const auto e2{v3.position - v1.position};
+    const auto delta1{v2.texCoord - v1.texCoord};
+    const auto delta2{v3.texCoord - v1.texCoord};
+
+    // clang-format off
+    glm::mat2 M;
+    M[0][0] =  delta2.t;
+    M[0][1] = -delta1.t;
+    M[1][0] = -delta2.s;
+    M[1][1] =  delta1.s;
+    M *= (1.0f / (delta1.s * delta2.t - delta2.s * delta1.t));
+
+    auto tangent{glm::vec4(M[0][0] * e1.x + M[0][1] * e2.x,
+                           M[0][0] * e1.y + M[0][1] * e2.y,
+                           M[0][0] * e1.z + M[0][1] * e2.z, 0.0f)};
+
+    auto bitangent{glm::vec3(M[1][0] * e1.x + M[1][1] * e2.x,
+                             M[1][0] * e1.y + M[1][1] * e2.y,
+                             M[1][0] * e1.z + M[1][1] * e2.z)};
+    // clang-format on
+
+    v1.tangent += tangent;
+    v2.tangent += tangent;
+    v3.tangent += tangent;
+
+    bitangents.at(i1) += bitangent;
+    bitangents.at(i2) += bitangent;
+    bitangents.at(i3) += bitangent;
+  }
+
+  for (auto&& [i, vertex] : iter::enumerate(mesh.vertices)) {
+    const auto& n{vertex.normal};
+    const auto& t{glm::vec3(vertex.tangent)};
+
+    const auto tangent = t - n * glm::dot(n, t);
+    vertex.tangent = glm::vec4(glm::normalize(tangent), 0);
+
+    const auto b{glm::cross(n, t)};
+    const auto handedness{glm::dot(b, bitangents.at(i))};
+    vertex.tangent.w = (handedness < 0.0f) ? -1.0f : 1.0f;
+  }
+}
+}  // namespace
+
+void benchmarkMeshNormals() {
+  const auto mesh{createGrid(1500)};
+  const auto numVertices{mesh.vertices.size()};
+  fmt::print("{} vertices, {} triangles, {} worker threads\n", numVertices,
+             mesh.indices.size() / 3,
+             abcg::JobSystem::global().getNumWorkers());
+
+  // Serial
+  auto serial{mesh};
+  const auto serialNormalTime{
+      measure([&] { computeNormalsSerial(serial); }, 3)};
+  const auto serialTangentTime{measure(
+      [&] {
+        for (auto& vertex : serial.vertices) vertex.tangent = {};
+        computeTangentsSerial(serial);
+      },
+      3)};
+
+  // Parallel
+  std::vector<glm::vec3> positions(numVertices);
+  std::vector<glm::vec2> texCoords(numVertices);
+  for (const auto i : iter::range(numVertices)) {
+    positions[i] = mesh.vertices[i].position;
+    texCoords[i] = mesh.vertices[i].texCoord;
+  }
+  abcg::mesh::VertexFaces vertexFaces;
+  std::vector<glm::vec3> normals;
+  std::vector<glm::vec4> tangents;
+  const auto adjacencyTime{measure(
+      [&] {
+        vertexFaces = abcg::mesh::buildVertexFaces(numVertices, mesh.indices);
+      },
+      3)};
+  const auto normalTime{measure(
+      [&] {
+        normals =
+            abcg::mesh::computeNormals(positions, mesh.indices, vertexFaces);
+      },
+      3)};
+  const auto tangentTime{measure(
+      [&] {
+        tangents = abcg::mesh::computeTangents(positions, normals, texCoords,
+                                               mesh.indices, vertexFaces);
+      },
+      3)};
+
+  // Both versions sum in triangle order, so the results should be identical
+  std::size_t normalMismatches{};
+  std::size_t tangentMismatches{};
+  for (const auto i : iter::range(numVertices)) {
+    normalMismatches += serial.vertices[i].normal != normals[i] ? 1 : 0;
+    tangentMismatches += serial.vertices[i].tangent != tangents[i] ? 1 : 0;
+  }
+
+  fmt::print("  serial:   {:.2f} ms (normals), {:.2f} ms (tangents)\n",
+             serialNormalTime, serialTangentTime);
+  fmt::print("  parallel: {:.2f} ms (normals), {:.2f} ms (tangents), "
+             "{:.2f} ms (adjacency, shared)\n",
+             normalTime, tangentTime, adjacencyTime);
+  fmt::print("  mismatches: {} normals, {} tangents\n", normalMismatches,
+             tangentMismatches);
+}
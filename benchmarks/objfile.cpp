@@ -0,0 +1,152 @@
+#include <tiny_obj_loader.h>
+
+#include <cppitertools/itertools.hpp>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+#include "benchmarks.hpp"
+
+namespace {
+// Same layout as examples/maze3d
+struct Vertex {
+  glm::vec3 position{};
+  glm::vec3 normal{};
+  glm::vec2 texCoord{};
+  glm::vec4 tangent{};
+};
+
+struct Mesh {
+  std::vector<Vertex> vertices;
+  std::vector<GLuint> indices;
+};
+
+void parseTinyObj(const std::string& path, tinyobj::ObjReader& reader) {
+  if (!reader.ParseFromFile(path)) {
+    throw abcg::Exception{abcg::Exception::Runtime(
+        fmt::format("Failed to load model {} ({})", path, reader.Error()))};
+  }
+}
+
+// tinyobj::ObjReader followed by the copy into vertices of examples/maze3d
+void loadTinyObj(const std::string& path, Mesh& mesh) {
+  tinyobj::ObjReader reader;
+  parseTinyObj(path, reader);
+  const auto& attrib{reader.GetAttrib()};
+
+  std::size_t numCorners{};
+  for (const auto& shape : reader.GetShapes()) {
+    numCorners += shape.mesh.indices.size();
+  }
+
+  abcg::VertexDedup<Vertex> vertexDedup{numCorners};
+  mesh.indices.clear();
+  mesh.indices.reserve(numCorners);
+  for (const auto& shape : reader.GetShapes()) {
+    for (const auto& index : shape.mesh.indices) {
+      Vertex vertex{};
+      const auto vi{static_cast<std::size_t>(3 * index.vertex_index)};
+      vertex.position = {attrib.vertices[vi + 0], attrib.vertices[vi + 1],
+                         attrib.vertices[vi + 2]};
+      if (index.normal_index >= 0) {
+        const auto ni{static_cast<std::size_t>(3 * index.normal_index)};
+        vertex.normal = {attrib.normals[ni + 0], attrib.normals[ni + 1],
+                         attrib.normals[ni + 2]};
+      }
+      if (index.texcoord_index >= 0) {
+        const auto ti{static_cast<std::size_t>(2 * index.texcoord_index)};
+        vertex.texCoord = {attrib.texcoords[ti + 0],
+                           attrib.texcoords[ti + 1]};
+      }
+      mesh.indices.push_back(vertexDedup.insert(vertex));
+    }
+  }
+  mesh.vertices = vertexDedup.takeVertices();
+}
+
+// abcg::ObjFile followed by the same copy
+void loadObjFile(const std::string& path, Mesh& mesh) {
+  abcg::ObjFile objFile;
+  objFile.load(path);
+
+  const auto& positions{objFile.getPositions()};
+  const auto& normals{objFile.getNormals()};
+  const auto& texCoords{objFile.getTexCoords()};
+  const auto& corners{objFile.getCorners()};
+
+  abcg::VertexDedup<Vertex> vertexDedup{corners.size()};
+  mesh.indices.clear();
+  mesh.indices.reserve(corners.size());
+  for (const auto& corner : corners) {
+    Vertex vertex{};
+    vertex.position = positions[corner.position];
+    if (corner.normal >= 0) vertex.normal = normals[corner.normal];
+    if (corner.texCoord >= 0) vertex.texCoord = texCoords[corner.texCoord];
+    mesh.indices.push_back(vertexDedup.insert(vertex));
+  }
+  mesh.vertices = vertexDedup.takeVertices();
+}
+
+// Time, in milliseconds, and peak of allocated memory, in MB, of a function
+template <typename Function>
+std::pair<double, double> measureWithMemory(Function&& function) {
+  const auto baseBytes{getAllocatedBytes()};
+  resetPeakAllocatedBytes();
+  const auto time{measure(function, 3)};
+  const auto peakBytes{getPeakAllocatedBytes() - baseBytes};
+  return {time, static_cast<double>(peakBytes) / (1 << 20)};
+}
+}  // namespace
+
+void benchmarkObjFile() {
+  const auto path{
+      (std::filesystem::temp_directory_path() / "abcg_benchmark.obj").string()};
+  std::ofstream{path, std::ios::binary} << createGridObj(1000);
+  const auto fileSize{std::filesystem::file_size(path)};
+  fmt::print("{:.1f} MB of OBJ text, {} worker threads\n",
+             static_cast<double>(fileSize) / (1 << 20),
+             abcg::JobSystem::global().getNumWorkers());
+
+  const auto [tinyObjParseTime, tinyObjParseMemory]{measureWithMemory([&] {
+    tinyobj::ObjReader reader;
+    parseTinyObj(path, reader);
+  })};
+  const auto [objFileParseTime, objFileParseMemory]{measureWithMemory([&] {
+    abcg::ObjFile objFile;
+    objFile.load(path);
+  })};
+
+  Mesh tinyObjMesh;
+  Mesh objFileMesh;
+  const auto [tinyObjTime, tinyObjMemory]{
+      measureWithMemory([&] { loadTinyObj(path, tinyObjMesh); })};
+  const auto [objFileTime, objFileMemory]{
+      measureWithMemory([&] { loadObjFile(path, objFileMesh); })};
+  std::filesystem::remove(path);
+
+  // tinyobj rounds some decimal numbers differently, so positions are
+  // compared with a tolerance
+  auto sameMesh{tinyObjMesh.indices == objFileMesh.indices &&
+                tinyObjMesh.vertices.size() == objFileMesh.vertices.size()};
+  float maxError{};
+  for (const auto& [a, b] :
+       iter::zip(tinyObjMesh.vertices, objFileMesh.vertices)) {
+    const auto difference{glm::abs(a.position - b.position)};
+    maxError = std::max({maxError, difference.x, difference.y, difference.z});
+    sameMesh = sameMesh && a.normal == b.normal;
+  }
+
+  fmt::print("{} vertices, {} triangles\n", objFileMesh.vertices.size(),
+             objFileMesh.indices.size() / 3);
+  fmt::print("  parse:          tinyobj {:.2f} ms, {:.1f} MB peak; ObjFile "
+             "{:.2f} ms, {:.1f} MB peak ({:.2f}x faster)\n",
+             tinyObjParseTime, tinyObjParseMemory, objFileParseTime,
+             objFileParseMemory, tinyObjParseTime / objFileParseTime);
+  fmt::print("  parse + dedup:  tinyobj {:.2f} ms, {:.1f} MB peak; ObjFile "
+             "{:.2f} ms, {:.1f} MB peak ({:.2f}x faster)\n",
+             tinyObjTime, tinyObjMemory, objFileTime, objFileMemory,
+             tinyObjTime / objFileTime);
+  fmt::print("  same mesh: {}, max position difference: {:.2e}\n", sameMesh,
+             maxError);
+}
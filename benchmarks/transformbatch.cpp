@@ -0,0 +1,113 @@
+#include <cppitertools/itertools.hpp>
+#include <glm/gtc/matrix_inverse.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+#include <vector>
+
+#include "benchmarks.hpp"
+
+namespace {
+struct Object {
+  glm::vec3 translation{};
+  float scale{1.0f};
+  glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+};
+
+// Randomly placed, scaled and rotated objects, as in examples/starfield
+std::vector<Object> createObjects(std::size_t count) {
+  std::default_random_engine randomEngine{42};
+  std::uniform_real_distribution<float> distPos(-20.0f, 20.0f);
+  std::uniform_real_distribution<float> distScale(0.1f, 2.0f);
+  std::uniform_real_distribution<float> distAngle(0.0f, 6.28f);
+  std::uniform_real_distribution<float> distAxis(-1.0f, 1.0f);
+
+  std::vector<Object> objects(count);
+  for (auto& object : objects) {
+    object.translation = {distPos(randomEngine), distPos(randomEngine),
+                          distPos(randomEngine)};
+    object.scale = distScale(randomEngine);
+    const glm::vec3 axis{distAxis(randomEngine), distAxis(randomEngine),
+                         distAxis(randomEngine)};
+    object.rotation = glm::angleAxis(distAngle(randomEngine),
+                                     glm::normalize(axis + glm::vec3(1e-3f)));
+  }
+  return objects;
+}
+
+// Per-object path used by the examples
+void computeGLM(const std::vector<Object>& objects,
+                const glm::mat4& viewMatrix,
+                std::vector<abcg::InstanceTransform>& transforms) {
+  transforms.resize(objects.size());
+  for (const auto& [object, transform] : iter::zip(objects, transforms)) {
+    glm::mat4 modelMatrix{1.0f};
+    modelMatrix = glm::translate(modelMatrix, object.translation);
+    modelMatrix = glm::scale(modelMatrix, glm::vec3(object.scale));
+    modelMatrix = modelMatrix * glm::mat4_cast(object.rotation);
+
+    transform.modelMatrix = modelMatrix;
+    transform.modelViewMatrix = viewMatrix * modelMatrix;
+    const glm::mat3 normalMatrix{
+        glm::inverseTranspose(glm::mat3(transform.modelViewMatrix))};
+    for (const auto col : iter::range(3)) {
+      transform.normalMatrix.at(col) = glm::vec4(normalMatrix[col], 0.0f);
+    }
+  }
+}
+
+float maxError(const glm::mat4& a, const glm::mat4& b) {
+  float error{};
+  for (const auto col : iter::range(4)) {
+    for (const auto row : iter::range(4)) {
+      error = std::max(error, std::abs(a[col][row] - b[col][row]));
+    }
+  }
+  return error;
+}
+}  // namespace
+
+void benchmarkTransformBatch() {
+  const auto viewMatrix{glm::lookAt(glm::vec3(3.0f, 2.0f, 10.0f),
+                                    glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f))};
+
+  for (const std::size_t count : {500, 10'000, 1'000'000}) {
+    const auto objects{createObjects(count)};
+
+    abcg::TransformBatch batch;
+    batch.reserve(count);
+    for (const auto& object : objects) {
+      batch.push(object.translation, object.scale, object.rotation);
+    }
+
+    std::vector<abcg::InstanceTransform> reference;
+    std::vector<abcg::InstanceTransform> transforms;
+    const auto runs{count < 100'000 ? 50 : 5};
+    const auto glmTime{
+        measure([&] { computeGLM(objects, viewMatrix, reference); }, runs)};
+    const auto batchTime{
+        measure([&] { batch.compute(viewMatrix, transforms); }, runs)};
+
+    float modelError{};
+    float modelViewError{};
+    float normalError{};
+    for (const auto& [a, b] : iter::zip(reference, transforms)) {
+      modelError = std::max(modelError, maxError(a.modelMatrix, b.modelMatrix));
+      modelViewError = std::max(
+          modelViewError, maxError(a.modelViewMatrix, b.modelViewMatrix));
+      for (const auto col : iter::range(3)) {
+        const auto difference{
+            glm::abs(a.normalMatrix.at(col) - b.normalMatrix.at(col))};
+        normalError = std::max({normalError, difference.x, difference.y,
+                                difference.z, difference.w});
+      }
+    }
+
+    fmt::print("{} objects\n", count);
+    fmt::print("  glm:   {:.3f} ms\n", glmTime);
+    fmt::print("  batch: {:.3f} ms ({:.2f}x faster)\n", batchTime,
+               glmTime / batchTime);
+    fmt::print("  max error: {:.2e} (model), {:.2e} (model-view), {:.2e} "
+               "(normal)\n",
+               modelError, modelViewError, normalError);
+  }
+}
@@ -0,0 +1,154 @@
+#include <tiny_obj_loader.h>
+
+#include <cppitertools/itertools.hpp>
+#include <glm/gtc/epsilon.hpp>
+#include <glm/gtx/hash.hpp>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "benchmarks.hpp"
+
+namespace {
+// Same layout as examples/maze3d
+struct Vertex {
+  glm::vec3 position{};
+  glm::vec3 normal{};
+  glm::vec2 texCoord{};
+  glm::vec4 tangent{};
+};
+
+// Hash and comparison used by examples/maze3d before abcg::VertexDedup
+struct LegacyHash {
+  std::size_t operator()(const Vertex& vertex) const noexcept {
+    std::size_t h1{std::hash<glm::vec3>()(vertex.position)};
+    std::size_t h2{std::hash<glm::vec3>()(vertex.normal)};
+    std::size_t h3{std::hash<glm::vec2>()(vertex.texCoord)};
+    return h1 ^ h2 ^ h3;
+  }
+};
+
+struct LegacyEqual {
+  bool operator()(const Vertex& a, const Vertex& b) const noexcept {
+    static const auto epsilon{std::numeric_limits<float>::epsilon()};
+    return glm::all(glm::epsilonEqual(a.position, b.position, epsilon)) &&
+           glm::all(glm::epsilonEqual(a.normal, b.normal, epsilon)) &&
+           glm::all(glm::epsilonEqual(a.texCoord, b.texCoord, epsilon));
+  }
+};
+
+// Vertices of the face corners of all shapes, as read by examples/maze3d
+std::vector<Vertex> readCorners(const tinyobj::ObjReader& reader) {
+  const auto& attrib{reader.GetAttrib()};
+  std::vector<Vertex> corners;
+  for (const auto& shape : reader.GetShapes()) {
+    for (const auto& index : shape.mesh.indices) {
+      Vertex vertex{};
+      const auto vi{static_cast<std::size_t>(3 * index.vertex_index)};
+      vertex.position = {attrib.vertices[vi + 0], attrib.vertices[vi + 1],
+                         attrib.vertices[vi + 2]};
+      const auto ni{static_cast<std::size_t>(3 * index.normal_index)};
+      vertex.normal = {attrib.normals[ni + 0], attrib.normals[ni + 1],
+                       attrib.normals[ni + 2]};
+      const auto ti{static_cast<std::size_t>(2 * index.texcoord_index)};
+      vertex.texCoord = {attrib.texcoords[ti + 0], attrib.texcoords[ti + 1]};
+      corners.push_back(vertex);
+    }
+  }
+  return corners;
+}
+}  // namespace
+
+// OBJ text of a wavy grid of resolution x resolution quads with normals and
+// texture coordinates. Vertices are shared by up to six triangles
+std::string createGridObj(int resolution) {
+  std::string obj;
+  auto out{std::back_inserter(obj)};
+  for (const auto i : iter::range(resolution + 1)) {
+    for (const auto j : iter::range(resolution + 1)) {
+      const auto u{static_cast<float>(j) / resolution};
+      const auto v{static_cast<float>(i) / resolution};
+      // Adding zero avoids negative zeros, which are not merged with positive
+      // zeros by abcg::VertexDedup
+      const auto height{0.1f * std::sin(u * 40.0f) * std::cos(v * 30.0f) +
+                        0.0f};
+      fmt::format_to(out, "v {} {} {}\n", u * 2.0f - 1.0f, height,
+                     v * 2.0f - 1.0f);
+      fmt::format_to(out, "vn 0 1 0\n");
+      fmt::format_to(out, "vt {} {}\n", u, v);
+    }
+  }
+
+  const auto stride{resolution + 1};
+  for (const auto i : iter::range(resolution)) {
+    for (const auto j : iter::range(resolution)) {
+      // OBJ indices start at 1
+      const auto v0{i * stride + j + 1};
+      fmt::format_to(out, "f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", v0,
+                     v0 + stride, v0 + 1);
+      fmt::format_to(out, "f {0}/{0}/{0} {1}/{1}/{1} {2}/{2}/{2}\n", v0 + 1,
+                     v0 + stride, v0 + stride + 1);
+    }
+  }
+  return obj;
+}
+
+void benchmarkVertexDedup() {
+  for (const auto resolution : {100, 700}) {
+    const auto obj{createGridObj(resolution)};
+
+    tinyobj::ObjReader reader;
+    const auto parseTime{measure(
+        [&] {
+          if (!reader.ParseFromString(obj, "")) {
+            throw abcg::Exception{abcg::Exception::Runtime(
+                fmt::format("Failed to parse OBJ ({})", reader.Error()))};
+          }
+        },
+        1)};
+    const auto corners{readCorners(reader)};
+
+    // Lookup with count followed by operator[], as in the examples
+    std::vector<Vertex> mapVertices;
+    std::vector<GLuint> mapIndices;
+    const auto mapTime{measure(
+        [&] {
+          mapVertices.clear();
+          mapIndices.clear();
+          std::unordered_map<Vertex, GLuint, LegacyHash, LegacyEqual> hash{};
+          for (const auto& vertex : corners) {
+            if (hash.count(vertex) == 0) {
+              hash[vertex] = mapVertices.size();
+              mapVertices.push_back(vertex);
+            }
+            mapIndices.push_back(hash[vertex]);
+          }
+        },
+        3)};
+
+    std::vector<Vertex> dedupVertices;
+    std::vector<GLuint> dedupIndices;
+    const auto dedupTime{measure(
+        [&] {
+          dedupIndices.clear();
+          abcg::VertexDedup<Vertex> vertexDedup{corners.size()};
+          for (const auto& vertex : corners) {
+            dedupIndices.push_back(vertexDedup.insert(vertex));
+          }
+          dedupVertices = vertexDedup.takeVertices();
+        },
+        3)};
+
+    fmt::print("{} corners, {} unique vertices, {:.1f} MB of OBJ text\n",
+               corners.size(), dedupVertices.size(),
+               static_cast<double>(obj.size()) / (1 << 20));
+    fmt::print("  parse:          {:.2f} ms\n", parseTime);
+    fmt::print("  unordered_map:  {:.2f} ms\n", mapTime);
+    fmt::print("  VertexDedup:    {:.2f} ms ({:.2f}x faster)\n", dedupTime,
+               mapTime / dedupTime);
+    fmt::print("  same result: {}\n", mapVertices.size() ==
+                                          dedupVertices.size() &&
+                                          mapIndices == dedupIndices);
+  }
+}
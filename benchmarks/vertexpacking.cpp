@@ -0,0 +1,129 @@
+#include <array>
+#include <cppitertools/itertools.hpp>
+#include <cstdint>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+#include <vector>
+
+#include "benchmarks.hpp"
+#include "vertex.hpp"
+
+namespace {
+// Unit sphere with (resolution + 1)^2 vertices
+std::vector<Vertex> createSphere(int resolution) {
+  std::vector<Vertex> vertices;
+  vertices.reserve((resolution + 1) * (resolution + 1));
+  for (const auto i : iter::range(resolution + 1)) {
+    for (const auto j : iter::range(resolution + 1)) {
+      const glm::vec2 uv{static_cast<float>(j) / resolution,
+                         static_cast<float>(i) / resolution};
+      const auto theta{uv.y * glm::pi<float>()};
+      const auto phi{uv.x * glm::two_pi<float>()};
+
+      Vertex vertex{};
+      vertex.normal = {std::sin(theta) * std::cos(phi), std::cos(theta),
+                       std::sin(theta) * std::sin(phi)};
+      vertex.position = vertex.normal;
+      vertex.texCoord = uv;
+      vertex.tangent = {-std::sin(phi), 0.0f, std::cos(phi), 1.0f};
+      vertices.push_back(vertex);
+    }
+  }
+  return vertices;
+}
+
+glm::vec3 unpackOctahedral(const std::array<std::int16_t, 2>& packed) {
+  return abcg::mesh::octahedralDecode(
+      {glm::unpackSnorm1x16(static_cast<std::uint16_t>(packed[0])),
+       glm::unpackSnorm1x16(static_cast<std::uint16_t>(packed[1]))});
+}
+
+// Reads and decodes every attribute once on the CPU
+float readFloat(const std::vector<Vertex>& vertices) {
+  glm::vec4 sum{};
+  for (const auto& vertex : vertices) {
+    sum += glm::vec4(vertex.position, vertex.texCoord.x) +
+           glm::vec4(vertex.normal, vertex.texCoord.y) + vertex.tangent;
+  }
+  return sum.x + sum.y + sum.z + sum.w;
+}
+
+float readPacked(const std::vector<PackedVertex>& vertices) {
+  glm::vec4 sum{};
+  for (const auto& vertex : vertices) {
+    glm::vec4 position{};
+    for (const auto i : iter::range(4)) {
+      position[i] = glm::unpackSnorm1x16(vertex.position.at(i));
+    }
+    const glm::vec2 texCoord{glm::unpackUnorm1x16(vertex.texCoord[0]),
+                             glm::unpackUnorm1x16(vertex.texCoord[1])};
+    sum += position + glm::vec4(unpackOctahedral(vertex.normal), texCoord.x) +
+           glm::vec4(unpackOctahedral(vertex.tangent), texCoord.y);
+  }
+  return sum.x + sum.y + sum.z + sum.w;
+}
+}  // namespace
+
+void benchmarkVertexPacking() {
+  const auto vertices{createSphere(1023)};
+  const auto numVertices{vertices.size()};
+
+  std::vector<PackedVertex> packed;
+  const auto encodeTime{
+      measure([&] { packed = packVertices(vertices, true, true); })};
+  const auto halfPacked{packVertices(vertices, false, true)};
+
+  // Memory
+  const auto floatSize{sizeof(Vertex) * numVertices};
+  const auto packedSize{sizeof(PackedVertex) * numVertices};
+  fmt::print("{} vertices\n", numVertices);
+  fmt::print("  float:  {:>2} bytes/vertex, {:>9} bytes\n", sizeof(Vertex),
+             floatSize);
+  fmt::print("  packed: {:>2} bytes/vertex, {:>9} bytes ({:.2f}x smaller)\n",
+             sizeof(PackedVertex), packedSize,
+             static_cast<double>(floatSize) / packedSize);
+  fmt::print("  encode: {:.2f} ms\n", encodeTime);
+
+  // Precision
+  float maxPositionError{};
+  float maxHalfPositionError{};
+  float maxNormalError{};
+  float maxTexCoordError{};
+  for (const auto i : iter::range(numVertices)) {
+    const auto& vertex{vertices.at(i)};
+    const auto& snorm{packed.at(i)};
+    const auto& half{halfPacked.at(i)};
+    for (const auto c : iter::range(3)) {
+      maxPositionError =
+          std::max(maxPositionError,
+                   std::abs(glm::unpackSnorm1x16(snorm.position.at(c)) -
+                            vertex.position[c]));
+      maxHalfPositionError =
+          std::max(maxHalfPositionError,
+                   std::abs(glm::unpackHalf1x16(half.position.at(c)) -
+                            vertex.position[c]));
+    }
+    const auto cosAngle{glm::dot(unpackOctahedral(snorm.normal),
+                                 vertex.normal)};
+    maxNormalError = std::max(
+        maxNormalError, glm::degrees(std::acos(std::min(cosAngle, 1.0f))));
+    for (const auto c : iter::range(2)) {
+      maxTexCoordError = std::max(
+          maxTexCoordError, std::abs(glm::unpackUnorm1x16(snorm.texCoord.at(c)) -
+                                     vertex.texCoord[c]));
+    }
+  }
+  fmt::print("  max position error: {:.2e} (snorm16), {:.2e} (half)\n",
+             maxPositionError, maxHalfPositionError);
+  fmt::print("  max normal error:   {:.4f} degrees\n", maxNormalError);
+  fmt::print("  max UV error:       {:.2e}\n", maxTexCoordError);
+
+  // Decoding every vertex attribute once on the CPU. This is the cost of
+  // the decoding instructions and of the CPU memory traffic, not a
+  // measurement of the GPU vertex fetch
+  volatile float sink{};
+  const auto floatReadTime{measure([&] { sink = readFloat(vertices); })};
+  const auto packedReadTime{measure([&] { sink = readPacked(packed); })};
+  fmt::print("  CPU decode pass: {:.2f} ms (float), {:.2f} ms (packed)\n",
+             floatReadTime, packedReadTime);
+}
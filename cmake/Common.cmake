@@ -68,6 +68,12 @@ if(ENABLE_IPO)
 
 endif()
 
+# Benchmarks
+option(ENABLE_BENCHMARKS "Build the benchmarks" OFF)
+
+# Statistics of OpenGL calls, shown by WindowSettings::showGLStats
+option(ENABLE_GL_STATS "Count OpenGL calls made through the abcg wrappers" OFF)
+
 # Conan
 option(ENABLE_CONAN "Use Conan Package Manager" OFF)
 if(ENABLE_CONAN AND NOT ${CMAKE_SYSTEM_NAME} MATCHES "Emscripten")
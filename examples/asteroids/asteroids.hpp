@@ -1,53 +1,64 @@
 #ifndef ASTEROIDS_HPP_
 #define ASTEROIDS_HPP_
 
-#include <list>
+#include <array>
 #include <random>
+#include <vector>
 
 #include "abcg.hpp"
 #include "gamedata.hpp"
 #include "ship.hpp"
 
-class OpenGLWindow;
-
 class Asteroids {
  public:
-  void initializeGL(GLuint program, int quantity);
-  void paintGL();
+  // Simulated state of an asteroid. The geometry is one of the shapes
+  // created by initializeGL, so that asteroids can be created without
+  // OpenGL calls
+  struct Asteroid {
+    float m_angularVelocity{};
+    glm::vec4 m_color{1};
+    bool m_hit{false};
+    int m_shape{};
+    float m_rotation{};
+    float m_scale{};
+    glm::vec2 m_translation{glm::vec2(0)};
+    glm::vec2 m_velocity{glm::vec2(0)};
+  };
+
+  static constexpr int numShapes{16};
+
+  void initializeGL(GLuint program);
+  void paintGL(const std::vector<Asteroid> &asteroids);
   void terminateGL();
 
-  void update(const Ship &ship, float deltaTime);
+  static void update(std::vector<Asteroid> &asteroids, const Ship::Body &ship,
+                     float deltaTime);
 
- private:
-  friend OpenGLWindow;
+  static void createAsteroids(std::vector<Asteroid> &asteroids,
+                              std::default_random_engine &randomEngine,
+                              int quantity);
+  static Asteroid createAsteroid(std::default_random_engine &randomEngine,
+                                 glm::vec2 translation = glm::vec2(0),
+                                 float scale = 0.25f);
 
+ private:
   GLuint m_program{};
   GLint m_colorLoc{};
   GLint m_rotationLoc{};
   GLint m_translationLoc{};
   GLint m_scaleLoc{};
 
-  struct Asteroid {
-    GLuint m_vao{};
-    GLuint m_vbo{};
-
-    float m_angularVelocity{};
-    glm::vec4 m_color{1};
-    bool m_hit{false};
-    int m_polygonSides{};
-    float m_rotation{};
-    float m_scale{};
-    glm::vec2 m_translation{glm::vec2(0)};
-    glm::vec2 m_velocity{glm::vec2(0)};
+  // All shapes are stored in the same buffer
+  struct Shape {
+    GLint m_first{};
+    GLsizei m_count{};
   };
 
-  std::list<Asteroid> m_asteroids;
+  abcg::VertexArray m_vao;
+  abcg::Buffer m_vbo;
+  std::array<Shape, numShapes> m_shapes{};
 
   std::default_random_engine m_randomEngine;
-  std::uniform_real_distribution<float> m_randomDist{-1.0f, 1.0f};
-
-  Asteroids::Asteroid createAsteroid(glm::vec2 translation = glm::vec2(0),
-                                     float scale = 0.25f);
 };
 
 #endif
\ No newline at end of file
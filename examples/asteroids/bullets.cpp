@@ -12,8 +12,6 @@ void Bullets::initializeGL(GLuint program) {
   m_scaleLoc = glGetUniformLocation(m_program, "scale");
   m_translationLoc = glGetUniformLocation(m_program, "translation");
 
-  m_bullets.clear();
-
   // Create regular polygon
   auto sides{10};
 
@@ -26,23 +24,21 @@ void Bullets::initializeGL(GLuint program) {
   positions.push_back(positions.at(1));
 
   // Generate VBO of positions
-  glGenBuffers(1, &m_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
-  glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2),
-               positions.data(), GL_STATIC_DRAW);
+  m_vbo.setData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2),
+                positions.data(), GL_STATIC_DRAW);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   // Get location of attributes in the program
   GLint positionAttribute{glGetAttribLocation(m_program, "inPosition")};
 
   // Create VAO
-  glGenVertexArrays(1, &m_vao);
+  m_vao.create();
 
   // Bind vertex attributes to current VAO
-  glBindVertexArray(m_vao);
+  glBindVertexArray(m_vao.get());
 
   glEnableVertexAttribArray(positionAttribute);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vbo.get());
   glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 
@@ -50,15 +46,15 @@ void Bullets::initializeGL(GLuint program) {
   glBindVertexArray(0);
 }
 
-void Bullets::paintGL() {
+void Bullets::paintGL(const std::vector<Bullet> &bullets) {
   glUseProgram(m_program);
 
-  glBindVertexArray(m_vao);
+  glBindVertexArray(m_vao.get());
   glUniform4f(m_colorLoc, 1, 1, 1, 1);
   glUniform1f(m_rotationLoc, 0);
-  glUniform1f(m_scaleLoc, m_scale);
+  glUniform1f(m_scaleLoc, scale);
 
-  for (auto &bullet : m_bullets) {
+  for (const auto &bullet : bullets) {
     glUniform2f(m_translationLoc, bullet.m_translation.x,
                 bullet.m_translation.y);
 
@@ -71,38 +67,39 @@ void Bullets::paintGL() {
 }
 
 void Bullets::terminateGL() {
-  glDeleteBuffers(1, &m_vbo);
-  glDeleteVertexArrays(1, &m_vao);
+  m_vbo.destroy();
+  m_vao.destroy();
 }
 
-void Bullets::update(Ship &ship, const GameData &gameData, float deltaTime) {
+void Bullets::update(std::vector<Bullet> &bullets, Ship::Body &ship,
+                     const GameData &gameData, float deltaTime) {
   // Create a pair of bullets
   if (gameData.m_input[static_cast<size_t>(Input::Fire)] &&
       gameData.m_state == State::Playing) {
     // At least 250 ms must have passed since the last bullets
-    if (ship.m_bulletCoolDownTimer.elapsed() > 250.0 / 1000.0) {
-      ship.m_bulletCoolDownTimer.restart();
+    if (ship.m_bulletCoolDown <= 0.0f) {
+      ship.m_bulletCoolDown = 250.0f / 1000.0f;
 
       // Bullets are shot in the direction of the ship's forward vector
       glm::vec2 forward{glm::rotate(glm::vec2{0.0f, 1.0f}, ship.m_rotation)};
       glm::vec2 right{glm::rotate(glm::vec2{1.0f, 0.0f}, ship.m_rotation)};
-      auto cannonOffset{(11.0f / 15.5f) * ship.m_scale};
+      auto cannonOffset{(11.0f / 15.5f) * Ship::scale};
       auto bulletSpeed{2.0f};
 
       Bullet bullet{.m_dead = false,
                     .m_translation = ship.m_translation + right * cannonOffset,
                     .m_velocity = ship.m_velocity + forward * bulletSpeed};
-      m_bullets.push_back(bullet);
+      bullets.push_back(bullet);
 
       bullet.m_translation = ship.m_translation - right * cannonOffset;
-      m_bullets.push_back(bullet);
+      bullets.push_back(bullet);
 
       // Moves ship in the opposite direction
       ship.m_velocity -= forward * 0.1f;
     }
   }
 
-  for (auto &bullet : m_bullets) {
+  for (auto &bullet : bullets) {
     bullet.m_translation -= ship.m_velocity * deltaTime;
     bullet.m_translation += bullet.m_velocity * deltaTime;
 
@@ -114,5 +111,5 @@ void Bullets::update(Ship &ship, const GameData &gameData, float deltaTime) {
   }
 
   // Remove dead bullets
-  m_bullets.remove_if([](const Bullet &p) { return p.m_dead; });
+  std::erase_if(bullets, [](const Bullet &p) { return p.m_dead; });
 }
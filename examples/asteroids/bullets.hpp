@@ -1,43 +1,39 @@
 #ifndef BULLETS_HPP_
 #define BULLETS_HPP_
 
-#include <list>
+#include <vector>
 
 #include "abcg.hpp"
 #include "gamedata.hpp"
 #include "ship.hpp"
 
-class OpenGLWindow;
-
 class Bullets {
  public:
+  // Simulated state of a bullet
+  struct Bullet {
+    bool m_dead{false};
+    glm::vec2 m_translation{glm::vec2(0)};
+    glm::vec2 m_velocity{glm::vec2(0)};
+  };
+
+  static constexpr float scale{0.015f};
+
   void initializeGL(GLuint program);
-  void paintGL();
+  void paintGL(const std::vector<Bullet> &bullets);
   void terminateGL();
 
-  void update(Ship &ship, const GameData &gameData, float deltaTime);
+  static void update(std::vector<Bullet> &bullets, Ship::Body &ship,
+                     const GameData &gameData, float deltaTime);
 
  private:
-  friend OpenGLWindow;
-
   GLuint m_program{};
   GLint m_colorLoc{};
   GLint m_rotationLoc{};
   GLint m_translationLoc{};
   GLint m_scaleLoc{};
 
-  GLuint m_vao{};
-  GLuint m_vbo{};
-
-  struct Bullet {
-    bool m_dead{false};
-    glm::vec2 m_translation{glm::vec2(0)};
-    glm::vec2 m_velocity{glm::vec2(0)};
-  };
-
-  float m_scale{0.015f};
-
-  std::list<Bullet> m_bullets;
+  abcg::VertexArray m_vao;
+  abcg::Buffer m_vbo;
 };
 
 #endif
\ No newline at end of file
@@ -2,57 +2,65 @@
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 #include "abcg.hpp"
 
 void OpenGLWindow::handleEvent(SDL_Event &event) {
   // Keyboard events
   if (event.type == SDL_KEYDOWN) {
     if (event.key.keysym.sym == SDLK_SPACE)
-      m_gameData.m_input.set(static_cast<size_t>(Input::Fire));
+      m_input.set(static_cast<size_t>(Input::Fire));
     if (event.key.keysym.sym == SDLK_UP || event.key.keysym.sym == SDLK_w)
-      m_gameData.m_input.set(static_cast<size_t>(Input::Up));
+      m_input.set(static_cast<size_t>(Input::Up));
     if (event.key.keysym.sym == SDLK_DOWN || event.key.keysym.sym == SDLK_s)
-      m_gameData.m_input.set(static_cast<size_t>(Input::Down));
+      m_input.set(static_cast<size_t>(Input::Down));
     if (event.key.keysym.sym == SDLK_LEFT || event.key.keysym.sym == SDLK_a)
-      m_gameData.m_input.set(static_cast<size_t>(Input::Left));
+      m_input.set(static_cast<size_t>(Input::Left));
     if (event.key.keysym.sym == SDLK_RIGHT || event.key.keysym.sym == SDLK_d)
-      m_gameData.m_input.set(static_cast<size_t>(Input::Right));
+      m_input.set(static_cast<size_t>(Input::Right));
   }
   if (event.type == SDL_KEYUP) {
     if (event.key.keysym.sym == SDLK_SPACE)
-      m_gameData.m_input.reset(static_cast<size_t>(Input::Fire));
+      m_input.reset(static_cast<size_t>(Input::Fire));
     if (event.key.keysym.sym == SDLK_UP || event.key.keysym.sym == SDLK_w)
-      m_gameData.m_input.reset(static_cast<size_t>(Input::Up));
+      m_input.reset(static_cast<size_t>(Input::Up));
     if (event.key.keysym.sym == SDLK_DOWN || event.key.keysym.sym == SDLK_s)
-      m_gameData.m_input.reset(static_cast<size_t>(Input::Down));
+      m_input.reset(static_cast<size_t>(Input::Down));
     if (event.key.keysym.sym == SDLK_LEFT || event.key.keysym.sym == SDLK_a)
-      m_gameData.m_input.reset(static_cast<size_t>(Input::Left));
+      m_input.reset(static_cast<size_t>(Input::Left));
     if (event.key.keysym.sym == SDLK_RIGHT || event.key.keysym.sym == SDLK_d)
-      m_gameData.m_input.reset(static_cast<size_t>(Input::Right));
+      m_input.reset(static_cast<size_t>(Input::Right));
   }
 
   // Mouse events
   if (event.type == SDL_MOUSEBUTTONDOWN) {
     if (event.button.button == SDL_BUTTON_LEFT)
-      m_gameData.m_input.set(static_cast<size_t>(Input::Fire));
+      m_input.set(static_cast<size_t>(Input::Fire));
     if (event.button.button == SDL_BUTTON_RIGHT)
-      m_gameData.m_input.set(static_cast<size_t>(Input::Up));
+      m_input.set(static_cast<size_t>(Input::Up));
   }
   if (event.type == SDL_MOUSEBUTTONUP) {
     if (event.button.button == SDL_BUTTON_LEFT)
-      m_gameData.m_input.reset(static_cast<size_t>(Input::Fire));
+      m_input.reset(static_cast<size_t>(Input::Fire));
     if (event.button.button == SDL_BUTTON_RIGHT)
-      m_gameData.m_input.reset(static_cast<size_t>(Input::Up));
+      m_input.reset(static_cast<size_t>(Input::Up));
   }
   if (event.type == SDL_MOUSEMOTION) {
     glm::ivec2 mousePosition;
-    SDL_GetMouseState(&mousePosition.x, &mousePosition.y);
+    getMouseState(&mousePosition.x, &mousePosition.y);
 
     glm::vec2 direction{glm::vec2{mousePosition.x - m_viewportWidth / 2,
                                   mousePosition.y - m_viewportHeight / 2}};
     direction.y = -direction.y;
-    m_ship.setRotation(std::atan2(direction.y, direction.x) - M_PI_2);
+    m_mouseRotation.store(
+        static_cast<float>(std::atan2(direction.y, direction.x) - M_PI_2),
+        std::memory_order_relaxed);
   }
+
+  m_inputBits.store(m_input.to_ulong(), std::memory_order_relaxed);
 }
 
 void OpenGLWindow::initializeGL() {
@@ -77,53 +85,83 @@ void OpenGLWindow::initializeGL() {
   glEnable(GL_PROGRAM_POINT_SIZE);
 #endif
 
+  m_starLayers.initializeGL(m_starsProgram, 25);
+  m_ship.initializeGL(m_objectsProgram);
+  m_asteroids.initializeGL(m_objectsProgram);
+  m_bullets.initializeGL(m_objectsProgram);
+
   // Start pseudo-random number generator
-  auto seed{std::chrono::steady_clock::now().time_since_epoch().count()};
-  m_randomEngine.seed(seed);
+  m_randomEngine.seed(abcg::randomSeed());
 
   restart();
+  m_worlds.getWriteBuffer() = m_world;
+  m_worlds.publish();
+
+  // The game is simulated at a fixed rate on its own thread, while the
+  // frames render the latest world that it published
+  m_simulation.start(
+      [this](double deltaTime) { simulate(static_cast<float>(deltaTime)); });
 }
 
 void OpenGLWindow::restart() {
-  m_gameData.m_state = State::Playing;
+  m_world.m_gameData.m_state = State::Playing;
 
-  m_starLayers.initializeGL(m_starsProgram, 25);
-  m_ship.initializeGL(m_objectsProgram);
-  m_asteroids.initializeGL(m_objectsProgram, 3);
-  m_bullets.initializeGL(m_objectsProgram);
+  m_world.m_ship = {};
+  m_world.m_starLayers = {};
+  m_world.m_bullets.clear();
+  Asteroids::createAsteroids(m_world.m_asteroids, m_randomEngine, 3);
 }
 
-void OpenGLWindow::update() {
-  float deltaTime{static_cast<float>(getDeltaTime())};
+// Runs on the simulation thread
+void OpenGLWindow::simulate(float deltaTime) {
+  m_world.m_gameData.m_input = m_inputBits.load(std::memory_order_relaxed);
+  if (const auto rotation{m_mouseRotation.exchange(
+          std::numeric_limits<float>::quiet_NaN(), std::memory_order_relaxed)};
+      !std::isnan(rotation)) {
+    m_world.m_ship.m_rotation = rotation;
+  }
+
+  update(deltaTime);
+
+  m_worlds.getWriteBuffer() = m_world;
+  m_worlds.publish();
+}
+
+void OpenGLWindow::update(float deltaTime) {
+  auto &gameData{m_world.m_gameData};
 
   // Wait 5 seconds before restarting
-  if (m_gameData.m_state != State::Playing &&
-      m_restartWaitTimer.elapsed() > 5) {
-    restart();
-    return;
+  if (gameData.m_state != State::Playing) {
+    m_restartWait -= deltaTime;
+    if (m_restartWait <= 0.0f) {
+      restart();
+      return;
+    }
   }
 
-  m_ship.update(m_gameData, deltaTime);
-  m_starLayers.update(m_ship, deltaTime);
-  m_asteroids.update(m_ship, deltaTime);
-  m_bullets.update(m_ship, m_gameData, deltaTime);
+  Ship::update(m_world.m_ship, gameData, deltaTime);
+  StarLayers::update(m_world.m_starLayers, m_world.m_ship, deltaTime);
+  Asteroids::update(m_world.m_asteroids, m_world.m_ship, deltaTime);
+  Bullets::update(m_world.m_bullets, m_world.m_ship, gameData, deltaTime);
 
-  if (m_gameData.m_state == State::Playing) {
+  if (gameData.m_state == State::Playing) {
     checkCollisions();
     checkWinCondition();
   }
 }
 
 void OpenGLWindow::paintGL() {
-  update();
+  m_simulation.poll();
+  m_worlds.update();
+  const auto &world{m_worlds.getReadBuffer()};
 
   glClear(GL_COLOR_BUFFER_BIT);
   glViewport(0, 0, m_viewportWidth, m_viewportHeight);
 
-  m_starLayers.paintGL();
-  m_asteroids.paintGL();
-  m_bullets.paintGL();
-  m_ship.paintGL(m_gameData);
+  m_starLayers.paintGL(world.m_starLayers);
+  m_asteroids.paintGL(world.m_asteroids);
+  m_bullets.paintGL(world.m_bullets);
+  m_ship.paintGL(world.m_ship, world.m_gameData);
 }
 
 void OpenGLWindow::paintUI() {
@@ -141,9 +179,10 @@ void OpenGLWindow::paintUI() {
     ImGui::Begin(" ", nullptr, flags);
     ImGui::PushFont(m_font);
 
-    if (m_gameData.m_state == State::GameOver) {
+    const auto &gameData{m_worlds.getReadBuffer().m_gameData};
+    if (gameData.m_state == State::GameOver) {
       ImGui::Text("Game Over!");
-    } else if (m_gameData.m_state == State::Win) {
+    } else if (gameData.m_state == State::Win) {
       ImGui::Text("*You Win!*");
     }
 
@@ -160,6 +199,8 @@ void OpenGLWindow::resizeGL(int width, int height) {
 }
 
 void OpenGLWindow::terminateGL() {
+  m_simulation.stop();
+
   glDeleteProgram(m_starsProgram);
   glDeleteProgram(m_objectsProgram);
 
@@ -170,29 +211,32 @@ void OpenGLWindow::terminateGL() {
 }
 
 void OpenGLWindow::checkCollisions() {
+  auto &ship{m_world.m_ship};
+  auto &asteroids{m_world.m_asteroids};
+
   // Check collision between ship and asteroids
-  for (auto &asteroid : m_asteroids.m_asteroids) {
+  for (auto &asteroid : asteroids) {
     auto asteroidTranslation{asteroid.m_translation};
-    auto distance{glm::distance(m_ship.m_translation, asteroidTranslation)};
+    auto distance{glm::distance(ship.m_translation, asteroidTranslation)};
 
-    if (distance < m_ship.m_scale * 0.9f + asteroid.m_scale * 0.85f) {
-      m_gameData.m_state = State::GameOver;
-      m_restartWaitTimer.restart();
+    if (distance < Ship::scale * 0.9f + asteroid.m_scale * 0.85f) {
+      m_world.m_gameData.m_state = State::GameOver;
+      m_restartWait = 5.0f;
     }
   }
 
   // Check collision between bullets and asteroids
-  for (auto &bullet : m_bullets.m_bullets) {
+  for (auto &bullet : m_world.m_bullets) {
     if (bullet.m_dead) continue;
 
-    for (auto &asteroid : m_asteroids.m_asteroids) {
+    for (auto &asteroid : asteroids) {
       for (auto i : {-2, 0, 2}) {
         for (auto j : {-2, 0, 2}) {
           auto asteroidTranslation{asteroid.m_translation + glm::vec2(i, j)};
           auto distance{
               glm::distance(bullet.m_translation, asteroidTranslation)};
 
-          if (distance < m_bullets.m_scale + asteroid.m_scale * 0.85f) {
+          if (distance < Bullets::scale + asteroid.m_scale * 0.85f) {
             asteroid.m_hit = true;
             bullet.m_dead = true;
           }
@@ -200,28 +244,32 @@ void OpenGLWindow::checkCollisions() {
       }
     }
 
-    // Break asteroids marked as hit
-    for (auto &asteroid : m_asteroids.m_asteroids) {
+    // Break asteroids marked as hit. The fragments are added after the loop,
+    // as adding them to the vector would invalidate the iterators
+    m_fragments.clear();
+    for (auto &asteroid : asteroids) {
       if (asteroid.m_hit && asteroid.m_scale > 0.10f) {
         std::uniform_real_distribution<float> m_randomDist{-1.0f, 1.0f};
-        std::generate_n(std::back_inserter(m_asteroids.m_asteroids), 3, [&]() {
+        std::generate_n(std::back_inserter(m_fragments), 3, [&]() {
           glm::vec2 offset{m_randomDist(m_randomEngine),
                            m_randomDist(m_randomEngine)};
-          return m_asteroids.createAsteroid(
+          return Asteroids::createAsteroid(
+              m_randomEngine,
               asteroid.m_translation + offset * asteroid.m_scale * 0.5f,
               asteroid.m_scale * 0.5f);
         });
       }
     }
 
-    m_asteroids.m_asteroids.remove_if(
-        [](const Asteroids::Asteroid &a) { return a.m_hit; });
+    std::erase_if(asteroids,
+                  [](const Asteroids::Asteroid &a) { return a.m_hit; });
+    asteroids.insert(asteroids.end(), m_fragments.begin(), m_fragments.end());
   }
 }
 
 void OpenGLWindow::checkWinCondition() {
-  if (m_asteroids.m_asteroids.empty()) {
-    m_gameData.m_state = State::Win;
-    m_restartWaitTimer.restart();
+  if (m_world.m_asteroids.empty()) {
+    m_world.m_gameData.m_state = State::Win;
+    m_restartWait = 5.0f;
   }
 }
\ No newline at end of file
@@ -3,13 +3,18 @@
 
 #include <imgui.h>
 
+#include <atomic>
+#include <bitset>
+#include <limits>
 #include <random>
+#include <vector>
 
 #include "abcg.hpp"
 #include "asteroids.hpp"
 #include "bullets.hpp"
 #include "ship.hpp"
 #include "starlayers.hpp"
+#include "world.hpp"
 
 class OpenGLWindow : public abcg::OpenGLWindow {
  protected:
@@ -27,24 +32,37 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   int m_viewportWidth{};
   int m_viewportHeight{};
 
-  GameData m_gameData;
-
   Asteroids m_asteroids;
   Bullets m_bullets;
   Ship m_ship;
   StarLayers m_starLayers;
 
-  abcg::ElapsedTimer m_restartWaitTimer;
-
   ImFont* m_font{};
 
+  // Input of the rendering thread, read by the simulation thread at each
+  // step. The rotation set by the mouse is NaN if it has not changed
+  std::bitset<5> m_input;
+  std::atomic<unsigned long> m_inputBits{};
+  std::atomic<float> m_mouseRotation{std::numeric_limits<float>::quiet_NaN()};
+
+  // Used by the simulation thread only
+  World m_world;
+  float m_restartWait{};
+  std::vector<Asteroids::Asteroid> m_fragments;
   std::default_random_engine m_randomEngine;
 
+  // Latest world published by the simulation thread
+  abcg::TripleBuffer<World> m_worlds;
+
+  // Declared last, so that the thread stops before the state is destroyed
+  abcg::SimulationThread m_simulation;
+
   void checkCollisions();
   void checkWinCondition();
 
   void restart();
-  void update();
+  void simulate(float deltaTime);
+  void update(float deltaTime);
 };
 
 #endif
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "ship.hpp"
 
+#include <algorithm>
 #include <glm/gtx/fast_trigonometry.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 
@@ -12,10 +13,6 @@ void Ship::initializeGL(GLuint program) {
   m_scaleLoc = glGetUniformLocation(m_program, "scale");
   m_translationLoc = glGetUniformLocation(m_program, "translation");
 
-  m_rotation = 0.0f;
-  m_translation = glm::vec2(0);
-  m_velocity = glm::vec2(0);
-
   // clang-format off
   std::array<glm::vec2, 24> positions{
       // Ship body
@@ -101,16 +98,16 @@ void Ship::initializeGL(GLuint program) {
   glBindVertexArray(0);
 }
 
-void Ship::paintGL(const GameData &gameData) {
+void Ship::paintGL(const Body &body, const GameData &gameData) {
   if (gameData.m_state != State::Playing) return;
 
   glUseProgram(m_program);
 
   glBindVertexArray(m_vao);
 
-  glUniform1f(m_scaleLoc, m_scale);
-  glUniform1f(m_rotationLoc, m_rotation);
-  glUniform2fv(m_translationLoc, 1, &m_translation.x);
+  glUniform1f(m_scaleLoc, scale);
+  glUniform1f(m_rotationLoc, body.m_rotation);
+  glUniform2fv(m_translationLoc, 1, &body.m_translation.x);
 
   // Restart thruster blink timer every 100 ms
   if (m_trailBlinkTimer.elapsed() > 100.0 / 1000.0) m_trailBlinkTimer.restart();
@@ -144,18 +141,20 @@ void Ship::terminateGL() {
   glDeleteVertexArrays(1, &m_vao);
 }
 
-void Ship::update(const GameData &gameData, float deltaTime) {
+void Ship::update(Body &body, const GameData &gameData, float deltaTime) {
   // Rotate
   if (gameData.m_input[static_cast<size_t>(Input::Left)])
-    m_rotation = glm::wrapAngle(m_rotation + 4.0f * deltaTime);
+    body.m_rotation = glm::wrapAngle(body.m_rotation + 4.0f * deltaTime);
   if (gameData.m_input[static_cast<size_t>(Input::Right)])
-    m_rotation = glm::wrapAngle(m_rotation - 4.0f * deltaTime);
+    body.m_rotation = glm::wrapAngle(body.m_rotation - 4.0f * deltaTime);
 
   // Apply thrust
   if (gameData.m_input[static_cast<size_t>(Input::Up)] &&
       gameData.m_state == State::Playing) {
     // Thrust in the forward vector
-    glm::vec2 forward = glm::rotate(glm::vec2{0.0f, 1.0f}, m_rotation);
-    m_velocity += forward * deltaTime;
+    glm::vec2 forward = glm::rotate(glm::vec2{0.0f, 1.0f}, body.m_rotation);
+    body.m_velocity += forward * deltaTime;
   }
+
+  body.m_bulletCoolDown = std::max(body.m_bulletCoolDown - deltaTime, 0.0f);
 }
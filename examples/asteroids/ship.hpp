@@ -4,26 +4,25 @@
 #include "abcg.hpp"
 #include "gamedata.hpp"
 
-class Asteroids;
-class Bullets;
-class OpenGLWindow;
-class StarLayers;
-
 class Ship {
  public:
+  // Simulated state of the ship
+  struct Body {
+    float m_rotation{};
+    glm::vec2 m_translation{glm::vec2(0)};
+    glm::vec2 m_velocity{glm::vec2(0)};
+    float m_bulletCoolDown{};  // Seconds until the next bullets can be shot
+  };
+
+  static constexpr float scale{0.125f};
+
   void initializeGL(GLuint program);
-  void paintGL(const GameData &gameData);
+  void paintGL(const Body &body, const GameData &gameData);
   void terminateGL();
 
-  void update(const GameData &gameData, float deltaTime);
-  void setRotation(float rotation) { m_rotation = rotation; }
+  static void update(Body &body, const GameData &gameData, float deltaTime);
 
  private:
-  friend Asteroids;
-  friend Bullets;
-  friend OpenGLWindow;
-  friend StarLayers;
-
   GLuint m_program{};
   GLint m_translationLoc{};
   GLint m_colorLoc{};
@@ -35,13 +34,8 @@ class Ship {
   GLuint m_ebo{};
 
   glm::vec4 m_color{1};
-  float m_rotation{};
-  float m_scale{0.125f};
-  glm::vec2 m_translation{glm::vec2(0)};
-  glm::vec2 m_velocity{glm::vec2(0)};
 
   abcg::ElapsedTimer m_trailBlinkTimer;
-  abcg::ElapsedTimer m_bulletCoolDownTimer;
 };
 
 #endif
\ No newline at end of file
@@ -6,8 +6,7 @@ void StarLayers::initializeGL(GLuint program, int quantity) {
   terminateGL();
 
   // Start pseudo-random number generator
-  auto seed{std::chrono::steady_clock::now().time_since_epoch().count()};
-  m_randomEngine.seed(seed);
+  m_randomEngine.seed(abcg::randomSeed());
 
   m_program = program;
   m_pointSizeLoc = glGetUniformLocation(m_program, "pointSize");
@@ -20,7 +19,6 @@ void StarLayers::initializeGL(GLuint program, int quantity) {
   for (auto &&[index, layer] : iter::enumerate(m_starLayers)) {
     layer.m_pointSize = 10.0f / (1.0f + index);
     layer.m_quantity = quantity * (static_cast<int>(index) + 1);
-    layer.m_translation = glm::vec2(0);
 
     std::vector<glm::vec3> data(0);
     for ([[maybe_unused]] auto i : iter::range(0, layer.m_quantity)) {
@@ -60,20 +58,19 @@ void StarLayers::initializeGL(GLuint program, int quantity) {
   }
 }
 
-void StarLayers::paintGL() {
+void StarLayers::paintGL(const Translations &translations) {
   glUseProgram(m_program);
 
   glEnable(GL_BLEND);
   glBlendFunc(GL_ONE, GL_ONE);
 
-  for (auto &layer : m_starLayers) {
+  for (auto &&[layer, translation] : iter::zip(m_starLayers, translations)) {
     glBindVertexArray(layer.m_vao);
     glUniform1f(m_pointSizeLoc, layer.m_pointSize);
 
     for (auto i : {-2, 0, 2}) {
       for (auto j : {-2, 0, 2}) {
-        glUniform2f(m_translationLoc, layer.m_translation.x + j,
-                    layer.m_translation.y + i);
+        glUniform2f(m_translationLoc, translation.x + j, translation.y + i);
 
         glDrawArrays(GL_POINTS, 0, layer.m_quantity);
       }
@@ -94,15 +91,16 @@ void StarLayers::terminateGL() {
   }
 }
 
-void StarLayers::update(const Ship &ship, float deltaTime) {
-  for (auto &&[index, layer] : iter::enumerate(m_starLayers)) {
+void StarLayers::update(Translations &translations, const Ship::Body &ship,
+                        float deltaTime) {
+  for (auto &&[index, translation] : iter::enumerate(translations)) {
     auto layerSpeedScale{1.0f / (index + 2.0f)};
-    layer.m_translation -= ship.m_velocity * deltaTime * layerSpeedScale;
+    translation -= ship.m_velocity * deltaTime * layerSpeedScale;
 
     // Wrap-around
-    if (layer.m_translation.x < -1.0f) layer.m_translation.x += 2.0f;
-    if (layer.m_translation.x > +1.0f) layer.m_translation.x -= 2.0f;
-    if (layer.m_translation.y < -1.0f) layer.m_translation.y += 2.0f;
-    if (layer.m_translation.y > +1.0f) layer.m_translation.y -= 2.0f;
+    if (translation.x < -1.0f) translation.x += 2.0f;
+    if (translation.x > +1.0f) translation.x -= 2.0f;
+    if (translation.y < -1.0f) translation.y += 2.0f;
+    if (translation.y > +1.0f) translation.y -= 2.0f;
   }
 }
\ No newline at end of file
@@ -2,25 +2,28 @@
 #define STARLAYERS_HPP_
 
 #include <array>
+#include <cstddef>
 #include <random>
 
 #include "abcg.hpp"
 #include "gamedata.hpp"
 #include "ship.hpp"
 
-class OpenGLWindow;
-
 class StarLayers {
  public:
+  static constexpr std::size_t numLayers{5};
+
+  // Simulated translation of each layer
+  using Translations = std::array<glm::vec2, numLayers>;
+
   void initializeGL(GLuint program, int quantity);
-  void paintGL();
+  void paintGL(const Translations &translations);
   void terminateGL();
 
-  void update(const Ship &ship, float deltaTime);
+  static void update(Translations &translations, const Ship::Body &ship,
+                     float deltaTime);
 
  private:
-  friend OpenGLWindow;
-
   GLuint m_program{};
   GLint m_pointSizeLoc{};
   GLint m_translationLoc{};
@@ -31,10 +34,9 @@ class StarLayers {
 
     float m_pointSize{};
     int m_quantity{};
-    glm::vec2 m_translation{glm::vec2(0)};
   };
 
-  std::array<StarLayer, 5> m_starLayers;
+  std::array<StarLayer, numLayers> m_starLayers;
 
   std::default_random_engine m_randomEngine;
 };
@@ -0,0 +1,22 @@
+#ifndef WORLD_HPP_
+#define WORLD_HPP_
+
+#include <vector>
+
+#include "asteroids.hpp"
+#include "bullets.hpp"
+#include "gamedata.hpp"
+#include "ship.hpp"
+#include "starlayers.hpp"
+
+// State of the game, advanced by the simulation thread and handed over to
+// the rendering thread after each step
+struct World {
+  GameData m_gameData;
+  Ship::Body m_ship;
+  std::vector<Asteroids::Asteroid> m_asteroids;
+  std::vector<Bullets::Bullet> m_bullets;
+  StarLayers::Translations m_starLayers{};
+};
+
+#endif
\ No newline at end of file
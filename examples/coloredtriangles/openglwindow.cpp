@@ -41,8 +41,7 @@ void OpenGLWindow::initializeGL() {
   glClear(GL_COLOR_BUFFER_BIT);
 
   // Start pseudo-random number generator
-  auto seed{std::chrono::steady_clock::now().time_since_epoch().count()};
-  m_randomEngine.seed(seed);
+  m_randomEngine.seed(abcg::randomSeed());
 }
 
 void OpenGLWindow::paintGL() {
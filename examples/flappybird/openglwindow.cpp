@@ -50,8 +50,7 @@ void OpenGLWindow::initializeGL() {
 #endif
 
   // Start pseudo-random number generator
-  auto seed{std::chrono::steady_clock::now().time_since_epoch().count()};
-  m_randomEngine.seed(seed);
+  m_randomEngine.seed(abcg::randomSeed());
 
   restart();
 }
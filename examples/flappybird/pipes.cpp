@@ -6,38 +6,73 @@ void Pipes::initializeGL(GLuint program) {
   terminateGL();
 
   // Start pseudo-random number generator
-  auto seed{std::chrono::steady_clock::now().time_since_epoch().count()};
-  m_randomEngine.seed(seed);
+  m_randomEngine.seed(abcg::randomSeed());
 
   m_pipes.clear();
 
   m_program = program;
   m_colorLoc = glGetUniformLocation(m_program, "color");
   m_translationLoc = glGetUniformLocation(m_program, "translation");
+
+  // Room for the geometry of 64 pipes per frame
+  m_vertexStream.create(GL_ARRAY_BUFFER, 64 * sizeof(Pipe::m_positions));
+  m_indexStream.create(GL_ELEMENT_ARRAY_BUFFER, 64 * 12 * sizeof(GLuint));
+
+  // Get location of attributes in the program
+  GLint positionAttribute{glGetAttribLocation(m_program, "inPosition")};
+
+  // Create VAO
+  glGenVertexArrays(1, &m_vao);
+
+  // Bind vertex attributes to current VAO
+  glBindVertexArray(m_vao);
+
+  glBindBuffer(GL_ARRAY_BUFFER, m_vertexStream.getBuffer());
+  glEnableVertexAttribArray(positionAttribute);
+  glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexStream.getBuffer());
+
+  // End of binding to current VAO
+  glBindVertexArray(0);
 }
 
 void Pipes::paintGL() {
+  m_vertexStream.beginFrame();
+  m_indexStream.beginFrame();
+
   glUseProgram(m_program);
+  glBindVertexArray(m_vao);
 
   for (auto &pipe : m_pipes) {
-    glBindVertexArray(pipe.m_vao);
+    // Indices are offset to the first vertex of this pipe in the buffer
+    const auto firstVertex{m_vertexStream.push(pipe.m_positions) /
+                           sizeof(glm::vec2)};
+    std::array<GLuint, 12> indices{0, 1, 2,
+                                   1, 2, 3,
+                                   4, 5, 6,
+                                   5, 6, 7};
+    for (auto &index : indices) {
+      index += static_cast<GLuint>(firstVertex);
+    }
+    const auto indexOffset{m_indexStream.push(indices)};
 
     glUniform4fv(m_colorLoc, 1, &pipe.m_color.r);
     glUniform2f(m_translationLoc, pipe.m_translation.x, pipe.m_translation.y);
 
-    glDrawElements(GL_TRIANGLES, 4 * 3, GL_UNSIGNED_INT, nullptr);
-
-    glBindVertexArray(0);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()),
+                   GL_UNSIGNED_INT, reinterpret_cast<void *>(indexOffset));
   }
 
+  glBindVertexArray(0);
   glUseProgram(0);
 }
 
 void Pipes::terminateGL() {
-  for (auto pipe : m_pipes) {
-    glDeleteBuffers(1, &pipe.m_vbo);
-    glDeleteVertexArrays(1, &pipe.m_vao);
-  }
+  m_vertexStream.destroy();
+  m_indexStream.destroy();
+  glDeleteVertexArrays(1, &m_vao);
+  m_vao = 0;
 }
 
 void Pipes::update(const Bird &bird, const GameData &gameData, float deltaTime) {
@@ -74,7 +109,7 @@ Pipes::Pipe Pipes::createPipe(const Bird &bird) {
   pipe.m_lowerPipeTop = middlePosition - middleDistance;
 
   // Create geometry
-  std::array<glm::vec2, 8> positions{
+  pipe.m_positions = {
     // upper pipe
     glm::vec2{-pipe.m_width/2, pipe.m_upperPipeTop},    // leftmost top
     glm::vec2{+pipe.m_width/2, pipe.m_upperPipeTop},    // rightmost top
@@ -87,41 +122,5 @@ Pipes::Pipe Pipes::createPipe(const Bird &bird) {
     glm::vec2{+pipe.m_width/2, pipe.m_lowerPipeBottom}, // rightmost bottom
   };
 
-  std::array indices{0, 1, 2,
-                     1, 2, 3,
-                     4, 5, 6,
-                     5, 6, 7};
-  
-  // Generate VBO
-  glGenBuffers(1, &pipe.m_vbo);
-  glBindBuffer(GL_ARRAY_BUFFER, pipe.m_vbo);
-  glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec2), positions.data(), GL_STATIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-  // Generate EBO
-  glGenBuffers(1, &pipe.m_ebo);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pipe.m_ebo);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices.data(), GL_STATIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
-
-
-  // Get location of attributes in the program
-  GLint positionAttribute{glGetAttribLocation(m_program, "inPosition")};
-
-  // Create VAO
-  glGenVertexArrays(1, &pipe.m_vao);
-
-  // Bind vertex attributes to current VAO
-  glBindVertexArray(pipe.m_vao);
-
-  glBindBuffer(GL_ARRAY_BUFFER, pipe.m_vbo);
-  glEnableVertexAttribArray(positionAttribute);
-  glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, pipe.m_ebo);
-
-  // End of binding to current VAO
-  glBindVertexArray(0);
-
   return pipe;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef PIPES_HPP_
 #define PIPES_HPP_
 
+#include <array>
 #include <list>
 #include <random>
 
@@ -25,10 +26,13 @@ class Pipes {
   GLint m_colorLoc{};
   GLint m_translationLoc{};
 
+  // Vertices and indices of all pipes are streamed every frame
+  GLuint m_vao{};
+  abcg::StreamBuffer m_vertexStream;
+  abcg::StreamBuffer m_indexStream;
+
   struct Pipe {
-    GLuint m_vao{};
-    GLuint m_ebo{};
-    GLuint m_vbo{};
+    std::array<glm::vec2, 8> m_positions{};
 
     float m_upperPipeTop{+1.0f};
     float m_upperPipeBottom;
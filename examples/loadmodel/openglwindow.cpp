@@ -6,19 +6,6 @@
 
 #include <cppitertools/itertools.hpp>
 #include <glm/gtx/fast_trigonometry.hpp>
-#include <glm/gtx/hash.hpp>
-#include <unordered_map>
-
-// Custom specialization of std::hash injected in namespace std
-namespace std {
-template <>
-struct hash<Vertex> {
-  size_t operator()(Vertex const& vertex) const noexcept {
-    std::size_t h1{std::hash<glm::vec3>()(vertex.position)};
-    return h1;
-  }
-};
-}  // namespace std
 
 void OpenGLWindow::initializeGL() {
   glClearColor(0, 0, 0, 1);
@@ -95,8 +82,13 @@ void OpenGLWindow::loadModelFromFile(std::string_view path) {
   m_vertices.clear();
   m_indices.clear();
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
+  // Table of unique vertices, reserved for the worst case of no shared
+  // vertices
+  std::size_t numCorners{};
+  for (const auto& shape : shapes) {
+    numCorners += shape.mesh.indices.size();
+  }
+  abcg::VertexDedup<Vertex> vertexDedup{numCorners};
 
   // Loop over shapes
   for (const auto& shape : shapes) {
@@ -121,19 +113,12 @@ void OpenGLWindow::loadModelFromFile(std::string_view path) {
         Vertex vertex{};
         vertex.position = {vx, vy, vz};
 
-        // If hash doesn't contain this vertex
-        if (hash.count(vertex) == 0) {
-          // Add this index (size of m_vertices)
-          hash[vertex] = m_vertices.size();
-          // Add this vertex
-          m_vertices.push_back(vertex);
-        }
-
-        m_indices.push_back(hash[vertex]);
+        m_indices.push_back(vertexDedup.insert(vertex));
       }
       indexOffset += numFaceVertices;
     }
   }
+  m_vertices = vertexDedup.takeVertices();
 }
 
 void OpenGLWindow::standardize() {
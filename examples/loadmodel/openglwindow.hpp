@@ -5,10 +5,6 @@
 
 struct Vertex {
   glm::vec3 position;
-
-  bool operator==(const Vertex& other) const {
-    return position == other.position;
-  }
 };
 
 class OpenGLWindow : public abcg::OpenGLWindow {
@@ -4,21 +4,9 @@
 #include <imgui.h>
 #include <tiny_obj_loader.h>
 
+#include <algorithm>
 #include <cppitertools/itertools.hpp>
 #include <glm/gtx/fast_trigonometry.hpp>
-#include <glm/gtx/hash.hpp>
-#include <unordered_map>
-
-// Custom specialization of std::hash injected in namespace std
-namespace std {
-template <>
-struct hash<Vertex> {
-  size_t operator()(Vertex const& vertex) const noexcept {
-    std::size_t h1{std::hash<glm::vec3>()(vertex.position)};
-    return h1;
-  }
-};
-}  // namespace std
 
 void OpenGLWindow::handleEvent(SDL_Event& ev) {
   if (ev.type == SDL_KEYDOWN) {
@@ -63,6 +51,7 @@ void OpenGLWindow::initializeGL() {
 
   // Load model
   loadModelFromFile(getAssetsPath() + "bunny.obj");
+  generateLODs();
 
   // Generate VBO
   glGenBuffers(1, &m_VBO);
@@ -125,8 +114,13 @@ void OpenGLWindow::loadModelFromFile(std::string_view path) {
   m_vertices.clear();
   m_indices.clear();
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
+  // Table of unique vertices, reserved for the worst case of no shared
+  // vertices
+  std::size_t numCorners{};
+  for (const auto& shape : shapes) {
+    numCorners += shape.mesh.indices.size();
+  }
+  abcg::VertexDedup<Vertex> vertexDedup{numCorners};
 
   // Loop over shapes
   for (const auto& shape : shapes) {
@@ -151,19 +145,49 @@ void OpenGLWindow::loadModelFromFile(std::string_view path) {
         Vertex vertex{};
         vertex.position = {vx, vy, vz};
 
-        // If uniqueVertices doesn't contain this vertex
-        if (hash.count(vertex) == 0) {
-          // Add this index (size of m_vertices)
-          hash[vertex] = m_vertices.size();
-          // Add this vertex
-          m_vertices.push_back(vertex);
-        }
-
-        m_indices.push_back(hash[vertex]);
+        m_indices.push_back(vertexDedup.insert(vertex));
       }
       indexOffset += numFaceVertices;
     }
   }
+  m_vertices = vertexDedup.takeVertices();
+}
+
+void OpenGLWindow::generateLODs() {
+  std::vector<glm::vec3> positions;
+  positions.reserve(m_vertices.size());
+  for (const auto& vertex : m_vertices) {
+    positions.push_back(vertex.position);
+  }
+
+  // Bounding sphere
+  m_center = glm::vec3{0.0f};
+  for (const auto& position : positions) {
+    m_center += position;
+  }
+  m_center /= static_cast<float>(std::max<std::size_t>(positions.size(), 1));
+  m_radius = 0.0f;
+  for (const auto& position : positions) {
+    m_radius = std::max(m_radius, glm::distance(m_center, position));
+  }
+
+  // Level 0 is the original mesh. Simplified levels are appended to m_indices
+  // so that all of them are stored in the same EBO
+  m_LODs = abcg::mesh::buildLODChain(positions, m_indices);
+}
+
+void OpenGLWindow::drawModel(const glm::mat4& modelMatrix) {
+  // Select level of detail from the projected size of the bounding sphere
+  const auto modelViewMatrix{m_camera.m_viewMatrix * modelMatrix};
+  const glm::vec3 center{modelViewMatrix * glm::vec4(m_center, 1.0f)};
+  const auto scale{glm::length(glm::vec3(modelViewMatrix[0]))};
+  const auto diameter{abcg::mesh::projectedDiameter(
+      m_camera.m_projMatrix, center, m_radius * scale, m_viewportHeight)};
+  const auto& lod{m_LODs.at(abcg::mesh::selectLOD(diameter, m_LODs.size()))};
+
+  glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(lod.numIndices),
+                 GL_UNSIGNED_INT,
+                 reinterpret_cast<void*>(lod.firstIndex * sizeof(GLuint)));
 }
 
 void OpenGLWindow::paintGL() {
@@ -196,7 +220,7 @@ void OpenGLWindow::paintGL() {
 
   glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &model[0][0]);
   glUniform4f(colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);
-  glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, nullptr);
+  drawModel(model);
 
   // Draw yellow bunny
   model = glm::mat4(1.0);
@@ -205,7 +229,7 @@ void OpenGLWindow::paintGL() {
 
   glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &model[0][0]);
   glUniform4f(colorLoc, 1.0f, 0.8f, 0.0f, 1.0f);
-  glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, nullptr);
+  drawModel(model);
 
   // Draw blue bunny
   model = glm::mat4(1.0);
@@ -215,7 +239,7 @@ void OpenGLWindow::paintGL() {
 
   glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &model[0][0]);
   glUniform4f(colorLoc, 0.0f, 0.8f, 1.0f, 1.0f);
-  glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, nullptr);
+  drawModel(model);
 
   // Draw red bunny
   model = glm::mat4(1.0);
@@ -223,7 +247,7 @@ void OpenGLWindow::paintGL() {
 
   glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &model[0][0]);
   glUniform4f(colorLoc, 1.0f, 0.25f, 0.25f, 1.0f);
-  glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, nullptr);
+  drawModel(model);
 
   glBindVertexArray(0);
   glUseProgram(0);
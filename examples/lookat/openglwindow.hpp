@@ -6,10 +6,6 @@
 
 struct Vertex {
   glm::vec3 position;
-
-  bool operator==(const Vertex& other) const {
-    return position == other.position;
-  }
 };
 
 class OpenGLWindow : public abcg::OpenGLWindow {
@@ -38,6 +34,15 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
 
+  // Range of m_indices used by each level of detail
+  std::vector<abcg::mesh::IndexRange> m_LODs;
+
+  // Bounding sphere of the model
+  glm::vec3 m_center{};
+  float m_radius{};
+
+  void drawModel(const glm::mat4& modelMatrix);
+  void generateLODs();
   void loadModelFromFile(std::string_view path);
   void update();
 };
@@ -15,12 +15,21 @@ in vec4 fragPosition;
 
 uniform mat3 normalMatrix;
 
-// Light properties
-uniform vec4 Ia, Id, Is;
-uniform vec4 lightPosWorldSpace;
-uniform vec4 lightDirWorldSpace;
-uniform float lightCutOff;
-uniform float lightOuterCutOff;
+// Per-frame camera and light data, shared by all programs
+layout(std140) uniform FrameData {
+  highp mat4 viewMatrix;
+  highp mat4 projMatrix;
+  highp vec4 lightDirWorldSpace;
+  highp vec4 lightPosWorldSpace;
+  highp vec4 Ia;
+  highp vec4 Id;
+  highp vec4 Is;
+  highp float lightCutOff;
+  highp float lightOuterCutOff;
+  // Mapping mode
+  // 0: triplanar; 1: cylindrical; 2: spherical; 3: from mesh
+  highp int mappingMode;
+};
 
 // Material properties
 uniform vec4 Ka, Kd, Ks;
@@ -32,10 +41,6 @@ uniform sampler2D diffuseTex;
 // Normal map sampler
 uniform sampler2D normalTex;
 
-// Mapping mode
-// 0: triplanar; 1: cylindrical; 2: spherical; 3: from mesh
-uniform int mappingMode;
-
 out vec4 outColor;
 
 // Compute matrix to transform from camera space to tangent space
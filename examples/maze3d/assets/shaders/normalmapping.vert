@@ -1,15 +1,31 @@
 #version 410
 
-layout(location = 0) in vec3 inPosition;
+layout(location = 0) in vec4 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec4 inTangent;
 
+// If true, normal and tangent are octahedral-encoded in .xy and the
+// tangent handedness is stored in inPosition.w
+uniform bool packedVertices;
+
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projMatrix;
 
-uniform mediump vec4 lightPosWorldSpace;
+// Per-frame camera and light data, shared by all programs
+layout(std140) uniform FrameData {
+  highp mat4 viewMatrix;
+  highp mat4 projMatrix;
+  highp vec4 lightDirWorldSpace;
+  highp vec4 lightPosWorldSpace;
+  highp vec4 Ia;
+  highp vec4 Id;
+  highp vec4 Is;
+  highp float lightCutOff;
+  highp float lightOuterCutOff;
+  // Mapping mode
+  // 0: triplanar; 1: cylindrical; 2: spherical; 3: from mesh
+  highp int mappingMode;
+};
 
 out vec2 fragTexCoord;
 out vec3 fragPObj;
@@ -22,21 +38,36 @@ out vec3 fragVEye;
 
 out vec4 fragPosition;
 
+vec3 octahedralDecode(vec2 e) {
+  vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  float fold = max(-v.z, 0.0);
+  v.xy += mix(vec2(fold), vec2(-fold), greaterThanEqual(v.xy, vec2(0.0)));
+  return normalize(v);
+}
+
 void main() {
-  vec3 PEye = (viewMatrix * modelMatrix * vec4(inPosition, 1.0)).xyz;
-  vec3 LEye = (viewMatrix * normalize(lightPosWorldSpace - modelMatrix * vec4(inPosition, 1.0))).xyz;
+  vec3 position = inPosition.xyz;
+  vec3 normal = inNormal;
+  vec4 tangent = inTangent;
+  if (packedVertices) {
+    normal = octahedralDecode(inNormal.xy);
+    tangent = vec4(octahedralDecode(inTangent.xy), inPosition.w);
+  }
+
+  vec3 PEye = (viewMatrix * modelMatrix * vec4(position, 1.0)).xyz;
+  vec3 LEye = (viewMatrix * normalize(lightPosWorldSpace - modelMatrix * vec4(position, 1.0))).xyz;
 
   fragTexCoord = inTexCoord;
 
-  fragPObj = inPosition;
-  fragTObj = inTangent.xyz;
-  fragBObj = inTangent.w * cross(inNormal, inTangent.xyz);
-  fragNObj = inNormal;
+  fragPObj = position;
+  fragTObj = tangent.xyz;
+  fragBObj = tangent.w * cross(normal, tangent.xyz);
+  fragNObj = normal;
 
   fragLEye = LEye;
   fragVEye = -PEye;
 
-  fragPosition = vec4(modelMatrix * vec4(inPosition, 1.0));
+  fragPosition = vec4(modelMatrix * vec4(position, 1.0));
 
   gl_Position = projMatrix * vec4(PEye, 1.0);
 }
\ No newline at end of file
@@ -5,8 +5,22 @@ layout(location = 0) in vec3 inPosition;
 out vec3 fragTexCoord;
 
 uniform mat4 modelMatrix;
-uniform mat4 viewMatrix;
-uniform mat4 projMatrix;
+
+// Per-frame camera and light data, shared by all programs
+layout(std140) uniform FrameData {
+  highp mat4 viewMatrix;
+  highp mat4 projMatrix;
+  highp vec4 lightDirWorldSpace;
+  highp vec4 lightPosWorldSpace;
+  highp vec4 Ia;
+  highp vec4 Id;
+  highp vec4 Is;
+  highp float lightCutOff;
+  highp float lightOuterCutOff;
+  // Mapping mode
+  // 0: triplanar; 1: cylindrical; 2: spherical; 3: from mesh
+  highp int mappingMode;
+};
 
 void main() {
   fragTexCoord = inPosition;
@@ -13,6 +13,7 @@ int main(int argc, char **argv) {
                                .height = 600,
                                .showFPS = false,
                                .showFullscreenButton = false, 
+                               .showGLStats = true,
                                .title = "Haunted Maze 3D"});
 
     app.run(window);
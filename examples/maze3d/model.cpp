@@ -1,276 +1,422 @@
 #include "model.hpp"
 
 #include <fmt/core.h>
-#include <tiny_obj_loader.h>
 
 #include <cppitertools/itertools.hpp>
+#include <cstddef>
 #include <filesystem>
-#include <glm/gtx/hash.hpp>
-#include <unordered_map>
-
-// Custom specialization of std::hash injected in namespace std
-namespace std {
-template <>
-struct hash<Vertex> {
-  size_t operator()(Vertex const& vertex) const noexcept {
-    std::size_t h1{std::hash<glm::vec3>()(vertex.position)};
-    std::size_t h2{std::hash<glm::vec3>()(vertex.normal)};
-    std::size_t h3{std::hash<glm::vec2>()(vertex.texCoord)};
-    return h1 ^ h2 ^ h3;
-  }
-};
-}  // namespace std
-
-Model::~Model() {
-  glDeleteTextures(1, &m_normalTexture);
-  glDeleteTextures(1, &m_diffuseTexture);
-  glDeleteBuffers(1, &m_EBO);
-  glDeleteBuffers(1, &m_VBO);
-  glDeleteVertexArrays(1, &m_VAO);
-}
 
 void Model::createBuffers() {
-  // Delete previous buffers
-  glDeleteBuffers(1, &m_EBO);
-  glDeleteBuffers(1, &m_VBO);
-
-  // VBO
-  glGenBuffers(1, &m_VBO);
-  glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(m_vertices[0]) * m_vertices.size(), m_vertices.data(), GL_STATIC_DRAW);
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  // VBO. Previous buffers are deleted when the new ones are created
+  if (m_vertexFormat == VertexFormat::Float) {
+    m_positionType = GL_FLOAT;
+    m_texCoordType = GL_FLOAT;
+    m_vertexBufferSize = sizeof(m_vertices[0]) * m_vertices.size();
+    m_VBO.create();
+    m_VBO.setData(GL_ARRAY_BUFFER, m_vertexBufferSize, m_vertices.data(),
+                  GL_STATIC_DRAW);
+  } else {
+    const auto packedVertices{packVertices()};
+    m_vertexBufferSize = sizeof(packedVertices[0]) * packedVertices.size();
+    m_VBO.create();
+    m_VBO.setData(GL_ARRAY_BUFFER, m_vertexBufferSize, packedVertices.data(),
+                  GL_STATIC_DRAW);
+  }
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   // EBO
-  glGenBuffers(1, &m_EBO);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_indices[0]) * m_indices.size(),
-               m_indices.data(), GL_STATIC_DRAW);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+  m_EBO.create();
+  m_EBO.setData(GL_ELEMENT_ARRAY_BUFFER,
+                sizeof(m_indices[0]) * m_indices.size(), m_indices.data(),
+                GL_STATIC_DRAW);
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+std::vector<PackedVertex> Model::packVertices() {
+  // snorm16 positions require coordinates in [-1, 1], and unorm16 texture
+  // coordinates require coordinates in [0, 1]. Otherwise, use half-floats
+  const auto positionsInRange{m_vertexFormat == VertexFormat::PackedSnorm16 &&
+                              positionsFitSnorm16(m_vertices)};
+  const auto texCoordsInRange{texCoordsFitUnorm16(m_vertices)};
+  m_positionType = positionsInRange ? GL_SHORT : GL_HALF_FLOAT;
+  m_texCoordType = texCoordsInRange ? GL_UNSIGNED_SHORT : GL_HALF_FLOAT;
+
+  return ::packVertices(m_vertices, positionsInRange, texCoordsInRange);
 }
 
+// Decodes the faces of a cube map. The texture is created by upload
 void Model::loadCubeTexture(const std::string& path) {
   if (!std::filesystem::exists(path)) return;
 
-  glDeleteTextures(1, &m_cubeTexture);
-  m_cubeTexture = abcg::opengl::loadCubemap(
-      {path + "posx.png", path + "negx.png", path + "posy.png",
-       path + "negy.png", path + "posz.png", path + "negz.png"});
+  std::array<abcg::opengl::Image, 6> images;
+  for (auto&& [image, face] :
+       iter::zip(images, std::array{"posx", "negx", "posy", "negy", "posz",
+                                    "negz"})) {
+    image = abcg::opengl::loadImage(path + face + ".png", false);
+  }
+  m_cubeImages = std::move(images);
+}
+
+// Decodes a texture image, unless it is already decoded or uploaded.
+// Returns the path, or an empty string if the file does not exist
+std::string Model::decodeTexture(const std::string& path) {
+  if (!std::filesystem::exists(path)) return {};
+
+  if (!m_textures.contains(path) && !m_images.contains(path)) {
+    m_images.emplace(path, abcg::opengl::loadImage(path));
+  }
+  return path;
+}
+
+// Loads a texture, or returns the one already loaded from the same path
+GLuint Model::loadTexture(const std::string& path) {
+  if (!std::filesystem::exists(path)) return 0;
+
+  if (const auto it{m_textures.find(path)}; it != m_textures.end()) {
+    return it->second.get();
+  }
+  // Trilinear filtering with anisotropy, shared by the textures of all models
+  m_sampler = abcg::opengl::getSampler(
+      {GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT, 8.0f});
+  auto& texture{m_textures[path]};
+  texture = abcg::Texture{abcg::opengl::loadTexture(path)};
+  return texture.get();
 }
 
+// Overrides the diffuse texture of all materials
 void Model::loadDiffuseTexture(std::string_view path) {
-  if (!std::filesystem::exists(path)) return;
+  const auto texture{loadTexture(std::string{path})};
+  if (texture == 0) return;
 
-  glDeleteTextures(1, &m_diffuseTexture);
-  m_diffuseTexture = abcg::opengl::loadTexture(path);
+  for (auto& material : m_materials) {
+    material.diffuseTexture = texture;
+  }
 }
 
+// Overrides the normal texture of all materials
 void Model::loadNormalTexture(std::string_view path) {
-  if (!std::filesystem::exists(path)) return;
+  const auto texture{loadTexture(std::string{path})};
+  if (texture == 0) return;
 
-  glDeleteTextures(1, &m_normalTexture);
-  m_normalTexture = abcg::opengl::loadTexture(path);
+  for (auto& material : m_materials) {
+    material.normalTexture = texture;
+  }
 }
 
+// Reads the mesh and decodes the textures of the materials. Does not make
+// OpenGL calls, so it can be called from worker threads. The buffers and
+// textures are created by upload
 void Model::loadFromFile(std::string_view path, bool standardize) {
   auto basePath{std::filesystem::path{path}.parent_path().string() + "/"};
 
-  tinyobj::ObjReaderConfig readerConfig;
-  readerConfig.mtl_search_path = basePath;  // Path to material files
+  abcg::ObjFile objFile;
+  objFile.load(path, basePath);
 
-  tinyobj::ObjReader reader;
-
-  if (!reader.ParseFromFile(path.data(), readerConfig)) {
-    if (!reader.Error().empty()) {
-      throw abcg::Exception{abcg::Exception::Runtime(
-          fmt::format("Failed to load model {} ({})", path, reader.Error()))};
-    }
-    throw abcg::Exception{
-        abcg::Exception::Runtime(fmt::format("Failed to load model {}", path))};
+  if (!objFile.getWarning().empty()) {
+    fmt::print("Warning: {}\n", objFile.getWarning());
   }
 
-  if (!reader.Warning().empty()) {
-    fmt::print("Warning: {}\n", reader.Warning());
-  }
-
-  const auto& attrib{reader.GetAttrib()};
-  const auto& shapes{reader.GetShapes()};
-  const auto& materials{reader.GetMaterials()};
+  const auto& positions{objFile.getPositions()};
+  const auto& normals{objFile.getNormals()};
+  const auto& texCoords{objFile.getTexCoords()};
+  const auto& corners{objFile.getCorners()};
+  const auto& materials{objFile.getMaterials()};
 
   m_vertices.clear();
   m_indices.clear();
+  m_materials.clear();
+  m_submeshes.clear();
 
   m_hasNormals = false;
   m_hasTexCoords = false;
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
-
-  // Loop over shapes
-  for (const auto& shape : shapes) {
-    // Loop over indices
-    for (const auto offset : iter::range(shape.mesh.indices.size())) {
-      // Access to vertex
-      tinyobj::index_t index{shape.mesh.indices.at(offset)};
-
-      // Vertex coordinates
-      std::size_t startIndex{static_cast<size_t>(3 * index.vertex_index)};
-      float vx{attrib.vertices.at(startIndex + 0)};
-      float vy{attrib.vertices.at(startIndex + 1)};
-      float vz{attrib.vertices.at(startIndex + 2)};
-
-      // Vertex normal
-      float nx{};
-      float ny{};
-      float nz{};
-      if (index.normal_index >= 0) {
-        m_hasNormals = true;
-        startIndex = 3 * index.normal_index;
-        nx = attrib.normals.at(startIndex + 0);
-        ny = attrib.normals.at(startIndex + 1);
-        nz = attrib.normals.at(startIndex + 2);
-      }
-
-      // Vertex texture coordinates
-      float tu{};
-      float tv{};
-      if (index.texcoord_index >= 0) {
-        m_hasTexCoords = true;
-        startIndex = 2 * index.texcoord_index;
-        tu = attrib.texcoords.at(startIndex + 0);
-        tv = attrib.texcoords.at(startIndex + 1);
-      }
-
-      Vertex vertex{};
-      vertex.position = {vx, vy, vz};
-      vertex.normal = {nx, ny, nz};
-      vertex.texCoord = {tu, tv};
-
-      // If hash doesn't contain this vertex
-      if (hash.count(vertex) == 0) {
-        // Add this index (size of m_vertices)
-        hash[vertex] = m_vertices.size();
-        // Add this vertex
-        m_vertices.push_back(vertex);
-      }
-
-      m_indices.push_back(hash[vertex]);
-    }
-  }
-
-  // Use properties of first material, if available
-  if (!materials.empty()) {
-    const auto& mat{materials.at(0)};  // First material
-    m_Ka = glm::vec4(mat.ambient[0], mat.ambient[1], mat.ambient[2], 1);
-    m_Kd = glm::vec4(mat.diffuse[0], mat.diffuse[1], mat.diffuse[2], 1);
-    m_Ks = glm::vec4(mat.specular[0], mat.specular[1], mat.specular[2], 1);
-    m_shininess = mat.shininess;
+  // Materials of the MTL file. The last one is the default material, used by
+  // faces without a material
+  for (const auto& mat : materials) {
+    Material material;
+    material.Ka = glm::vec4(mat.ambient[0], mat.ambient[1], mat.ambient[2], 1);
+    material.Kd = glm::vec4(mat.diffuse[0], mat.diffuse[1], mat.diffuse[2], 1);
+    material.Ks = glm::vec4(mat.specular[0], mat.specular[1], mat.specular[2], 1);
+    material.shininess = mat.shininess;
 
     if (!mat.diffuse_texname.empty())
-      loadDiffuseTexture(basePath + mat.diffuse_texname);
+      material.diffuseTexturePath =
+          decodeTexture(basePath + mat.diffuse_texname);
 
     if (!mat.normal_texname.empty()) {
-      loadNormalTexture(basePath + mat.normal_texname);
+      material.normalTexturePath = decodeTexture(basePath + mat.normal_texname);
     } else if (!mat.bump_texname.empty()) {
-      loadNormalTexture(basePath + mat.bump_texname);
+      material.normalTexturePath = decodeTexture(basePath + mat.bump_texname);
     }
-  } else {
-    // Default values
-    m_Ka = {0.1f, 0.1f, 0.1f, 1.0f};
-    m_Kd = {0.7f, 0.7f, 0.7f, 1.0f};
-    m_Ks = {1.0f, 1.0f, 1.0f, 1.0f};
-    m_shininess = 25.0f;
+
+    m_materials.push_back(material);
+  }
+  const auto defaultMaterialID{m_materials.size()};
+  m_materials.push_back(Material{});
+
+  // Indices of each material. Faces of all shapes that share a material are
+  // grouped in the same submesh
+  std::vector<std::vector<GLuint>> materialIndices(m_materials.size());
+
+  // Table of unique vertices, reserved for the worst case of no shared
+  // vertices
+  abcg::VertexDedup<Vertex> vertexDedup{corners.size()};
+
+  // Loop over the corners of the triangles
+  for (const auto offset : iter::range(corners.size())) {
+    const auto& corner{corners[offset]};
+
+    Vertex vertex{};
+    vertex.position = positions[corner.position];
+    if (corner.normal >= 0) {
+      m_hasNormals = true;
+      vertex.normal = normals[corner.normal];
+    }
+    if (corner.texCoord >= 0) {
+      m_hasTexCoords = true;
+      vertex.texCoord = texCoords[corner.texCoord];
+    }
+
+    // The material of the triangle is at offset / 3
+    const auto materialID{objFile.getMaterialIDs()[offset / 3]};
+    materialIndices
+        .at(materialID < 0 ? defaultMaterialID
+                           : static_cast<std::size_t>(materialID))
+        .push_back(vertexDedup.insert(vertex));
+  }
+  m_vertices = vertexDedup.takeVertices();
+
+  // Concatenate the indices of each material into a single index array
+  for (const auto& [materialID, indices] : iter::enumerate(materialIndices)) {
+    if (indices.empty()) continue;
+    m_submeshes.push_back({m_indices.size(), indices.size(), materialID});
+    m_indices.insert(m_indices.end(), indices.begin(), indices.end());
   }
 
   if (standardize) {
     this->standardize();
   }
 
-  if (!m_hasNormals) {
-    computeNormals();
+  // Triangles of each vertex, shared by the computation of normals and
+  // tangents
+  if (!m_hasNormals || m_hasTexCoords) {
+    const auto vertexFaces{
+        abcg::mesh::buildVertexFaces(m_vertices.size(), m_indices)};
+
+    if (!m_hasNormals) {
+      computeNormals(vertexFaces);
+    }
+
+    if (m_hasTexCoords) {
+      computeTangents(vertexFaces);
+    }
+  }
+}
+
+// Creates the buffers and the textures of the data read by loadFromFile and
+// loadCubeTexture
+void Model::upload() {
+  if (!m_images.empty()) {
+    // Trilinear filtering with anisotropy, shared by the textures of all
+    // models
+    m_sampler = abcg::opengl::getSampler(
+        {GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_REPEAT, 8.0f});
+  }
+  for (const auto& [path, image] : m_images) {
+    // Mipmaps add a third to the size of the image
+    auto& texture{m_textures[path]};
+    texture = abcg::Texture{abcg::opengl::createTexture(image)};
+    texture.setSize(image.pixels.size() * 4 / 3);
+  }
+  m_images.clear();
+
+  for (auto& material : m_materials) {
+    if (!material.diffuseTexturePath.empty()) {
+      material.diffuseTexture =
+          m_textures.at(material.diffuseTexturePath).get();
+    }
+    if (!material.normalTexturePath.empty()) {
+      material.normalTexture = m_textures.at(material.normalTexturePath).get();
+    }
   }
 
-  if (m_hasTexCoords) {
-    computeTangents();
+  if (m_cubeImages) {
+    m_cubeTexture = abcg::Texture{abcg::opengl::createCubemap(*m_cubeImages)};
+    std::size_t cubeSize{};
+    for (const auto& image : *m_cubeImages) {
+      cubeSize += image.pixels.size() * 4 / 3;
+    }
+    m_cubeTexture.setSize(cubeSize);
+    m_cubeSampler = abcg::opengl::getSampler(
+        {GL_LINEAR_MIPMAP_LINEAR, GL_LINEAR, GL_CLAMP_TO_EDGE});
+    m_cubeImages.reset();
   }
-  
+
   createBuffers();
 }
 
-void Model::render() const {
-  glBindVertexArray(m_VAO);
-
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, m_diffuseTexture);
+// Number of bytes copied to the GPU by upload, with vertices in float format
+std::size_t Model::getUploadSize() const {
+  auto size{sizeof(Vertex) * m_vertices.size() +
+            sizeof(GLuint) * m_indices.size()};
+  for (const auto& [path, image] : m_images) {
+    size += image.pixels.size();
+  }
+  if (m_cubeImages) {
+    for (const auto& image : *m_cubeImages) {
+      size += image.pixels.size();
+    }
+  }
+  return size;
+}
 
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, m_normalTexture);
+// Records one draw packet per submesh. Does not make OpenGL calls, so it can
+// be called from worker threads
+void Model::enqueue(abcg::CommandList& commandList,
+                    const abcg::InstanceTransform& transform,
+                    unsigned int layer) const {
+  const auto& modelMatrix{transform.modelMatrix};
+  const glm::mat3 normalMatrix{glm::vec3(transform.normalMatrix[0]),
+                               glm::vec3(transform.normalMatrix[1]),
+                               glm::vec3(transform.normalMatrix[2])};
+  const GLint packedVertices{m_vertexFormat != VertexFormat::Float};
+
+  for (const auto& submesh : m_submeshes) {
+    const auto& material{m_materials.at(submesh.materialID)};
+
+    abcg::DrawPacket packet;
+    packet.sortKey = abcg::CommandList::makeSortKey(
+        layer, m_program, material.diffuseTexture, m_VAO.get());
+    packet.program = m_program;
+    packet.VAO = m_VAO.get();
+    packet.textures = {
+        {{GL_TEXTURE_2D, material.diffuseTexture, m_sampler},
+         {GL_TEXTURE_2D, material.normalTexture, m_sampler},
+         {GL_TEXTURE_CUBE_MAP, m_cubeTexture.get(), m_cubeSampler}}};
+    packet.first = submesh.firstIndex * sizeof(m_indices[0]);
+    packet.count = static_cast<GLsizei>(submesh.numIndices);
+
+    commandList.draw(packet, {{m_modelMatrixLoc, modelMatrix},
+                              {m_normalMatrixLoc, normalMatrix},
+                              {m_packedVerticesLoc, packedVertices},
+                              {m_KaLoc, material.Ka},
+                              {m_KdLoc, material.Kd},
+                              {m_KsLoc, material.Ks},
+                              {m_shininessLoc, material.shininess}});
+  }
+}
 
-  glActiveTexture(GL_TEXTURE2);
-  glBindTexture(GL_TEXTURE_CUBE_MAP, m_cubeTexture);
+void Model::render() const {
+  auto& stateCache{abcg::GLStateCache::current()};
+  stateCache.bindVertexArray(m_VAO.get());
+  stateCache.bindTexture(2, GL_TEXTURE_CUBE_MAP, m_cubeTexture.get());
+  stateCache.bindSampler(0, m_sampler);
+  stateCache.bindSampler(1, m_sampler);
+  stateCache.bindSampler(2, m_cubeSampler);
+
+  if (m_packedVerticesLoc >= 0) {
+    abcg::glUniform1i(m_packedVerticesLoc, m_vertexFormat != VertexFormat::Float);
+  }
 
-  // Set minification and magnification parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  for (const auto& submesh : m_submeshes) {
+    const auto& material{m_materials.at(submesh.materialID)};
 
-  // Set texture wrapping parameters
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    stateCache.bindTexture(0, GL_TEXTURE_2D, material.diffuseTexture);
+    stateCache.bindTexture(1, GL_TEXTURE_2D, material.normalTexture);
 
-  glFrontFace(GL_CCW);
-  glDepthFunc(GL_LEQUAL);
-  
-  glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, nullptr);
+    abcg::glDrawElements(
+        GL_TRIANGLES, submesh.numIndices, GL_UNSIGNED_INT,
+        reinterpret_cast<void*>(submesh.firstIndex * sizeof(m_indices[0])));
+  }
 
-  glBindVertexArray(0);
+  stateCache.bindVertexArray(0);
 }
 
 void Model::setupVAO(GLuint program) {
-  // Release previous VAO
-  glDeleteVertexArrays(1, &m_VAO);
+  // The previous VAO is released by create. It is unbound first so that the
+  // state cache does not keep its name, which may be reused by the new VAO
+  auto& stateCache{abcg::GLStateCache::current()};
+  stateCache.bindVertexArray(0);
+
+  m_program = program;
+  m_packedVerticesLoc = abcg::glGetUniformLocation(program, "packedVertices");
+  m_modelMatrixLoc = abcg::glGetUniformLocation(program, "modelMatrix");
+  m_normalMatrixLoc = abcg::glGetUniformLocation(program, "normalMatrix");
+  m_KaLoc = abcg::glGetUniformLocation(program, "Ka");
+  m_KdLoc = abcg::glGetUniformLocation(program, "Kd");
+  m_KsLoc = abcg::glGetUniformLocation(program, "Ks");
+  m_shininessLoc = abcg::glGetUniformLocation(program, "shininess");
 
   // Create VAO
-  glGenVertexArrays(1, &m_VAO);
-  glBindVertexArray(m_VAO);
+  m_VAO.create();
+  stateCache.bindVertexArray(m_VAO.get());
 
   // Bind EBO and VBO
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+  abcg::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO.get());
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, m_VBO.get());
+
+  // Attribute formats. Packed attributes are normalized integers or
+  // half-floats and are converted to float by the vertex fetch
+  const auto packed{m_vertexFormat != VertexFormat::Float};
+  const GLsizei stride = packed ? sizeof(PackedVertex) : sizeof(Vertex);
+  const auto normalized{static_cast<GLboolean>(packed ? GL_TRUE : GL_FALSE)};
 
   // Bind vertex attributes
-  GLint positionAttribute = glGetAttribLocation(program, "inPosition");
+  GLint positionAttribute = abcg::glGetAttribLocation(program, "inPosition");
   if (positionAttribute >= 0) {
-    glEnableVertexAttribArray(positionAttribute);
-    glVertexAttribPointer(positionAttribute, 3, GL_FLOAT, GL_FALSE,
-                          sizeof(Vertex), nullptr);
+    abcg::glEnableVertexAttribArray(positionAttribute);
+    GLsizei offset = packed ? offsetof(PackedVertex, position)
+                            : offsetof(Vertex, position);
+    abcg::glVertexAttribPointer(positionAttribute, packed ? 4 : 3, m_positionType,
+                          m_positionType == GL_SHORT ? normalized : GL_FALSE,
+                          stride, reinterpret_cast<void*>(offset));
   }
 
-  GLint normalAttribute = glGetAttribLocation(program, "inNormal");
+  GLint normalAttribute = abcg::glGetAttribLocation(program, "inNormal");
   if (normalAttribute >= 0) {
-    glEnableVertexAttribArray(normalAttribute);
-    GLsizei offset{sizeof(glm::vec3)};
-    glVertexAttribPointer(normalAttribute, 3, GL_FLOAT, GL_FALSE,
-                          sizeof(Vertex), reinterpret_cast<void*>(offset));
+    abcg::glEnableVertexAttribArray(normalAttribute);
+    GLsizei offset = packed ? offsetof(PackedVertex, normal)
+                            : offsetof(Vertex, normal);
+    abcg::glVertexAttribPointer(normalAttribute, packed ? 2 : 3,
+                          packed ? GL_SHORT : GL_FLOAT, normalized, stride,
+                          reinterpret_cast<void*>(offset));
   }
 
-  GLint texCoordAttribute{glGetAttribLocation(program, "inTexCoord")};
+  GLint texCoordAttribute{abcg::glGetAttribLocation(program, "inTexCoord")};
   if (texCoordAttribute >= 0) {
-    glEnableVertexAttribArray(texCoordAttribute);
-    GLsizei offset{sizeof(glm::vec3) + sizeof(glm::vec3)};
-    glVertexAttribPointer(texCoordAttribute, 2, GL_FLOAT, GL_FALSE,
-                          sizeof(Vertex), reinterpret_cast<void*>(offset));
+    abcg::glEnableVertexAttribArray(texCoordAttribute);
+    GLsizei offset = packed ? offsetof(PackedVertex, texCoord)
+                            : offsetof(Vertex, texCoord);
+    abcg::glVertexAttribPointer(
+        texCoordAttribute, 2, m_texCoordType,
+        m_texCoordType == GL_UNSIGNED_SHORT ? normalized : GL_FALSE, stride,
+        reinterpret_cast<void*>(offset));
   }
   
-  GLint tangentCoordAttribute{glGetAttribLocation(program, "inTangent")};
+  GLint tangentCoordAttribute{abcg::glGetAttribLocation(program, "inTangent")};
   if (tangentCoordAttribute >= 0) {
-    glEnableVertexAttribArray(tangentCoordAttribute);
-    GLsizei offset{sizeof(glm::vec3) + sizeof(glm::vec3) + sizeof(glm::vec2)};
-    glVertexAttribPointer(tangentCoordAttribute, 4, GL_FLOAT, GL_FALSE,
-                          sizeof(Vertex), reinterpret_cast<void*>(offset));
+    abcg::glEnableVertexAttribArray(tangentCoordAttribute);
+    GLsizei offset = packed ? offsetof(PackedVertex, tangent)
+                            : offsetof(Vertex, tangent);
+    abcg::glVertexAttribPointer(tangentCoordAttribute, packed ? 2 : 4,
+                          packed ? GL_SHORT : GL_FLOAT, normalized, stride,
+                          reinterpret_cast<void*>(offset));
   }
 
   // End of binding
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  abcg::glBindBuffer(GL_ARRAY_BUFFER, 0);
+  stateCache.bindVertexArray(0);
+}
+
+void Model::setVertexFormat(VertexFormat format) {
+  if (format == m_vertexFormat) return;
+  m_vertexFormat = format;
+
+  // Recreate buffers and VAO if the model is already loaded
+  if (m_VBO) {
+    createBuffers();
+    if (m_VAO) setupVAO(m_program);
+  }
 }
 
 void Model::standardize() {
@@ -296,97 +442,35 @@ void Model::standardize() {
   }
 }
 
-void Model::computeNormals() {
-  // Clear previous vertex normals
-  for (auto& vertex : m_vertices) {
-    vertex.normal = glm::zero<glm::vec3>();
+void Model::computeNormals(const abcg::mesh::VertexFaces& vertexFaces) {
+  std::vector<glm::vec3> positions(m_vertices.size());
+  for (auto&& [position, vertex] : iter::zip(positions, m_vertices)) {
+    position = vertex.position;
   }
 
-  // Compute face normals
-  for (const auto offset : iter::range<int>(0, m_indices.size(), 3)) {
-    // Get face vertices
-    Vertex& a{m_vertices.at(m_indices.at(offset + 0))};
-    Vertex& b{m_vertices.at(m_indices.at(offset + 1))};
-    Vertex& c{m_vertices.at(m_indices.at(offset + 2))};
-
-    // Compute normal
-    const auto edge1{b.position - a.position};
-    const auto edge2{c.position - b.position};
-    glm::vec3 normal{glm::cross(edge1, edge2)};
-
-    // Accumulate on vertices
-    a.normal += normal;
-    b.normal += normal;
-    c.normal += normal;
-  }
-
-  // Normalize
-  for (auto& vertex : m_vertices) {
-    vertex.normal = glm::normalize(vertex.normal);
+  // Face-parallel computation with the same result as a serial loop
+  const auto normals{
+      abcg::mesh::computeNormals(positions, m_indices, vertexFaces)};
+  for (auto&& [vertex, normal] : iter::zip(m_vertices, normals)) {
+    vertex.normal = normal;
   }
 
   m_hasNormals = true;
 }
 
-void Model::computeTangents() {
-  // Reserve space for bitangents
-  std::vector<glm::vec3> bitangents(m_vertices.size(), glm::vec3(0));
-
-  // Compute face tangents and bitangents
-  for (const auto offset : iter::range<int>(0, m_indices.size(), 3)) {
-    // Get face indices
-    const auto i1{m_indices.at(offset + 0)};
-    const auto i2{m_indices.at(offset + 1)};
-    const auto i3{m_indices.at(offset + 2)};
-
-    // Get face vertices
-    Vertex& v1{m_vertices.at(i1)};
-    Vertex& v2{m_vertices.at(i2)};
-    Vertex& v3{m_vertices.at(i3)};
-
-    const auto e1{v2.position - v1.position};
-    const auto e2{v3.position - v1.position};
-    const auto delta1{v2.texCoord - v1.texCoord};
-    const auto delta2{v3.texCoord - v1.texCoord};
-
-    // clang-format off
-    glm::mat2 M;
-    M[0][0] =  delta2.t;
-    M[0][1] = -delta1.t;
-    M[1][0] = -delta2.s;
-    M[1][1] =  delta1.s;
-    M *= (1.0f / (delta1.s * delta2.t - delta2.s * delta1.t));
-
-    auto tangent{glm::vec4(M[0][0] * e1.x + M[0][1] * e2.x,
-                           M[0][0] * e1.y + M[0][1] * e2.y,
-                           M[0][0] * e1.z + M[0][1] * e2.z, 0.0f)};
-
-    auto bitangent{glm::vec3(M[1][0] * e1.x + M[1][1] * e2.x,
-                             M[1][0] * e1.y + M[1][1] * e2.y,
-                             M[1][0] * e1.z + M[1][1] * e2.z)};
-    // clang-format on
-
-    // Accumulate on vertices
-    v1.tangent += tangent;
-    v2.tangent += tangent;
-    v3.tangent += tangent;
-
-    bitangents.at(i1) += bitangent;
-    bitangents.at(i2) += bitangent;
-    bitangents.at(i3) += bitangent;
-  }
-
+void Model::computeTangents(const abcg::mesh::VertexFaces& vertexFaces) {
+  std::vector<glm::vec3> positions(m_vertices.size());
+  std::vector<glm::vec3> normals(m_vertices.size());
+  std::vector<glm::vec2> texCoords(m_vertices.size());
   for (auto&& [i, vertex] : iter::enumerate(m_vertices)) {
-    const auto& n{vertex.normal};
-    const auto& t{glm::vec3(vertex.tangent)};
-
-    // Orthogonalize t with respect to n
-    const auto tangent = t - n * glm::dot(n, t);
-    vertex.tangent = glm::vec4(glm::normalize(tangent), 0);
+    positions[i] = vertex.position;
+    normals[i] = vertex.normal;
+    texCoords[i] = vertex.texCoord;
+  }
 
-    // Compute handedness of re-orthogonalized basis
-    const auto b{glm::cross(n, t)};
-    const auto handedness{glm::dot(b, bitangents.at(i))};
-    vertex.tangent.w = (handedness < 0.0f) ? -1.0f : 1.0f;
+  const auto tangents{abcg::mesh::computeTangents(positions, normals, texCoords,
+                                                  m_indices, vertexFaces)};
+  for (auto&& [vertex, tangent] : iter::zip(m_vertices, tangents)) {
+    vertex.tangent = tangent;
   }
-}
\ No newline at end of file
+}
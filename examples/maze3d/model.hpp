@@ -1,26 +1,40 @@
 #ifndef MODEL_HPP_
 #define MODEL_HPP_
 
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
 #include "abcg.hpp"
+#include "vertex.hpp"
 
-struct Vertex {
-  glm::vec3 position{};
-  glm::vec3 normal{};
-  glm::vec2 texCoord{};
-  glm::vec4 tangent{};
-
-  bool operator==(const Vertex& other) const noexcept {
-    static const auto epsilon{std::numeric_limits<float>::epsilon()};
-    return glm::all(glm::epsilonEqual(position, other.position, epsilon)) &&
-           glm::all(glm::epsilonEqual(normal, other.normal, epsilon)) &&
-           glm::all(glm::epsilonEqual(texCoord, other.texCoord, epsilon));
-  }
+enum class VertexFormat { Float, PackedHalf, PackedSnorm16 };
+
+struct Material {
+  glm::vec4 Ka{0.1f, 0.1f, 0.1f, 1.0f};
+  glm::vec4 Kd{0.7f, 0.7f, 0.7f, 1.0f};
+  glm::vec4 Ks{1.0f, 1.0f, 1.0f, 1.0f};
+  float shininess{25.0f};
+  GLuint diffuseTexture{};
+  GLuint normalTexture{};
+  // Files of the textures, created by Model::upload
+  std::string diffuseTexturePath;
+  std::string normalTexturePath;
+};
+
+// Range of m_indices drawn with the same material
+struct Submesh {
+  std::size_t firstIndex{};
+  std::size_t numIndices{};
+  std::size_t materialID{};
 };
 
 class Model {
  public:
   Model() = default;
-  virtual ~Model();
+  virtual ~Model() = default;
 
   Model(const Model&) = delete;
   Model(Model&&) = default;
@@ -31,37 +45,73 @@ class Model {
   void loadDiffuseTexture(std::string_view path);
   void loadNormalTexture(std::string_view path);
   void loadFromFile(std::string_view path, bool standardize = true);
+  void enqueue(abcg::CommandList& commandList,
+               const abcg::InstanceTransform& transform,
+               unsigned int layer = 0) const;
   void render() const;
   void setupVAO(GLuint program);
+  void setVertexFormat(VertexFormat format);
+  void upload();
 
-  [[nodiscard]] glm::vec4 getKa() const { return m_Ka; }
-  [[nodiscard]] glm::vec4 getKd() const { return m_Kd; }
-  [[nodiscard]] glm::vec4 getKs() const { return m_Ks; }
-  [[nodiscard]] float getShininess() const { return m_shininess; }
+  [[nodiscard]] std::size_t getUploadSize() const;
+  [[nodiscard]] VertexFormat getVertexFormat() const { return m_vertexFormat; }
+  [[nodiscard]] std::size_t getVertexBufferSize() const {
+    return m_vertexBufferSize;
+  }
+
+  [[nodiscard]] const std::vector<Material>& getMaterials() const {
+    return m_materials;
+  }
+  [[nodiscard]] const std::vector<Submesh>& getSubmeshes() const {
+    return m_submeshes;
+  }
 
  private:
-  GLuint m_VAO{};
-  GLuint m_VBO{};
-  GLuint m_EBO{};
-
-  glm::vec4 m_Ka;
-  glm::vec4 m_Kd;
-  glm::vec4 m_Ks;
-  float m_shininess;
-  GLuint m_diffuseTexture{};
-  GLuint m_normalTexture{};
-  GLuint m_cubeTexture{};
-  
+  abcg::VertexArray m_VAO;
+  abcg::Buffer m_VBO;
+  abcg::Buffer m_EBO;
+
+  std::vector<Material> m_materials;
+  std::vector<Submesh> m_submeshes;
+  abcg::Texture m_cubeTexture;
+
+  // Sampler objects owned by abcg::opengl::getSampler
+  GLuint m_sampler{};
+  GLuint m_cubeSampler{};
+
+  // Textures shared by the materials, indexed by file path
+  std::unordered_map<std::string, abcg::Texture> m_textures;
+
+  // Images decoded by loadFromFile and loadCubeTexture, waiting for upload
+  std::unordered_map<std::string, abcg::opengl::Image> m_images;
+  std::optional<std::array<abcg::opengl::Image, 6>> m_cubeImages;
+
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
 
+  VertexFormat m_vertexFormat{VertexFormat::Float};
+  std::size_t m_vertexBufferSize{};
+  GLenum m_positionType{GL_FLOAT};
+  GLenum m_texCoordType{GL_FLOAT};
+  GLuint m_program{};
+  GLint m_packedVerticesLoc{-1};
+  GLint m_modelMatrixLoc{-1};
+  GLint m_normalMatrixLoc{-1};
+  GLint m_KaLoc{-1};
+  GLint m_KdLoc{-1};
+  GLint m_KsLoc{-1};
+  GLint m_shininessLoc{-1};
+
   bool m_hasNormals{false};
   bool m_hasTexCoords{false};
 
   void createBuffers();
+  [[nodiscard]] std::string decodeTexture(const std::string& path);
+  [[nodiscard]] GLuint loadTexture(const std::string& path);
+  [[nodiscard]] std::vector<PackedVertex> packVertices();
   void standardize();
-  void computeNormals();
-  void computeTangents();
+  void computeNormals(const abcg::mesh::VertexFaces& vertexFaces);
+  void computeTangents(const abcg::mesh::VertexFaces& vertexFaces);
 };
 
 #endif
\ No newline at end of file
@@ -4,7 +4,6 @@
 #include <fmt/core.h>
 
 #include <cppitertools/itertools.hpp>
-#include <glm/gtc/matrix_inverse.hpp>
 
 const auto epsilon{std::numeric_limits<float>::epsilon()};
 
@@ -24,6 +23,15 @@ void OpenGLWindow::handleEvent(SDL_Event& ev) {
 
     if (ev.key.keysym.sym == SDLK_f)
       m_isFlashlightOn = !m_isFlashlightOn;
+
+    if (ev.key.keysym.sym == SDLK_v)
+      setVertexFormat(m_vertexFormat == VertexFormat::Float ? VertexFormat::PackedSnorm16 : VertexFormat::Float);
+
+    if (ev.key.keysym.sym == SDLK_g) {
+      auto openGLSettings{getOpenGLSettings()};
+      openGLSettings.debugOutput = !openGLSettings.debugOutput;
+      setOpenGLSettings(openGLSettings);
+    }
     
     if (ev.key.keysym.sym == SDLK_ESCAPE)
       m_screenFocus = false;
@@ -54,10 +62,16 @@ void OpenGLWindow::initializeGL() {
 }
 
 void OpenGLWindow::initializeModels() {
-  glClearColor(0, 0, 0, 1);
+  abcg::glClearColor(0, 0, 0, 1);
+
+  auto& stateCache{getStateCache()};
 
   // Enable depth buffering
-  glEnable(GL_DEPTH_TEST);
+  stateCache.enable(GL_DEPTH_TEST);
+
+  // The skybox is drawn at the far plane
+  stateCache.depthFunc(GL_LEQUAL);
+  stateCache.frontFace(GL_CCW);
 
   // Create programs
   m_program = createProgramFromFile(getAssetsPath() + "shaders/normalmapping.vert",
@@ -66,29 +80,76 @@ void OpenGLWindow::initializeModels() {
   m_skyProgram = createProgramFromFile(getAssetsPath() + "shaders/skybox.vert",
                                        getAssetsPath() + "shaders/skybox.frag");
 
-  m_finalscreenTexture = abcg::opengl::loadTexture(getAssetsPath() + "maps/finalscreen.jpg");
+  // Camera and light data of both programs are read from binding point 0
+  m_frameData.create(0);
+  for (const auto program : {m_program, m_skyProgram}) {
+    m_frameData.bindProgram(program, "FrameData");
+  }
 
-  // Load models
-  m_grassModel.loadFromFile(getAssetsPath() + "models/grass.obj", false);
-  m_grassModel.setupVAO(m_program);
+  // Texture units of the samplers never change
+  stateCache.useProgram(m_program);
+  abcg::glUniform1i(abcg::glGetUniformLocation(m_program, "diffuseTex"), 0);
+  abcg::glUniform1i(abcg::glGetUniformLocation(m_program, "normalTex"), 1);
+  stateCache.useProgram(m_skyProgram);
+  abcg::glUniform1i(abcg::glGetUniformLocation(m_skyProgram, "skyTex"), 2);
+  stateCache.useProgram(0);
+
+  // Models and textures are read and decoded on worker threads, and
+  // uploaded by paintGL a few at a time. Each model is drawn as soon as it is
+  // uploaded
+  auto finalscreenImage{std::make_shared<abcg::opengl::Image>()};
+  m_finalscreenAsset = m_assets.add(
+      [finalscreenImage, path = getAssetsPath() + "maps/finalscreen.jpg"] {
+        *finalscreenImage = abcg::opengl::loadImage(path);
+        return finalscreenImage->pixels.size();
+      },
+      [this, finalscreenImage] {
+        m_finalscreenTexture = abcg::opengl::createTexture(*finalscreenImage);
+      });
+
+  for (auto* model : {&m_grassModel, &m_wallModel, &m_flagModel, &m_skyModel}) {
+    model->setVertexFormat(m_vertexFormat);
+  }
 
-  m_wallModel.loadFromFile(getAssetsPath() + "models/wall.obj", false);
-  m_wallModel.setupVAO(m_program);
+  m_grassAsset = addModel(m_grassModel, getAssetsPath() + "models/grass.obj",
+                          false, m_program);
+  m_wallAsset = addModel(m_wallModel, getAssetsPath() + "models/wall.obj",
+                         false, m_program);
+  m_flagAsset = addModel(m_flagModel, getAssetsPath() + "models/flag.obj",
+                         true, m_program);
+  m_skyAsset = addModel(m_skyModel, getAssetsPath() + "models/skybox.obj",
+                        false, m_skyProgram, getAssetsPath() + "maps/cube/");
 
-  m_flagModel.loadFromFile(getAssetsPath() + "models/flag.obj", true);
-  m_flagModel.setupVAO(m_program);
+  m_mappingMode = 3;  // "From mesh" option
 
-  // Load cubemap
-  m_skyModel.loadFromFile(getAssetsPath() + "models/skybox.obj", false);
-  m_skyModel.loadCubeTexture(getAssetsPath() + "maps/cube/");
-  m_skyModel.setupVAO(m_skyProgram);
+#if !defined(__EMSCRIPTEN__)
+  abcg::glGenQueries(1, &m_timerQuery);
+#endif
+}
 
-  // Use material properties from the loaded model (they are the same)
-  m_Ka = m_wallModel.getKa();
-  m_Kd = m_wallModel.getKd();
-  m_Ks = m_wallModel.getKs();
-  m_shininess = m_wallModel.getShininess();
-  m_mappingMode = 3;  // "From mesh" option
+// Adds a model, and optionally its cube map, to the asset manager
+abcg::AssetManager::Handle OpenGLWindow::addModel(Model& model,
+                                                  const std::string& path,
+                                                  bool standardize,
+                                                  GLuint program,
+                                                  const std::string& cubePath) {
+  return m_assets.add(
+      [&model, path, standardize, cubePath] {
+        model.loadFromFile(path, standardize);
+        if (!cubePath.empty()) model.loadCubeTexture(cubePath);
+        return model.getUploadSize();
+      },
+      [&model, program] {
+        model.upload();
+        model.setupVAO(program);
+      });
+}
+
+void OpenGLWindow::setVertexFormat(VertexFormat format) {
+  m_vertexFormat = format;
+  for (auto* model : {&m_grassModel, &m_wallModel, &m_flagModel, &m_skyModel}) {
+    model->setVertexFormat(format);
+  }
 }
 
 void OpenGLWindow::initializeGameObjects() {
@@ -100,18 +161,53 @@ void OpenGLWindow::initializeGameObjects() {
 }
 
 void OpenGLWindow::paintGL() {
+  m_assets.update();
+
   if (m_gameOver)
     return;
 
   update();
 
   // Clear color buffer and depth buffer
-  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  abcg::glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+  abcg::glViewport(0, 0, m_viewportWidth, m_viewportHeight);
 
-  renderMaze();
-  renderSkybox();
+#if !defined(__EMSCRIPTEN__)
+  const auto measureGPUTime{!m_timerQueryPending};
+  if (measureGPUTime) abcg::glBeginQuery(GL_TIME_ELAPSED, m_timerQuery);
+#endif
+
+  updateFrameData();
+
+  {
+    ABCG_TRACE_SCOPE("Build command list");
+    updateTransforms();
+    m_commandList.clear();
+    renderMaze();
+    renderSkybox();
+  }
+  {
+    ABCG_TRACE_SCOPE("Submit command list");
+    m_commandList.submit();
+  }
+
+#if !defined(__EMSCRIPTEN__)
+  if (measureGPUTime) {
+    abcg::glEndQuery(GL_TIME_ELAPSED);
+    m_timerQueryPending = true;
+  } else {
+    // Read the result without stalling the pipeline
+    GLint available{};
+    abcg::glGetQueryObjectiv(m_timerQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available != 0) {
+      GLuint64 elapsed{};
+      abcg::glGetQueryObjectui64v(m_timerQuery, GL_QUERY_RESULT, &elapsed);
+      m_sceneGPUTime = static_cast<double>(elapsed) / 1.0e6;
+      m_timerQueryPending = false;
+    }
+  }
+#endif
 }
 
 void OpenGLWindow::paintUI() {
@@ -125,7 +221,8 @@ void OpenGLWindow::paintUI() {
   ImGui::Begin("OpenGL Texture Text", nullptr, flags);
 
   if (m_gameOver) {
-    ImGui::Image((void*)(intptr_t)m_finalscreenTexture, ImVec2(m_viewportWidth, m_viewportHeight));
+    if (m_assets.isReady(m_finalscreenAsset))
+      ImGui::Image((void*)(intptr_t)m_finalscreenTexture, ImVec2(m_viewportWidth, m_viewportHeight));
 
     if (!m_gameOverSound) {
       initializeSound(getAssetsPath() + "sounds/scary-scream.wav");
@@ -149,6 +246,38 @@ void OpenGLWindow::paintUI() {
     ImGui::Text("Press ESC to lose screen focus");
     ImGui::Text("Press WASD to move");
     ImGui::Text("Press F to turn on/off the flashlight");
+    ImGui::Text("Press V to toggle packed vertices");
+#if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+    ImGui::Text("Press G to toggle GL error checking mode");
+#endif
+    ImGui::Spacing();
+
+    if (!m_assets.isDone()) {
+      ImGui::Text("Loading assets");
+      ImGui::ProgressBar(m_assets.getProgress(), ImVec2(200, 0));
+    }
+
+    std::size_t vertexBufferSize{};
+    for (const auto* model : {&m_grassModel, &m_wallModel, &m_flagModel, &m_skyModel}) {
+      vertexBufferSize += model->getVertexBufferSize();
+    }
+    ImGui::Text("Vertex buffers: %zu bytes (%s)", vertexBufferSize,
+                m_vertexFormat == VertexFormat::Float ? "float" : "packed");
+    const auto stateCalls{getStateCache().getFrameCounters()};
+    ImGui::Text("Draw calls: %zu", m_commandList.size());
+    ImGui::Text("Uniform calls: %zu", m_commandList.getNumUniformCalls());
+    ImGui::Text("State calls: %zu issued, %zu skipped", stateCalls.issued,
+                stateCalls.skipped);
+#if !defined(__EMSCRIPTEN__)
+    ImGui::Text("Scene GPU time: %.3f ms", m_sceneGPUTime);
+#endif
+#if !defined(NDEBUG) && !defined(__EMSCRIPTEN__) && !defined(__APPLE__)
+    // Compare with the frame time when errors are checked with glGetError
+    ImGui::Text("Frame time: %.3f ms (%s)",
+                1000.0f / ImGui::GetIO().Framerate,
+                abcg::isGLDebugOutputEnabled ? "KHR_debug output"
+                                             : "glGetError");
+#endif
 
     m_gameOverTimer.restart();
   }
@@ -164,123 +293,85 @@ void OpenGLWindow::resizeGL(int width, int height) {
 }
 
 void OpenGLWindow::terminateGL() { 
-  glDeleteProgram(m_program); 
-  glDeleteProgram(m_skyProgram);
+  abcg::glDeleteProgram(m_program); 
+  abcg::glDeleteProgram(m_skyProgram);
+  m_frameData.destroy();
+
+#if !defined(__EMSCRIPTEN__)
+  abcg::glDeleteQueries(1, &m_timerQuery);
+#endif
 }
 
-void OpenGLWindow::renderMaze() {
-  glUseProgram(m_program);
+void OpenGLWindow::updateFrameData() {
+  // Camera and light data shared by every program, uploaded in one call
+  FrameData frameData;
+  frameData.viewMatrix = m_camera.m_viewMatrix;
+  frameData.projMatrix = m_camera.m_projMatrix;
+  frameData.lightDirWorldSpace = glm::vec4(m_camera.m_at - m_camera.m_eye, 0.0f);
+  frameData.lightPosWorldSpace = glm::vec4(m_camera.m_eye, 1.0f);
+  frameData.Ia = m_Ia;
+  frameData.Id = m_Id;
+  frameData.Is = m_Is;
+  frameData.lightCutOff = m_isFlashlightOn ? m_lightCutOff : m_lightOff;
+  frameData.lightOuterCutOff = m_isFlashlightOn ? m_lightOuterCutOff : m_lightOff;
+  frameData.mappingMode = m_mappingMode;
+  m_frameData.update(frameData);
+}
 
-  // Get location of uniform variables (could be precomputed)
-  GLint modelMatrixLoc{glGetUniformLocation(m_program, "modelMatrix")};
-  GLint viewMatrixLoc{glGetUniformLocation(m_program, "viewMatrix")};
-  GLint projMatrixLoc{glGetUniformLocation(m_program, "projMatrix")};
-  GLint normalMatrixLoc{glGetUniformLocation(m_program, "normalMatrix")};
-  
-  GLint lightDirLoc{glGetUniformLocation(m_program, "lightDirWorldSpace")};
-  GLint lightPosLoc{glGetUniformLocation(m_program, "lightPosWorldSpace")};
-  GLint lightCutOffLoc{glGetUniformLocation(m_program, "lightCutOff")};
-  GLint lightOuterCutOffLoc{glGetUniformLocation(m_program, "lightOuterCutOff")};
-
-  GLint IaLoc{glGetUniformLocation(m_program, "Ia")};
-  GLint IdLoc{glGetUniformLocation(m_program, "Id")};
-  GLint IsLoc{glGetUniformLocation(m_program, "Is")};
-  GLint KaLoc{glGetUniformLocation(m_program, "Ka")};
-  GLint KdLoc{glGetUniformLocation(m_program, "Kd")};
-  GLint KsLoc{glGetUniformLocation(m_program, "Ks")};
-  GLint shininessLoc{glGetUniformLocation(m_program, "shininess")};
-
-  GLint diffuseTexLoc{glGetUniformLocation(m_program, "diffuseTex")};
-  GLint normalTexLoc{glGetUniformLocation(m_program, "normalTex")};
-  GLint mappingModeLoc{glGetUniformLocation(m_program, "mappingMode")};
-
-  // Set uniform variables that will be used for every scene object
-  glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_camera.m_viewMatrix[0][0]);
-  glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_camera.m_projMatrix[0][0]);
-  glUniform1i(diffuseTexLoc, 0);
-  glUniform1i(normalTexLoc, 1);
-  glUniform1i(mappingModeLoc, m_mappingMode);
-
-  glm::vec4 lightDir(m_camera.m_at - m_camera.m_eye, 0.0f);
-  glm::vec4 lightPos(m_camera.m_eye, 1.0f);
-  glUniform4fv(lightDirLoc, 1, &lightDir.x);
-  glUniform4fv(lightPosLoc, 1, &lightPos.x);
-  glUniform1f(lightCutOffLoc, m_isFlashlightOn ? m_lightCutOff : m_lightOff);
-  glUniform1f(lightOuterCutOffLoc, m_isFlashlightOn ? m_lightOuterCutOff : m_lightOff);
-
-  glUniform4fv(IaLoc, 1, &m_Ia.x);
-  glUniform4fv(IdLoc, 1, &m_Id.x);
-  glUniform4fv(IsLoc, 1, &m_Is.x);
-  glUniform4fv(KaLoc, 1, &m_Ka.x);
-  glUniform4fv(KdLoc, 1, &m_Kd.x);
-  glUniform4fv(KsLoc, 1, &m_Ks.x);
-  glUniform1f(shininessLoc, m_shininess);
-
-  // Draw all wall boxes by setting uniform variables of the current object
+void OpenGLWindow::updateTransforms() {
+  // Model, model-view and normal matrices of every object, computed in a
+  // single SIMD batch
+  m_transformBatch.clear();
   for (size_t i = 0; i < m_maze.m_mazeMatrix.size(); i++) {
     for (size_t j = 0; j < m_maze.m_mazeMatrix[i].size(); j++) {
       float xPos =  static_cast<float>(i);
       float yPos =  static_cast<float>(j);
-
-      glm::mat4 modelMatrix{1.0f};
-      modelMatrix = glm::translate(modelMatrix, glm::vec3(xPos, 0.0f, yPos));
-      glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &modelMatrix[0][0]);
-
-      auto modelViewMatrix{glm::mat3(m_camera.m_viewMatrix * modelMatrix)};
-      glm::mat3 normalMatrix{glm::inverseTranspose(modelViewMatrix)};
-      glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, &normalMatrix[0][0]);
-        
-      if (m_maze.isBox(i, j)) {
-        m_wallModel.render();
-      }
-      else {
-        m_grassModel.render();
-      }
+      m_transformBatch.push(glm::vec3(xPos, 0.0f, yPos));
     }
   }
 
-  // Draw flag (end position)
-  glm::mat4 modelMatrix{1.0f};
-  modelMatrix = glm::translate(modelMatrix, m_maze.m_endPosition);
-  glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &modelMatrix[0][0]);
-
-  auto modelViewMatrix{glm::mat3(m_camera.m_viewMatrix * modelMatrix)};
-  glm::mat3 normalMatrix{glm::inverseTranspose(modelViewMatrix)};
-  glUniformMatrix3fv(normalMatrixLoc, 1, GL_FALSE, &normalMatrix[0][0]);
-
-  m_flagModel.render();
-
-  glUseProgram(0);
-}
-
-void OpenGLWindow::renderSkybox() {
-  glUseProgram(m_skyProgram);
-
-  // Get location of uniform variables
-  GLint modelMatrixLoc{glGetUniformLocation(m_skyProgram, "modelMatrix")};
-  GLint viewMatrixLoc{glGetUniformLocation(m_skyProgram, "viewMatrix")};
-  GLint projMatrixLoc{glGetUniformLocation(m_skyProgram, "projMatrix")};
-  GLint skyTexLoc{glGetUniformLocation(m_skyProgram, "skyTex")};
-
-  // Set uniform variables
-  glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_camera.m_viewMatrix[0][0]);
-  glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_camera.m_projMatrix[0][0]);
-  glUniform1i(skyTexLoc, 2);
+  // Flag (end position)
+  m_transformBatch.push(m_maze.m_endPosition);
 
+  // Skybox
   float xTranslation = m_maze.m_mazeMatrix.size() / 2 ;
   float yTranslation = m_maze.m_mazeMatrix[0].size() / 2;
   float skyboxScale = std::max(m_maze.m_mazeMatrix.size(), m_maze.m_mazeMatrix[0].size()) * 50;
+  m_transformBatch.push(
+      glm::vec3(xTranslation, 0.0f, yTranslation), skyboxScale,
+      glm::angleAxis(glm::radians(-m_moonAngle), glm::vec3(1, 0, 0)));
 
-  glm::mat4 modelMatrix{1.0f};
-  modelMatrix = glm::translate(modelMatrix, glm::vec3(xTranslation, 0.0f, yTranslation));
-  modelMatrix = glm::scale(modelMatrix, glm::vec3(skyboxScale, skyboxScale, skyboxScale));
-  modelMatrix = glm::rotate(modelMatrix, glm::radians(-m_moonAngle), glm::vec3(1, 0, 0));
-
-  glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &modelMatrix[0][0]);
+  m_transformBatch.compute(m_camera.m_viewMatrix, m_transforms);
+}
 
-  m_skyModel.render();
+void OpenGLWindow::renderMaze() {
+  // Record all wall boxes and grass tiles, one maze cell per item, on worker
+  // threads. Material properties and per-object matrices are set when the
+  // command list is submitted. Models still loading are skipped
+  const auto numColumns{m_maze.m_mazeMatrix[0].size()};
+  const auto numCells{m_maze.m_mazeMatrix.size() * numColumns};
+  const auto wallReady{m_assets.isReady(m_wallAsset)};
+  const auto grassReady{m_assets.isReady(m_grassAsset)};
+  m_commandList.recordParallel(
+      numCells, [&](abcg::CommandList& commandList, std::size_t index) {
+        const auto& transform{m_transforms.at(index)};
+        if (m_maze.isBox(index / numColumns, index % numColumns)) {
+          if (wallReady) m_wallModel.enqueue(commandList, transform);
+        }
+        else {
+          if (grassReady) m_grassModel.enqueue(commandList, transform);
+        }
+      });
+
+  // Record flag (end position)
+  if (m_assets.isReady(m_flagAsset))
+    m_flagModel.enqueue(m_commandList, m_transforms.at(numCells));
+}
 
-  glUseProgram(0);
+void OpenGLWindow::renderSkybox() {
+  // Drawn after the maze so that only uncovered pixels are shaded
+  if (m_assets.isReady(m_skyAsset))
+    m_skyModel.enqueue(m_commandList, m_transforms.back(), 1);
 }
 
 void OpenGLWindow::update() {
@@ -338,7 +429,7 @@ glm::vec2 OpenGLWindow::getRotationSpeedFromMouse() {
   }
 
   glm::ivec2 mousePosition;
-  SDL_GetMouseState(&mousePosition.x, &mousePosition.y);  
+  getMouseState(&mousePosition.x, &mousePosition.y);  
 
   float maxMovement{0.9f};
   float speedScale{50.0f};
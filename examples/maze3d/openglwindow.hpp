@@ -6,6 +6,21 @@
 #include "camera.hpp"
 #include "maze.hpp"
 
+// Per-frame camera and light data (std140 layout of the FrameData block)
+struct FrameData {
+  glm::mat4 viewMatrix{1.0f};
+  glm::mat4 projMatrix{1.0f};
+  glm::vec4 lightDirWorldSpace{};
+  glm::vec4 lightPosWorldSpace{};
+  glm::vec4 Ia{};
+  glm::vec4 Id{};
+  glm::vec4 Is{};
+  float lightCutOff{};
+  float lightOuterCutOff{};
+  int mappingMode{};
+  float padding{};
+};
+
 class OpenGLWindow : public abcg::OpenGLWindow {
  protected:
   void handleEvent(SDL_Event& ev) override;
@@ -27,6 +42,28 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   Model m_wallModel;
   Model m_flagModel;
   Model m_skyModel;
+  VertexFormat m_vertexFormat{VertexFormat::PackedSnorm16};
+
+  // Models and textures loaded in the background. Declared after the models
+  // so that pending loads finish before the models are destroyed
+  abcg::AssetManager m_assets;
+  abcg::AssetManager::Handle m_grassAsset{};
+  abcg::AssetManager::Handle m_wallAsset{};
+  abcg::AssetManager::Handle m_flagAsset{};
+  abcg::AssetManager::Handle m_skyAsset{};
+  abcg::AssetManager::Handle m_finalscreenAsset{};
+
+  abcg::CommandList m_commandList;
+
+  // Transforms of the maze cells, followed by the flag and the skybox
+  abcg::TransformBatch m_transformBatch;
+  std::vector<abcg::InstanceTransform> m_transforms;
+  abcg::UniformBlock<FrameData> m_frameData;
+
+  // GPU time spent rendering the scene, in milliseconds
+  GLuint m_timerQuery{};
+  bool m_timerQueryPending{false};
+  double m_sceneGPUTime{};
 
   Maze m_maze;
 
@@ -56,21 +93,21 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   float m_lightOuterCutOff{0.92f};
   float m_lightOff{2.00f};
 
-  // Material properties
-  glm::vec4 m_Ka;
-  glm::vec4 m_Kd;
-  glm::vec4 m_Ks;
-  float m_shininess{};
-
   // Audio elements
   SDL_AudioDeviceID m_deviceId;
   Uint8 *m_wavBuffer;
 
+  void updateFrameData();
+  void updateTransforms();
   void renderMaze();
   void renderSkybox();
   void update();
   void initializeSound(std::string path);
   void initializeModels();
+  abcg::AssetManager::Handle addModel(Model& model, const std::string& path,
+                                      bool standardize, GLuint program,
+                                      const std::string& cubePath = {});
+  void setVertexFormat(VertexFormat format);
   void initializeGameObjects();
   glm::vec2 getRotationSpeedFromMouse();
 };
@@ -0,0 +1,59 @@
+#include "vertex.hpp"
+
+#include <algorithm>
+#include <cppitertools/itertools.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/vector_relational.hpp>
+
+#include "abcg.hpp"
+
+namespace {
+std::array<std::int16_t, 2> packOctahedral(const glm::vec3& direction) {
+  const auto encoded{abcg::mesh::octahedralEncode(direction)};
+  return {static_cast<std::int16_t>(glm::packSnorm1x16(encoded.x)),
+          static_cast<std::int16_t>(glm::packSnorm1x16(encoded.y))};
+}
+}  // namespace
+
+bool positionsFitSnorm16(const std::vector<Vertex>& vertices) {
+  return std::all_of(vertices.begin(), vertices.end(), [](const auto& vertex) {
+    return glm::all(
+        glm::lessThanEqual(glm::abs(vertex.position), glm::vec3(1.0f)));
+  });
+}
+
+bool texCoordsFitUnorm16(const std::vector<Vertex>& vertices) {
+  return std::all_of(vertices.begin(), vertices.end(), [](const auto& vertex) {
+    return glm::all(glm::greaterThanEqual(vertex.texCoord, glm::vec2(0.0f))) &&
+           glm::all(glm::lessThanEqual(vertex.texCoord, glm::vec2(1.0f)));
+  });
+}
+
+std::vector<PackedVertex> packVertices(const std::vector<Vertex>& vertices,
+                                       bool snormPositions,
+                                       bool unormTexCoords) {
+  std::vector<PackedVertex> packedVertices;
+  packedVertices.reserve(vertices.size());
+  for (const auto& vertex : vertices) {
+    PackedVertex packed{};
+
+    const glm::vec4 position{vertex.position, vertex.tangent.w};
+    for (const auto i : iter::range(4)) {
+      packed.position.at(i) = snormPositions ? glm::packSnorm1x16(position[i])
+                                             : glm::packHalf1x16(position[i]);
+    }
+
+    packed.normal = packOctahedral(vertex.normal);
+    packed.tangent = packOctahedral(glm::vec3(vertex.tangent));
+
+    for (const auto i : iter::range(2)) {
+      packed.texCoord.at(i) = unormTexCoords
+                                  ? glm::packUnorm1x16(vertex.texCoord[i])
+                                  : glm::packHalf1x16(vertex.texCoord[i]);
+    }
+
+    packedVertices.push_back(packed);
+  }
+
+  return packedVertices;
+}
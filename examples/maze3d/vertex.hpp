@@ -0,0 +1,43 @@
+#ifndef VERTEX_HPP_
+#define VERTEX_HPP_
+
+#include <array>
+#include <cstdint>
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <vector>
+
+// Vertex layouts of Model, shared with the vertexpacking benchmark
+
+struct Vertex {
+  glm::vec3 position{};
+  glm::vec3 normal{};
+  glm::vec2 texCoord{};
+  glm::vec4 tangent{};
+};
+
+// Compact vertex layout (20 bytes instead of 48)
+struct PackedVertex {
+  // xyz: snorm16 or half-float position; w: tangent handedness
+  std::array<std::uint16_t, 4> position{};
+  // Octahedral-encoded unit vectors as snorm16
+  std::array<std::int16_t, 2> normal{};
+  std::array<std::int16_t, 2> tangent{};
+  // unorm16 or half-float texture coordinates
+  std::array<std::uint16_t, 2> texCoord{};
+};
+
+// Whether the positions are in [-1, 1], as required by snorm16, and the
+// texture coordinates are in [0, 1], as required by unorm16
+[[nodiscard]] bool positionsFitSnorm16(const std::vector<Vertex>& vertices);
+[[nodiscard]] bool texCoordsFitUnorm16(const std::vector<Vertex>& vertices);
+
+// Positions are packed as snorm16 if snormPositions is true, and texture
+// coordinates as unorm16 if unormTexCoords is true. Otherwise they are
+// packed as half-floats
+[[nodiscard]] std::vector<PackedVertex> packVertices(
+    const std::vector<Vertex>& vertices, bool snormPositions,
+    bool unormTexCoords);
+
+#endif
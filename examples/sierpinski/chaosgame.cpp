@@ -0,0 +1,91 @@
+#include "chaosgame.hpp"
+
+#include <algorithm>
+#include <cppitertools/itertools.hpp>
+
+#include "abcg.hpp"
+
+namespace {
+std::uint32_t xorshift32(std::uint32_t state) {
+  state ^= state << 13;
+  state ^= state >> 17;
+  state ^= state << 5;
+  return state;
+}
+}  // namespace
+
+void ChaosGame::seed(std::uint32_t seed, std::size_t numWorkers) {
+  m_workers.resize(std::max<std::size_t>(numWorkers, 1));
+
+  // Different nonzero seed for each chain, derived with splitmix32
+  auto next{seed};
+  for (auto &worker : m_workers) {
+    for (const auto lane : iter::range(m_numLanes)) {
+      auto z{next += 0x9e3779b9u};
+      z = (z ^ (z >> 16)) * 0x85ebca6bu;
+      z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+      z ^= z >> 16;
+      worker.state.at(lane) = z != 0 ? z : 1;
+      worker.x.at(lane) = 0.0f;
+      worker.y.at(lane) = 0.0f;
+    }
+
+    // Discard the first points, which may lie outside the attractor
+    std::array<Point, m_numLanes * 32> discarded{};
+    run(worker, discarded);
+  }
+}
+
+// Computes one point per element of points, distributing the work among the
+// workers with the job system
+void ChaosGame::iterate(gsl::span<Point> points) {
+  // Chunks cover all points, and are rounded up to whole blocks of lanes
+  const auto numWorkers{m_workers.size()};
+  const auto pointsPerWorker{(points.size() + numWorkers - 1) / numWorkers};
+  const auto chunkSize{(pointsPerWorker + m_numLanes - 1) / m_numLanes *
+                       m_numLanes};
+
+  abcg::JobSystem::global().parallelFor(
+      numWorkers, 1, [&](std::size_t firstWorker, std::size_t lastWorker) {
+        for (auto index{firstWorker}; index < lastWorker; ++index) {
+          const auto first{std::min(index * chunkSize, points.size())};
+          const auto last{std::min(first + chunkSize, points.size())};
+          run(m_workers.at(index), points.subspan(first, last - first));
+        }
+      });
+}
+
+void ChaosGame::run(Worker &worker, gsl::span<Point> points) {
+  // Work on local copies so that the compiler can keep them in registers
+  auto state{worker.state};
+  auto x{worker.x};
+  auto y{worker.y};
+
+  const auto numPoints{points.size()};
+  for (std::size_t first{}; first < numPoints; first += m_numLanes) {
+    std::array<Point, m_numLanes> block{};
+    for (std::size_t lane{}; lane < m_numLanes; ++lane) {
+      state[lane] = xorshift32(state[lane]);
+
+      // Vertex index in [0, 3) without division
+      const auto vertex{static_cast<std::uint32_t>(
+          (static_cast<std::uint64_t>(state[lane]) * 3) >> 32)};
+
+      // Vertices (0, 1), (-1, -1) and (1, -1), selected without branches
+      const auto vx{vertex == 0 ? 0.0f : static_cast<float>(vertex) * 2 - 3};
+      const auto vy{vertex == 0 ? 1.0f : -1.0f};
+      x[lane] = (x[lane] + vx) * 0.5f;
+      y[lane] = (y[lane] + vy) * 0.5f;
+
+      block[lane] = {static_cast<std::int16_t>(x[lane] * 32767.0f),
+                     static_cast<std::int16_t>(y[lane] * 32767.0f)};
+    }
+
+    const auto count{std::min(m_numLanes, numPoints - first)};
+    std::copy_n(block.begin(), count, points.begin() + first);
+  }
+
+  worker.state = state;
+  worker.x = x;
+  worker.y = y;
+}
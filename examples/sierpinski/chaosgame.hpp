@@ -0,0 +1,35 @@
+#ifndef CHAOSGAME_HPP_
+#define CHAOSGAME_HPP_
+
+#include <array>
+#include <cstdint>
+#include <gsl/gsl>
+#include <vector>
+
+// Batched chaos game for the Sierpinski triangle. Each worker runs several
+// independent chains in lockstep so that the inner loop can be
+// vectorized by the compiler
+class ChaosGame {
+ public:
+  // Point in [-1, 1] as normalized 16-bit integers
+  using Point = std::array<std::int16_t, 2>;
+
+  void seed(std::uint32_t seed, std::size_t numWorkers);
+  void iterate(gsl::span<Point> points);
+
+ private:
+  static constexpr std::size_t m_numLanes{16};
+
+  struct Worker {
+    // xorshift32 state and current position of each chain
+    std::array<std::uint32_t, m_numLanes> state{};
+    std::array<float, m_numLanes> x{};
+    std::array<float, m_numLanes> y{};
+  };
+
+  std::vector<Worker> m_workers;
+
+  static void run(Worker &worker, gsl::span<Point> points);
+};
+
+#endif
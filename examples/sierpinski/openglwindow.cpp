@@ -3,7 +3,7 @@
 #include <fmt/core.h>
 #include <imgui.h>
 
-#include <chrono>
+#include <algorithm>
 
 #include "abcg.hpp"
 
@@ -17,14 +17,42 @@ void OpenGLWindow::initializeGL() {
     }
   )gl"};
 
+  // Each point adds one hit to the density buffer
   const auto *fragmentShader{R"gl(
     #version 410
     out vec4 outColor;
     void main() { outColor = vec4(1); }
   )gl"};
 
-  // Create shader program
+  // Full-screen triangle that maps the density to a brightness
+  const auto *displayVertexShader{R"gl(
+    #version 410
+    out vec2 fragTexCoord;
+    void main() {
+      vec2 position = vec2(gl_VertexID == 1 ? 3.0 : -1.0,
+                           gl_VertexID == 2 ? 3.0 : -1.0);
+      fragTexCoord = position * 0.5 + 0.5;
+      gl_Position = vec4(position, 0, 1);
+    }
+  )gl"};
+
+  const auto *displayFragmentShader{R"gl(
+    #version 410
+    in vec2 fragTexCoord;
+    out vec4 outColor;
+    uniform highp sampler2D densityTex;
+    uniform highp float exposure;
+    void main() {
+      highp float density = texture(densityTex, fragTexCoord).r;
+      outColor = vec4(vec3(1.0 - exp(-density * exposure)), 1);
+    }
+  )gl"};
+
+  // Create shader programs
   m_program = createProgramFromString(vertexShader, fragmentShader);
+  m_displayProgram =
+      createProgramFromString(displayVertexShader, displayFragmentShader);
+  m_exposureLoc = glGetUniformLocation(m_displayProgram, "exposure");
 
   // Clear window
   glClearColor(0, 0, 0, 1);
@@ -37,46 +65,102 @@ void OpenGLWindow::initializeGL() {
   glGetFloatv(GL_ALIASED_POINT_SIZE_RANGE, sizes.data());
   fmt::print("Point size: {:.2f} (min), {:.2f} (max)\n", sizes[0], sizes[1]);
 
+  // Create the VAOs once. Points are streamed to a new offset every frame
+  setupModel();
+  glGenVertexArrays(1, &m_displayVAO);
+
   // Start pseudo-random number generator
-  auto seed{std::chrono::steady_clock::now().time_since_epoch().count()};
-  m_randomEngine.seed(seed);
+  m_randomEngine.seed(abcg::randomSeed());
 
   // Randomly choose a pair of coordinates in the interval [-1; 1]
   std::uniform_real_distribution<float> realDistribution(-1.0f, 1.0f);
   m_P.x = realDistribution(m_randomEngine);
   m_P.y = realDistribution(m_randomEngine);
+
+  // One worker per thread of the job system for the batched mode
+  const auto numWorkers{abcg::JobSystem::global().getNumWorkers() + 1};
+  m_chaosGame.seed(static_cast<std::uint32_t>(m_randomEngine()), numWorkers);
 }
 
 void OpenGLWindow::paintGL() {
-  // Create OpenGL buffers for the single point at m_P
-  setupModel();
+  m_vertexStream.beginFrame();
+
+  std::size_t count{1};
+  std::size_t offset{};
+  if (m_batched) {
+    // Compute the points of all chains in parallel
+    count = std::size_t{1} << m_log2IterationsPerFrame;
+    m_batch.resize(count);
+    m_chaosGame.iterate(m_batch);
+    offset = m_vertexStream.push(m_batch);
+  } else {
+    // Upload the single point at m_P
+    const ChaosGame::Point point{static_cast<std::int16_t>(m_P.x * 32767.0f),
+                                 static_cast<std::int16_t>(m_P.y * 32767.0f)};
+    offset = m_vertexStream.push(std::array{point});
+
+    // Randomly choose a triangle vertex index
+    std::uniform_int_distribution<int> intDistribution(0, m_points.size() - 1);
+    int index{intDistribution(m_randomEngine)};
+
+    // The new position is the midpoint between the current position and the
+    // chosen vertex
+    m_P = (m_P + m_points.at(index)) / 2.0f;
+  }
 
-  // Set the viewport
+  // Accumulate the hits into the density buffer
+  glBindFramebuffer(GL_FRAMEBUFFER, m_densityFBO);
   glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+  glEnable(GL_BLEND);
+  glBlendFunc(GL_ONE, GL_ONE);
 
   // Start using VAO
   glUseProgram(m_program);
-  // Start using buffers created in createBuffers()
+  // Start using buffers created in setupModel()
   glBindVertexArray(m_vao);
 
-  // Draw a single point
-  glDrawArrays(GL_POINTS, 0, 1);
+  glDrawArrays(GL_POINTS, static_cast<GLint>(offset / sizeof(ChaosGame::Point)),
+               static_cast<GLsizei>(count));
 
   // End using VAO
   glBindVertexArray(0);
   // End using the shader program
   glUseProgram(0);
-  
-  // Randomly choose a triangle vertex index
-  std::uniform_int_distribution<int> intDistribution(0, m_points.size() - 1);
-  int index{intDistribution(m_randomEngine)};
 
-  // The new position is the midpoint between the current position and the
-  // chosen vertex
-  m_P = (m_P + m_points.at(index)) / 2.0f;
+  glDisable(GL_BLEND);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-  // Print coordinates to the console
-  // fmt::print("({:+.2f}, {:+.2f})\n", m_P.x, m_P.y);
+  m_totalIterations += count;
+  m_rateIterations += count;
+  if (m_rateTimer.elapsed() >= 1.0) {
+    m_iterationsPerSecond =
+        static_cast<double>(m_rateIterations) / m_rateTimer.restart();
+    m_rateIterations = 0;
+  }
+
+  // Show the density. The exposure keeps the average brightness constant as
+  // points accumulate, but never goes below what the precision of the
+  // density buffer can represent
+#if defined(__EMSCRIPTEN__)
+  const auto maxDensity{2048.0f};
+#else
+  const auto maxDensity{16777216.0f};
+#endif
+  const auto numPixels{static_cast<float>(m_viewportWidth * m_viewportHeight)};
+  const auto exposure{
+      std::max(4.0f * numPixels / static_cast<float>(m_totalIterations),
+               4.0f / maxDensity)};
+
+  glViewport(0, 0, m_viewportWidth, m_viewportHeight);
+  glUseProgram(m_displayProgram);
+  glUniform1f(m_exposureLoc, exposure);
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, m_densityTexture);
+  glBindVertexArray(m_displayVAO);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glBindVertexArray(0);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glUseProgram(0);
 }
 
 void OpenGLWindow::paintUI() {
@@ -87,9 +171,20 @@ void OpenGLWindow::paintUI() {
     ImGui::Begin(" ", nullptr, ImGuiWindowFlags_NoDecoration);
 
     if (ImGui::Button("Clear window", ImVec2(150, 30))) {
-      glClear(GL_COLOR_BUFFER_BIT);
+      clearDensity();
+    }
+
+    ImGui::Checkbox("Batched", &m_batched);
+    if (m_batched) {
+      ImGui::PushItemWidth(150);
+      ImGui::SliderInt("##iterations", &m_log2IterationsPerFrame, 0, 21,
+                       "2^%d per frame");
+      ImGui::PopItemWidth();
     }
 
+    ImGui::Text("%.2f M iterations/s", m_iterationsPerSecond / 1.0e6);
+    ImGui::Text("%.2f M points", static_cast<double>(m_totalIterations) / 1.0e6);
+
     ImGui::End();
   }
 }
@@ -98,29 +193,24 @@ void OpenGLWindow::resizeGL(int width, int height) {
   m_viewportWidth = width;
   m_viewportHeight = height;
 
-  glClear(GL_COLOR_BUFFER_BIT);
+  createDensityBuffer();
 }
 
 void OpenGLWindow::terminateGL() {
-  // Release shader program, VBO and VAO
+  // Release shader programs, VBO, VAOs and density buffer
   glDeleteProgram(m_program);
-  glDeleteBuffers(1, &m_vboVertices);
+  glDeleteProgram(m_displayProgram);
+  m_vertexStream.destroy();
   glDeleteVertexArrays(1, &m_vao);
+  glDeleteVertexArrays(1, &m_displayVAO);
+  glDeleteFramebuffers(1, &m_densityFBO);
+  glDeleteTextures(1, &m_densityTexture);
 }
 
 void OpenGLWindow::setupModel() {
-  // Release previous VBO and VAO
-  glDeleteBuffers(1, &m_vboVertices);
-  glDeleteVertexArrays(1, &m_vao);
-
-  // Generate a new VBO and get the associated ID
-  glGenBuffers(1, &m_vboVertices);
-  // Bind VBO in order to use it
-  glBindBuffer(GL_ARRAY_BUFFER, m_vboVertices);
-  // Upload data to VBO
-  glBufferData(GL_ARRAY_BUFFER, sizeof(m_P), &m_P, GL_STATIC_DRAW);
-  // Unbinding the VBO is allowed (data can be released now)
-  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  // Create the stream buffer for the points of a few frames
+  m_vertexStream.create(GL_ARRAY_BUFFER,
+                        (std::size_t{1} << 21) * sizeof(ChaosGame::Point));
 
   // Get location of attributes in the program
   GLint positionAttribute = glGetAttribLocation(m_program, "inPosition");
@@ -131,11 +221,55 @@ void OpenGLWindow::setupModel() {
   // Bind vertex attributes to current VAO
   glBindVertexArray(m_vao);
 
+  // Positions are normalized 16-bit integers
   glEnableVertexAttribArray(positionAttribute);
-  glBindBuffer(GL_ARRAY_BUFFER, m_vboVertices);
-  glVertexAttribPointer(positionAttribute, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glBindBuffer(GL_ARRAY_BUFFER, m_vertexStream.getBuffer());
+  glVertexAttribPointer(positionAttribute, 2, GL_SHORT, GL_TRUE, 0, nullptr);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   // End of binding to current VAO
   glBindVertexArray(0);
-}
\ No newline at end of file
+}
+
+void OpenGLWindow::createDensityBuffer() {
+  glDeleteFramebuffers(1, &m_densityFBO);
+  glDeleteTextures(1, &m_densityTexture);
+
+  // Floating-point texture with one hit counter per pixel. WebGL can only
+  // blend into 16-bit floating-point render targets
+#if defined(__EMSCRIPTEN__)
+  const GLint internalFormat{GL_R16F};
+#else
+  const GLint internalFormat{GL_R32F};
+#endif
+  glGenTextures(1, &m_densityTexture);
+  glBindTexture(GL_TEXTURE_2D, m_densityTexture);
+  glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_viewportWidth,
+               m_viewportHeight, 0, GL_RED, GL_FLOAT, nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+
+  glGenFramebuffers(1, &m_densityFBO);
+  glBindFramebuffer(GL_FRAMEBUFFER, m_densityFBO);
+  glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                         m_densityTexture, 0);
+  if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    throw abcg::Exception{
+        abcg::Exception::Runtime("Failed to create density framebuffer")};
+  }
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  clearDensity();
+}
+
+void OpenGLWindow::clearDensity() {
+  glBindFramebuffer(GL_FRAMEBUFFER, m_densityFBO);
+  glClearColor(0, 0, 0, 0);
+  glClear(GL_COLOR_BUFFER_BIT);
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+  m_totalIterations = 0;
+}
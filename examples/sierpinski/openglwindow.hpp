@@ -4,8 +4,10 @@
 #include <array>
 #include <glm/vec2.hpp>
 #include <random>
+#include <vector>
 
 #include "abcg.hpp"
+#include "chaosgame.hpp"
 
 class OpenGLWindow : public abcg::OpenGLWindow {
  protected:
@@ -17,20 +19,44 @@ class OpenGLWindow : public abcg::OpenGLWindow {
 
  private:
   GLuint m_vao{};
-  GLuint m_vboVertices{};
   GLuint m_program{};
 
+  // Per-frame vertex data
+  abcg::StreamBuffer m_vertexStream;
+
+  // Number of times each pixel was hit, accumulated with additive blending
+  GLuint m_densityFBO{};
+  GLuint m_densityTexture{};
+
+  // Program and (empty) VAO of the full-screen pass that shows the density
+  GLuint m_displayProgram{};
+  GLuint m_displayVAO{};
+  GLint m_exposureLoc{};
+
   int m_viewportWidth{};
   int m_viewportHeight{};
 
   std::random_device m_randomDevice;
   std::default_random_engine m_randomEngine;
 
-  const std::array<glm::vec2, 3> m_points{glm::vec2( 0,  1), 
+  const std::array<glm::vec2, 3> m_points{glm::vec2( 0,  1),
                                           glm::vec2(-1, -1),
                                           glm::vec2( 1, -1)};
   glm::vec2 m_P{};
 
+  // Batched mode: millions of points per frame computed by worker threads
+  bool m_batched{true};
+  int m_log2IterationsPerFrame{20};
+  ChaosGame m_chaosGame;
+  std::vector<ChaosGame::Point> m_batch;
+
+  std::uint64_t m_totalIterations{};
+  std::uint64_t m_rateIterations{};
+  abcg::ElapsedTimer m_rateTimer;
+  double m_iterationsPerSecond{};
+
   void setupModel();
+  void createDensityBuffer();
+  void clearDensity();
 };
-#endif
\ No newline at end of file
+#endif
@@ -3,45 +3,22 @@
 #include <fmt/core.h>
 #include <tiny_obj_loader.h>
 
+#include <algorithm>
 #include <cppitertools/itertools.hpp>
 #include <filesystem>
-#include <glm/gtx/hash.hpp>
-#include <unordered_map>
-
-// Custom specialization of std::hash injected in namespace std
-namespace std {
-template <>
-struct hash<Vertex> {
-  size_t operator()(Vertex const& vertex) const noexcept {
-    std::size_t h1{std::hash<glm::vec3>()(vertex.position)};
-    return h1;
-  }
-};
-}  // namespace std
-
-Model::~Model() {
-  glDeleteBuffers(1, &m_EBO);
-  glDeleteBuffers(1, &m_VBO);
-  glDeleteVertexArrays(1, &m_VAO);
-}
 
 void Model::createBuffers() {
-  // Delete previous buffers
-  glDeleteBuffers(1, &m_EBO);
-  glDeleteBuffers(1, &m_VBO);
-
-  // VBO
-  glGenBuffers(1, &m_VBO);
-  glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
-  glBufferData(GL_ARRAY_BUFFER, sizeof(m_vertices[0]) * m_vertices.size(),
-               m_vertices.data(), GL_STATIC_DRAW);
+  // VBO. Previous buffers are deleted when the new ones are created
+  m_VBO.create();
+  m_VBO.setData(GL_ARRAY_BUFFER, sizeof(m_vertices[0]) * m_vertices.size(),
+                m_vertices.data(), GL_STATIC_DRAW);
   glBindBuffer(GL_ARRAY_BUFFER, 0);
 
   // EBO
-  glGenBuffers(1, &m_EBO);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(m_indices[0]) * m_indices.size(),
-               m_indices.data(), GL_STATIC_DRAW);
+  m_EBO.create();
+  m_EBO.setData(GL_ELEMENT_ARRAY_BUFFER,
+                sizeof(m_indices[0]) * m_indices.size(), m_indices.data(),
+                GL_STATIC_DRAW);
   glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
@@ -72,8 +49,13 @@ void Model::loadFromFile(std::string_view path, bool standardize) {
   m_vertices.clear();
   m_indices.clear();
 
-  // A key:value map with key=Vertex and value=index
-  std::unordered_map<Vertex, GLuint> hash{};
+  // Table of unique vertices, reserved for the worst case of no shared
+  // vertices
+  std::size_t numCorners{};
+  for (const auto& shape : shapes) {
+    numCorners += shape.mesh.indices.size();
+  }
+  abcg::VertexDedup<Vertex> vertexDedup{numCorners};
 
   // Loop over shapes
   for (const auto& shape : shapes) {
@@ -91,46 +73,98 @@ void Model::loadFromFile(std::string_view path, bool standardize) {
       Vertex vertex{};
       vertex.position = {vx, vy, vz};
 
-      // If hash doesn't contain this vertex
-      if (hash.count(vertex) == 0) {
-        // Add this index (size of m_vertices)
-        hash[vertex] = m_vertices.size();
-        // Add this vertex
-        m_vertices.push_back(vertex);
-      }
-
-      m_indices.push_back(hash[vertex]);
+      m_indices.push_back(vertexDedup.insert(vertex));
     }
   }
+  m_vertices = vertexDedup.takeVertices();
 
   if (standardize) {
     this->standardize();
   }
 
+  computeBounds();
+  generateLODs();
   createBuffers();
 }
 
-void Model::render(int numTriangles) const {
-  glBindVertexArray(m_VAO);
+void Model::computeBounds() {
+  m_center = glm::vec3{0.0f};
+  for (const auto& vertex : m_vertices) {
+    m_center += vertex.position;
+  }
+  if (!m_vertices.empty()) {
+    m_center /= static_cast<float>(m_vertices.size());
+  }
+
+  m_radius = 0.0f;
+  for (const auto& vertex : m_vertices) {
+    m_radius = std::max(m_radius, glm::distance(m_center, vertex.position));
+  }
+}
+
+void Model::generateLODs() {
+  std::vector<glm::vec3> positions;
+  positions.reserve(m_vertices.size());
+  for (const auto& vertex : m_vertices) {
+    positions.push_back(vertex.position);
+  }
 
-  GLsizei numIndices = (numTriangles < 0) ? m_indices.size() : numTriangles * 3;
+  // Each level halves the number of triangles of the previous one. All
+  // levels share the same vertices, and their indices are appended to
+  // m_indices so that they can be stored in the same EBO
+  m_LODs = abcg::mesh::buildLODChain(positions, m_indices);
+}
 
-  glDrawElements(GL_TRIANGLES, numIndices, GL_UNSIGNED_INT, nullptr);
+void Model::render(int numTriangles, int lod) const {
+  glBindVertexArray(m_VAO.get());
+
+  const auto& range{m_LODs.at(lod)};
+  auto numIndices{range.numIndices};
+  if (numTriangles >= 0) {
+    numIndices = std::min<std::size_t>(numTriangles * 3, numIndices);
+  }
+
+  glDrawElements(
+      GL_TRIANGLES, static_cast<GLsizei>(numIndices), GL_UNSIGNED_INT,
+      reinterpret_cast<void*>(range.firstIndex * sizeof(m_indices[0])));
 
   glBindVertexArray(0);
 }
 
-void Model::setupVAO(GLuint program) {
-  // Release previous VAO
-  glDeleteVertexArrays(1, &m_VAO);
+// Draw packet of the given level of detail, without program and uniforms
+abcg::DrawPacket Model::getDrawPacket(int lod) const {
+  const auto& range{m_LODs.at(lod)};
 
-  // Create VAO
-  glGenVertexArrays(1, &m_VAO);
-  glBindVertexArray(m_VAO);
+  abcg::DrawPacket packet;
+  packet.VAO = m_VAO.get();
+  packet.first = range.firstIndex * sizeof(m_indices[0]);
+  packet.count = static_cast<GLsizei>(range.numIndices);
+  return packet;
+}
+
+int Model::selectLOD(const glm::mat4& modelViewMatrix,
+                     const glm::mat4& projMatrix, int viewportHeight) const {
+  // Transform the bounding sphere to eye space. The radius is scaled by the
+  // largest scale factor of the model-view matrix
+  const glm::vec3 center{modelViewMatrix * glm::vec4(m_center, 1.0f)};
+  const auto scale{std::max({glm::length(glm::vec3(modelViewMatrix[0])),
+                             glm::length(glm::vec3(modelViewMatrix[1])),
+                             glm::length(glm::vec3(modelViewMatrix[2]))})};
+
+  const auto diameter{abcg::mesh::projectedDiameter(
+      projMatrix, center, m_radius * scale, viewportHeight)};
+
+  return static_cast<int>(abcg::mesh::selectLOD(diameter, m_LODs.size()));
+}
+
+void Model::setupVAO(GLuint program) {
+  // Create VAO, releasing the previous one
+  m_VAO.create();
+  glBindVertexArray(m_VAO.get());
 
   // Bind EBO and VBO
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO);
-  glBindBuffer(GL_ARRAY_BUFFER, m_VBO);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO.get());
+  glBindBuffer(GL_ARRAY_BUFFER, m_VBO.get());
 
   // Bind vertex attributes
   GLint positionAttribute = glGetAttribLocation(program, "inPosition");
@@ -5,16 +5,12 @@
 
 struct Vertex {
   glm::vec3 position{};
-
-  bool operator==(const Vertex& other) const noexcept {
-    return position == other.position;
-  }
 };
 
 class Model {
  public:
   Model() = default;
-  virtual ~Model();
+  virtual ~Model() = default;
 
   Model(const Model&) = delete;
   Model(Model&&) = default;
@@ -22,22 +18,39 @@ class Model {
   Model& operator=(Model&&) = default;
 
   void loadFromFile(std::string_view path, bool standardize = true);
-  void render(int numTriangles = -1) const;
+  void render(int numTriangles = -1, int lod = 0) const;
+  [[nodiscard]] abcg::DrawPacket getDrawPacket(int lod = 0) const;
   void setupVAO(GLuint program);
 
-  [[nodiscard]] int getNumTriangles() const {
-    return static_cast<int>(m_indices.size()) / 3;
+  [[nodiscard]] int selectLOD(const glm::mat4& modelViewMatrix,
+                              const glm::mat4& projMatrix,
+                              int viewportHeight) const;
+
+  [[nodiscard]] int getNumLODs() const {
+    return static_cast<int>(m_LODs.size());
+  }
+  [[nodiscard]] int getNumTriangles(int lod = 0) const {
+    return static_cast<int>(m_LODs.at(lod).numIndices) / 3;
   }
 
  private:
-  GLuint m_VAO{};
-  GLuint m_VBO{};
-  GLuint m_EBO{};
+  abcg::VertexArray m_VAO;
+  abcg::Buffer m_VBO;
+  abcg::Buffer m_EBO;
 
   std::vector<Vertex> m_vertices;
   std::vector<GLuint> m_indices;
 
+  // Range of m_indices used by each level of detail
+  std::vector<abcg::mesh::IndexRange> m_LODs;
+
+  // Bounding sphere in model space
+  glm::vec3 m_center{};
+  float m_radius{};
+
+  void computeBounds();
   void createBuffers();
+  void generateLODs();
   void standardize();
 };
 
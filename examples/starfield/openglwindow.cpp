@@ -2,6 +2,7 @@
 
 #include <imgui.h>
 
+#include <atomic>
 #include <cppitertools/itertools.hpp>
 #include <glm/gtx/fast_trigonometry.hpp>
 
@@ -15,6 +16,12 @@ void OpenGLWindow::initializeGL() {
   m_program = createProgramFromFile(getAssetsPath() + "depth.vert",
                                     getAssetsPath() + "depth.frag");
 
+  // Get location of uniform variables
+  m_viewMatrixLoc = glGetUniformLocation(m_program, "viewMatrix");
+  m_projMatrixLoc = glGetUniformLocation(m_program, "projMatrix");
+  m_modelMatrixLoc = glGetUniformLocation(m_program, "modelMatrix");
+  m_colorLoc = glGetUniformLocation(m_program, "color");
+
   // Load model
   m_model.loadFromFile(getAssetsPath() + "box.obj");
 
@@ -60,44 +67,56 @@ void OpenGLWindow::paintGL() {
 
   glViewport(0, 0, m_viewportWidth, m_viewportHeight);
 
-  glUseProgram(m_program);
-
-  // Get location of uniform variables (could be precomputed)
-  GLint viewMatrixLoc{glGetUniformLocation(m_program, "viewMatrix")};
-  GLint projMatrixLoc{glGetUniformLocation(m_program, "projMatrix")};
-  GLint modelMatrixLoc{glGetUniformLocation(m_program, "modelMatrix")};
-  GLint colorLoc{glGetUniformLocation(m_program, "color")};
-
-  // Set uniform variables used by every scene object
-  glUniformMatrix4fv(viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
-  glUniformMatrix4fv(projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
-  glUniform4f(colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);  // White
+  // The command list binds the program through the state cache, so the
+  // uniform variables used by every scene object are set through it too
+  getStateCache().useProgram(m_program);
+  glUniformMatrix4fv(m_viewMatrixLoc, 1, GL_FALSE, &m_viewMatrix[0][0]);
+  glUniformMatrix4fv(m_projMatrixLoc, 1, GL_FALSE, &m_projMatrix[0][0]);
+  glUniform4f(m_colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);  // White
 
-  // Render each star
+  // Compute the model and model-view matrices of all stars at once
+  m_transformBatch.clear();
   for (const auto index : iter::range(m_numStars)) {
-    auto &position{m_starPositions.at(index)};
-    auto &rotation{m_starRotations.at(index)};
-
-    // Compute model matrix of the current star
-    glm::mat4 modelMatrix{1.0f};
-    modelMatrix = glm::translate(modelMatrix, position);
-    modelMatrix = glm::scale(modelMatrix, glm::vec3(0.2f));
-    modelMatrix = glm::rotate(modelMatrix, m_angle, rotation);
-
-    // Set uniform variable
-    glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &modelMatrix[0][0]);
-
-    m_model.render();
+    m_transformBatch.push(
+        m_starPositions.at(index), 0.2f,
+        glm::angleAxis(m_angle, m_starRotations.at(index)));
   }
-
-  glUseProgram(0);
+  m_transformBatch.compute(m_viewMatrix, m_starTransforms);
+
+  // Record each star on worker threads
+  std::atomic<int> trianglesDrawn{};
+  m_commandList.clear();
+  m_commandList.recordParallel(
+      m_numStars, [&](abcg::CommandList &commandList, std::size_t index) {
+        const auto &position{m_starPositions.at(index)};
+        const auto &transform{m_starTransforms.at(index)};
+        const auto &modelMatrix{transform.modelMatrix};
+
+        // Select level of detail from the projected size of the star
+        const auto lod{m_useLOD ? m_model.selectLOD(transform.modelViewMatrix,
+                                                    m_projMatrix,
+                                                    m_viewportHeight)
+                                : 0};
+        trianglesDrawn += m_model.getNumTriangles(lod);
+
+        // Stars are drawn front to back
+        auto packet{m_model.getDrawPacket(lod)};
+        packet.program = m_program;
+        packet.sortKey = abcg::CommandList::makeSortKey(
+            0, m_program, 0, packet.VAO, -position.z / 100.0f);
+        commandList.draw(packet, {{m_modelMatrixLoc, modelMatrix}});
+      });
+
+  // Issue the draw calls on this thread
+  m_commandList.submit();
+  m_trianglesDrawn = trianglesDrawn;
 }
 
 void OpenGLWindow::paintUI() {
   abcg::OpenGLWindow::paintUI();
 
   {
-    auto widgetSize{ImVec2(218, 62)};
+    auto widgetSize{ImVec2(218, 108)};
     ImGui::SetNextWindowPos(ImVec2(m_viewportWidth - widgetSize.x - 5, 5));
     ImGui::SetNextWindowSize(widgetSize);
     ImGui::Begin("Widget window", nullptr, ImGuiWindowFlags_NoDecoration);
@@ -134,6 +153,9 @@ void OpenGLWindow::paintUI() {
       ImGui::PopItemWidth();
     }
 
+    ImGui::Checkbox("Level of detail", &m_useLOD);
+    ImGui::Text("%d triangles", m_trianglesDrawn);
+
     ImGui::End();
   }
 }
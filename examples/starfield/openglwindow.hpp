@@ -18,6 +18,10 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   static const int m_numStars{500};
 
   GLuint m_program{};
+  GLint m_viewMatrixLoc{};
+  GLint m_projMatrixLoc{};
+  GLint m_modelMatrixLoc{};
+  GLint m_colorLoc{};
 
   int m_viewportWidth{};
   int m_viewportHeight{};
@@ -25,6 +29,10 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   std::default_random_engine m_randomEngine;
 
   Model m_model;
+  abcg::CommandList m_commandList;
+
+  abcg::TransformBatch m_transformBatch;
+  std::vector<abcg::InstanceTransform> m_starTransforms;
 
   std::array<glm::vec3, m_numStars> m_starPositions;
   std::array<glm::vec3, m_numStars> m_starRotations;
@@ -34,6 +42,9 @@ class OpenGLWindow : public abcg::OpenGLWindow {
   glm::mat4 m_projMatrix{1.0f};
   float m_FOV{30.0f};
 
+  bool m_useLOD{true};
+  int m_trianglesDrawn{};
+
   void randomizeStar(glm::vec3 &position, glm::vec3 &rotation);
   void update();
 };
@@ -9,8 +9,10 @@ int main(int argc, char **argv) {
 
     auto window{std::make_unique<OpenGLWindow>()};
     window->setOpenGLSettings({.samples = 4});
-    window->setWindowSettings(
-        {.width = 600, .height = 600, .title = "Model Viewer (version 1)"});
+    window->setWindowSettings({.width = 600,
+                               .height = 600,
+                               .title = "Model Viewer (version 1)",
+                               .renderPolicy = abcg::RenderPolicy::OnDemand});
 
     app.run(window);
   } catch (abcg::Exception &exception) {
@@ -6,7 +6,7 @@
 
 void OpenGLWindow::handleEvent(SDL_Event& event) {
   glm::ivec2 mousePosition;
-  SDL_GetMouseState(&mousePosition.x, &mousePosition.y);
+  getMouseState(&mousePosition.x, &mousePosition.y);
 
   if (event.type == SDL_MOUSEMOTION) {
     m_trackBall.mouseMove(mousePosition);
@@ -46,6 +46,9 @@ void OpenGLWindow::initializeGL() {
 void OpenGLWindow::paintGL() {
   update();
 
+  // Keep painting while the model spins after the mouse is released
+  if (m_trackBall.isSpinning()) requestRedraw();
+
   // Clear color buffer and depth buffer
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -67,7 +70,14 @@ void OpenGLWindow::paintGL() {
   glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, &m_modelMatrix[0][0]);
   glUniform4f(colorLoc, 1.0f, 1.0f, 1.0f, 1.0f);  // White
 
-  m_model.render(m_trianglesToDraw);
+  if (m_autoLOD) {
+    // Select level of detail from the projected size of the model
+    m_currentLOD = m_model.selectLOD(m_viewMatrix * m_modelMatrix,
+                                     m_projMatrix, m_viewportHeight);
+    m_model.render(-1, m_currentLOD);
+  } else {
+    m_model.render(m_trianglesToDraw);
+  }
 
   glUseProgram(0);
 }
@@ -86,8 +96,13 @@ void OpenGLWindow::paintUI() {
       // Slider will fill the space of the window
       ImGui::PushItemWidth(m_viewportWidth - 25);
 
-      ImGui::SliderInt("", &m_trianglesToDraw, 0, m_model.getNumTriangles(),
-                       "%d triangles");
+      if (m_autoLOD) {
+        ImGui::Text("LOD %d: %d triangles", m_currentLOD,
+                    m_model.getNumTriangles(m_currentLOD));
+      } else {
+        ImGui::SliderInt("", &m_trianglesToDraw, 0,
+                         m_model.getNumTriangles(), "%d triangles");
+      }
 
       ImGui::PopItemWidth();
     }
@@ -97,13 +112,14 @@ void OpenGLWindow::paintUI() {
 
   // Create a window for the other widgets
   {
-    auto widgetSize{ImVec2(222, 90)};
+    auto widgetSize{ImVec2(222, 114)};
     ImGui::SetNextWindowPos(ImVec2(m_viewportWidth - widgetSize.x - 5, 5));
     ImGui::SetNextWindowSize(widgetSize);
     ImGui::Begin("Widget window", nullptr, ImGuiWindowFlags_NoDecoration);
 
     static bool faceCulling{};
     ImGui::Checkbox("Back-face culling", &faceCulling);
+    ImGui::Checkbox("Automatic LOD", &m_autoLOD);
 
     if (faceCulling) {
       glEnable(GL_CULL_FACE);
@@ -22,6 +22,8 @@ class OpenGLWindow : public abcg::OpenGLWindow {
 
   Model m_model;
   int m_trianglesToDraw{};
+  bool m_autoLOD{};
+  int m_currentLOD{};
 
   TrackBall m_trackBall;
   float m_zoom{};
@@ -11,6 +11,9 @@ class TrackBall {
   void resizeViewport(int width, int height);
 
   [[nodiscard]] glm::mat4 getRotation();
+  [[nodiscard]] bool isSpinning() const {
+    return !m_mouseTracking && m_velocity > 0.0f;
+  }
 
  private:
   const float m_maxVelocity{glm::radians(720.0f / 1000.0f)};